@@ -0,0 +1,139 @@
+// Benchmark: a deep zoom into the Julia set of cpp_learning_274dfc.cpp, 1e-17 per pixel.
+// Compares plain double (which can't tell the pixels apart any more), double-double one point at
+// a time, and the lane-batched double-double loop, and checks that the batch gives exactly the
+// same counts as julia_iterations_dd() on the view and on a set of edge cases.
+
+#include <algorithm>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fractal/julia.h"
+
+namespace {
+
+const int SIZE = 128;
+const int MAX_ITERATIONS = 1000;
+const std::complex<double> JULIA_CONSTANT(-0.7, 0.27015);
+const double PIXEL_SPACING = 1e-17;
+
+// Finds a point on the boundary of the set, where a deep view has detail in it: bisects between
+// a point that doesn't escape (the first one found on a coarse grid) and one far outside.
+DoubleDoubleComplex findBoundaryPoint() {
+    DoubleDoubleComplex inside{dd_from(0.0), dd_from(0.0)};
+    for (int k = 0; k < 400; ++k) {
+        std::complex<double> z0(-1.0 + k * 0.005, 0.3);
+        if (julia_iterations(JULIA_CONSTANT, z0, MAX_ITERATIONS) == MAX_ITERATIONS) {
+            inside = DoubleDoubleComplex{dd_from(z0.real()), dd_from(z0.imag())};
+            break;
+        }
+    }
+    DoubleDoubleComplex outside{dd_from(2.5), dd_from(0.3)};
+    for (int step = 0; step < 80; ++step) {
+        DoubleDoubleComplex middle{(inside.re + outside.re) * 0.5, (inside.im + outside.im) * 0.5};
+        if (julia_iterations_dd(JULIA_CONSTANT, middle, MAX_ITERATIONS) == MAX_ITERATIONS) {
+            inside = middle;
+        } else {
+            outside = middle;
+        }
+    }
+    return inside;
+}
+
+// The batch against the one-point loop on inputs chosen to hit every path of the batch.
+long long countEdgeCaseMismatches() {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const std::vector<std::complex<double>> constants = {JULIA_CONSTANT, {0.0, 0.0}, {-2.0, 0.0}, {3.0, 1.0}};
+    std::vector<DoubleDoubleComplex> starts;
+    for (double re : {0.0, 1.9, 2.0, 2.0001, 0.3, 1e10, 1e200, inf, nan}) {
+        starts.push_back(DoubleDoubleComplex{dd_from(re), dd_from(0.1)});
+    }
+    for (int k = 0; k < 2000; ++k) {
+        starts.push_back(DoubleDoubleComplex{dd_from(-2.0 + k * 0.002), dd_from(0.3 - k * 0.0002)});
+    }
+    long long mismatches = 0;
+    std::vector<int> batch(starts.size());
+    for (const std::complex<double>& c : constants) {
+        for (int maxIterations : {0, 1, 7, 8, 9, 17, 300}) {
+            julia_iterations_dd_batch(c, starts.data(), batch.data(), (int)starts.size(), maxIterations);
+            for (std::size_t i = 0; i < starts.size(); ++i) {
+                mismatches += batch[i] != julia_iterations_dd(c, starts[i], maxIterations);
+            }
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main() {
+    DoubleDoubleComplex center = findBoundaryPoint();
+    JuliaView view{center.re, center.im, PIXEL_SPACING, SIZE, SIZE};
+    const long long pixels = (long long)SIZE * SIZE;
+
+    // Plain double: the starting points round to a handful of distinct values per row.
+    BenchTimer timer;
+    std::vector<int> doubleCounts(pixels);
+    std::set<double> distinctColumns;
+    for (int y = 0; y < SIZE; ++y) {
+        for (int x = 0; x < SIZE; ++x) {
+            double re = dd_to_double(center.re) + (x - SIZE / 2) * PIXEL_SPACING;
+            double im = dd_to_double(center.im) + (y - SIZE / 2) * PIXEL_SPACING;
+            doubleCounts[y * SIZE + x] = julia_iterations(JULIA_CONSTANT, {re, im}, MAX_ITERATIONS);
+            if (y == 0) {
+                distinctColumns.insert(re);
+            }
+        }
+    }
+    benchReport("julia deep view (double)", timer.seconds(), pixels);
+
+    timer.restart();
+    std::vector<int> scalarCounts(pixels);
+    for (int y = 0; y < SIZE; ++y) {
+        DoubleDouble im = center.im + two_prod(y - SIZE / 2, PIXEL_SPACING);
+        for (int x = 0; x < SIZE; ++x) {
+            DoubleDouble re = center.re + two_prod(x - SIZE / 2, PIXEL_SPACING);
+            scalarCounts[y * SIZE + x] = julia_iterations_dd(JULIA_CONSTANT, {re, im}, MAX_ITERATIONS);
+        }
+    }
+    benchReport("julia deep view (double-double)", timer.seconds(), pixels);
+
+    // julia_render_rows() picks double-double for this view and runs the lane batch.
+    timer.restart();
+    std::vector<int> batchCounts(pixels);
+    julia_render_rows(JULIA_CONSTANT, view, 0, SIZE, MAX_ITERATIONS, batchCounts.data());
+    benchReport("julia deep view (double-double batch)", timer.seconds(), pixels);
+
+    long long mismatches = 0;
+    long long checksum = 0;
+    for (long long i = 0; i < pixels; ++i) {
+        mismatches += batchCounts[i] != scalarCounts[i];
+        checksum += batchCounts[i];
+    }
+    mismatches += countEdgeCaseMismatches();
+
+    std::set<int> doubleLevels(doubleCounts.begin(), doubleCounts.end());
+    std::set<int> ddLevels(scalarCounts.begin(), scalarCounts.end());
+    std::cout << "double resolves " << distinctColumns.size() << " of " << SIZE << " columns, "
+              << doubleLevels.size() << " distinct counts; double-double " << ddLevels.size()
+              << " distinct counts\n";
+    std::cout << "checksum: " << checksum << "  mismatches: " << mismatches << "\n";
+
+    bool tiersOk = julia_view_precision(view) == FractalPrecision::DoubleDouble &&
+                   choose_fractal_precision(4.0 / 800, 0.0) == FractalPrecision::Double &&
+                   choose_fractal_precision(1e-12, 1.0) == FractalPrecision::Double &&
+                   choose_fractal_precision(1e-14, 1.0) == FractalPrecision::DoubleDouble;
+    if (!tiersOk) {
+        std::cerr << "Error: choose_fractal_precision() picked the wrong tier" << std::endl;
+        return 1;
+    }
+    if (mismatches != 0) {
+        std::cerr << "Error: julia_iterations_dd_batch() differs from julia_iterations_dd()" << std::endl;
+        return 1;
+    }
+    return 0;
+}
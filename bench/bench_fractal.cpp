@@ -0,0 +1,115 @@
+// Benchmark: the escape-time loop of the Julia set renderer over a full frame.
+// Uses the same view and constant as cpp_learning_274dfc.cpp, with a higher iteration cap.
+// Also checks that julia_iterations_blocked() and julia_iterations_batch() return exactly what
+// julia_iterations() does, over the frame and a set of edge cases; the program fails if they
+// ever differ.
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fractal/julia.h"
+
+namespace {
+
+const int WIDTH = 800;
+const int HEIGHT = 600;
+const int MAX_ITERATIONS = 256;
+const std::complex<double> JULIA_CONSTANT(-0.7, 0.27015);
+
+std::complex<double> pixelToComplex(int x, int y) {
+    return std::complex<double>(-2.0 + (double)x / WIDTH * 4.0, -1.5 + (double)y / HEIGHT * 3.0);
+}
+
+// Compares the two functions on inputs chosen to hit every path: iteration caps that are and
+// aren't multiples of the block size, points escaping in every position of a block, points that
+// overflow to infinity, |c| > 2, and NaN/infinite starting points.
+long long countEdgeCaseMismatches() {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const std::vector<std::complex<double>> constants = {
+        JULIA_CONSTANT, {0.0, 0.0}, {-2.0, 0.0}, {0.285, 0.01}, {3.0, 1.0}, {-10.0, 0.0}};
+    const std::vector<std::complex<double>> starts = {
+        {0.0, 0.0}, {1.9, 0.0}, {2.0, 0.0}, {2.0001, 0.0}, {0.3, -0.4}, {1e10, 1e10}, {1e200, 0.0},
+        {0.0, std::sqrt(10.0)}, {inf, 0.0}, {nan, 0.0}, {-0.75, 0.1}};
+    long long mismatches = 0;
+    for (const std::complex<double>& c : constants) {
+        std::vector<int> batch(starts.size());
+        for (int maxIterations = 0; maxIterations <= 40; ++maxIterations) {
+            julia_iterations_batch(c, starts.data(), batch.data(), (int)starts.size(), maxIterations);
+            for (std::size_t i = 0; i < starts.size(); ++i) {
+                int expected = julia_iterations(c, starts[i], maxIterations);
+                mismatches += expected != julia_iterations_blocked(c, starts[i], maxIterations);
+                mismatches += expected != batch[i];
+            }
+        }
+        // A fine sweep across the edge of the set, where escapes land in every block position.
+        std::vector<std::complex<double>> sweep;
+        for (int k = 0; k < 4000; ++k) {
+            sweep.push_back(std::complex<double>(-2.0 + k * 0.001, 0.3 - k * 0.0001));
+        }
+        batch.resize(sweep.size());
+        julia_iterations_batch(c, sweep.data(), batch.data(), (int)sweep.size(), 1000);
+        for (std::size_t i = 0; i < sweep.size(); ++i) {
+            int expected = julia_iterations(c, sweep[i], 1000);
+            mismatches += expected != julia_iterations_blocked(c, sweep[i], 1000);
+            mismatches += expected != batch[i];
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main() {
+    BenchTimer timer;
+    std::vector<int> reference(WIDTH * HEIGHT);
+    long long checksum = 0;
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            reference[y * WIDTH + x] = julia_iterations(JULIA_CONSTANT, pixelToComplex(x, y), MAX_ITERATIONS);
+            checksum += reference[y * WIDTH + x];
+        }
+    }
+    benchReport("julia 800x600 frame", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    timer.restart();
+    long long blockedChecksum = 0;
+    long long mismatches = 0;
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            int n = julia_iterations_blocked(JULIA_CONSTANT, pixelToComplex(x, y), MAX_ITERATIONS);
+            blockedChecksum += n;
+            mismatches += n != reference[y * WIDTH + x];
+        }
+    }
+    benchReport("julia 800x600 frame (blocked check)", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    timer.restart();
+    long long batchChecksum = 0;
+    std::vector<std::complex<double>> row(WIDTH);
+    std::vector<int> rowIterations(WIDTH);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            row[x] = pixelToComplex(x, y);
+        }
+        julia_iterations_batch(JULIA_CONSTANT, row.data(), rowIterations.data(), WIDTH, MAX_ITERATIONS);
+        for (int x = 0; x < WIDTH; ++x) {
+            batchChecksum += rowIterations[x];
+            mismatches += rowIterations[x] != reference[y * WIDTH + x];
+        }
+    }
+    benchReport("julia 800x600 frame (batch of rows)", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    mismatches += countEdgeCaseMismatches();
+    std::cout << "checksum: " << checksum << " " << blockedChecksum << " " << batchChecksum
+              << "  mismatches: " << mismatches << "\n";
+    if (mismatches != 0) {
+        std::cerr << "Error: the blocked/batch Julia loops differ from julia_iterations()" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Benchmark: the image encoders in common/image_codec.h on a rendered Julia frame,
+// which has the mix of smooth gradients and sharp detail typical of our outputs.
+
+#include <complex>
+#include <iostream>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "fractal/julia.h"
+
+int main() {
+    const int width = 1920;
+    const int height = 1080;
+    const int maxIterations = 100;
+    const std::complex<double> juliaConstant(-0.7, 0.27015);
+
+    Image image(width, height, 4);
+    ImageView view = image.view();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::complex<double> z0(-2.0 + (double)x / width * 4.0, -1.5 + (double)y / height * 3.0);
+            int n = julia_iterations(juliaConstant, z0, maxIterations);
+            unsigned char value = n == maxIterations ? 0 : static_cast<unsigned char>(n * 255 / maxIterations);
+            view.set(x, y, Color{value, static_cast<unsigned char>(value / 2), static_cast<unsigned char>(value / 4)});
+        }
+    }
+
+    struct Case { const char* name; ImageFormat format; };
+    const Case cases[] = {{"encode ppm", ImageFormat::Ppm}, {"encode qoi", ImageFormat::Qoi},
+                          {"encode png (level 1)", ImageFormat::Png}};
+    const int repeats = 5;
+    long long checksum = 0;
+
+    for (const Case& c : cases) {
+        std::vector<std::uint8_t> out;
+        BenchTimer timer;
+        for (int i = 0; i < repeats; ++i) {
+            out.clear();
+            encodeImage(view, c.format, out);
+        }
+        benchReport(c.name, timer.seconds() / repeats, (long long)width * height);
+        std::printf("    %zu bytes (%.1f%% of raw RGBA)\n", out.size(), 100.0 * out.size() / image.sizeBytes());
+        checksum += static_cast<long long>(out.size());
+    }
+
+    // A strided view (the centre quarter) is encoded in place, without copying it out.
+    std::vector<std::uint8_t> out;
+    BenchTimer timer;
+    encodePng(image.view(width / 4, height / 4, width / 2, height / 2), out);
+    benchReport("encode png, centre subview", timer.seconds(), (long long)width * height / 4);
+    checksum += static_cast<long long>(out.size());
+
+    std::cout << "checksum: " << checksum << "\n";
+    return 0;
+}
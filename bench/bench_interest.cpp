@@ -0,0 +1,143 @@
+// Benchmark: interest management for a server tick loop.
+// Many objects (a few of them moving each tick) and many players whose view rectangles drift.
+// Compares querying every view every tick and diffing with the previous result against the
+// incremental InterestManager. Both must end with the same number of visible objects. (Their event
+// counts can differ slightly: when an object and a view both move in one tick, the incremental
+// run may report an enter and a leave where the diff sees no change.)
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "spatial/interest.h"
+#include "spatial/aabb_tree.h"
+
+int main() {
+    const int numObjects = 100000;
+    const int numPlayers = 500;
+    const int numTicks = 30;
+    const float worldSize = 4096.0f;
+    const float viewSize = 256.0f;
+    const int moversPerTick = numObjects / 20;
+
+    std::mt19937 gen(4242);
+    std::uniform_real_distribution<float> position(0.0f, worldSize - viewSize);
+    std::uniform_real_distribution<float> size(1.0f, 16.0f);
+    std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+
+    std::vector<GameObject> objects;
+    objects.reserve(numObjects);
+    for (int i = 0; i < numObjects; ++i) {
+        objects.emplace_back(i, Rect{position(gen), position(gen), size(gen), size(gen)});
+    }
+    std::vector<Rect> views;
+    for (int p = 0; p < numPlayers; ++p) {
+        views.push_back(Rect{position(gen), position(gen), viewSize, viewSize});
+    }
+
+    // The same movement script for both runs: which objects move, and every step.
+    struct Move {
+        int object;
+        float dx, dy;
+    };
+    std::vector<std::vector<Move>> objectMoves(numTicks);
+    std::vector<std::vector<Move>> viewMoves(numTicks);
+    for (int tick = 0; tick < numTicks; ++tick) {
+        for (int m = 0; m < moversPerTick; ++m) {
+            // Every object moves at most once per tick, so both runs see the same changes.
+            objectMoves[tick].push_back(Move{m * 20 + tick % 20, step(gen), step(gen)});
+        }
+        for (int p = 0; p < numPlayers; ++p) {
+            viewMoves[tick].push_back(Move{p, step(gen), step(gen)});
+        }
+    }
+    const std::vector<GameObject> startObjects = objects;
+    const std::vector<Rect> startViews = views;
+
+    // --- Query and diff every tick ---
+    BenchTimer timer;
+    long long diffEvents = 0;
+    long long diffVisible = 0;
+    {
+        // The index itself is kept up to date incrementally here too, so only the per-view work differs.
+        AabbTree tree;
+        std::vector<int> proxies;
+        for (GameObject& obj : objects) {
+            proxies.push_back(tree.insert(&obj));
+        }
+        std::vector<std::vector<GameObject*>> visible(numPlayers);
+        std::vector<GameObject*> found, changed;
+        for (int tick = 0; tick <= numTicks; ++tick) {
+            if (tick > 0) {
+                for (const Move& m : objectMoves[tick - 1]) {
+                    objects[m.object].bounds.x += m.dx;
+                    objects[m.object].bounds.y += m.dy;
+                    tree.update(proxies[m.object], m.dx, m.dy);
+                }
+                for (const Move& m : viewMoves[tick - 1]) {
+                    views[m.object].x += m.dx;
+                    views[m.object].y += m.dy;
+                }
+            }
+            for (int p = 0; p < numPlayers; ++p) {
+                found.clear();
+                tree.query(views[p], found);
+                std::sort(found.begin(), found.end());
+                if (tick > 0) {
+                    changed.clear();
+                    std::set_symmetric_difference(visible[p].begin(), visible[p].end(),
+                                                  found.begin(), found.end(),
+                                                  std::back_inserter(changed));
+                    diffEvents += static_cast<long long>(changed.size());
+                }
+                visible[p].swap(found);
+            }
+        }
+        for (const std::vector<GameObject*>& list : visible) {
+            diffVisible += static_cast<long long>(list.size());
+        }
+    }
+    benchReport("query + diff per tick", timer.seconds(), numTicks);
+
+    // --- InterestManager ---
+    objects = startObjects;
+    views = startViews;
+    InterestManager interest(viewSize);
+    std::vector<int> handles, subscriptions;
+    for (GameObject& obj : objects) {
+        handles.push_back(interest.addObject(&obj));
+    }
+    for (const Rect& view : views) {
+        subscriptions.push_back(interest.subscribe(view));
+    }
+    long long incrementalVisible = static_cast<long long>(interest.events().size());
+    interest.clearEvents();
+
+    timer.restart();
+    long long incrementalEvents = 0;
+    for (int tick = 0; tick < numTicks; ++tick) {
+        for (const Move& m : objectMoves[tick]) {
+            objects[m.object].bounds.x += m.dx;
+            objects[m.object].bounds.y += m.dy;
+            interest.moveObject(handles[m.object], m.dx, m.dy);
+        }
+        for (const Move& m : viewMoves[tick]) {
+            views[m.object].x += m.dx;
+            views[m.object].y += m.dy;
+            interest.moveSubscription(subscriptions[m.object], views[m.object]);
+        }
+        incrementalEvents += static_cast<long long>(interest.events().size());
+        for (const InterestEvent& event : interest.events()) {
+            incrementalVisible += event.entered ? 1 : -1;
+        }
+        interest.clearEvents();
+    }
+    benchReport("interest manager per tick", timer.seconds(), numTicks);
+
+    std::cout << "visible: " << diffVisible << " (query + diff) " << incrementalVisible
+              << " (interest manager)  events: " << diffEvents << " / " << incrementalEvents << "\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Benchmark: storing a 2048x1536 Julia iteration map (fractal/iteration_map.h) and reading it
+// back, memory-mapped and read whole. Reports the size against plain ints, and checks that every
+// count comes back exactly (the program fails otherwise), including counts that need the
+// overflow escape and data that doesn't compress at all.
+
+#include <complex>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fractal/iteration_map.h"
+#include "fractal/julia.h"
+
+namespace {
+
+const int WIDTH = 2048;
+const int HEIGHT = 1536;
+const int MAX_ITERATIONS = 1000;
+
+bool writeMap(const std::string& path, const std::vector<int>& counts, int width, int height, int maxIterations) {
+    IterationMapWriter writer;
+    return writer.open(path, width, height, maxIterations) && writer.write_rows(counts.data(), height) &&
+           writer.close();
+}
+
+// Reads the map back block by block; returns the number of counts that differ (or -1 on error).
+long long compareMap(const std::string& path, const std::vector<int>& expected, bool map) {
+    IterationMapReader reader;
+    if (!reader.open(path, map)) {
+        return -1;
+    }
+    long long mismatches = 0;
+    std::vector<int> counts;
+    for (int block = 0; block < reader.block_count(); ++block) {
+        if (!reader.read_block(block, counts)) {
+            return -1;
+        }
+        const std::size_t first = (std::size_t)block * ITERATION_MAP_BLOCK_ROWS * reader.width();
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            mismatches += counts[i] != expected[first + i];
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_iteration_map.dpim").string();
+
+    JuliaView view;
+    view.center_real = dd_from(0.0);
+    view.center_imag = dd_from(0.0);
+    view.pixel_spacing = 4.0 / WIDTH;
+    view.width = WIDTH;
+    view.height = HEIGHT;
+    std::vector<int> counts((std::size_t)WIDTH * HEIGHT);
+    julia_render_rows(std::complex<double>(-0.7, 0.27015), view, 0, HEIGHT, MAX_ITERATIONS, counts.data());
+
+    BenchTimer timer;
+    if (!writeMap(path, counts, WIDTH, HEIGHT, MAX_ITERATIONS)) {
+        return 1;
+    }
+    benchReport("iteration map write 2048x1536", timer.seconds(), (long long)WIDTH * HEIGHT);
+    const double bytes = (double)std::filesystem::file_size(path);
+
+    timer.restart();
+    long long mismatches = compareMap(path, counts, true);
+    benchReport("iteration map read (mmap)", timer.seconds(), (long long)WIDTH * HEIGHT);
+    timer.restart();
+    long long unmapped = compareMap(path, counts, false);
+    benchReport("iteration map read (whole file)", timer.seconds(), (long long)WIDTH * HEIGHT);
+    if (mismatches < 0 || unmapped < 0) {
+        return 1;
+    }
+    mismatches += unmapped;
+    std::printf("  %.0f bytes, %.2f bits per pixel, %.1fx smaller than ints\n", bytes, bytes * 8 / counts.size(),
+                counts.size() * sizeof(int) / bytes);
+
+    // Noise (nothing to compress), counts past the 16-bit range and negative ones, and a height
+    // that isn't a whole number of blocks.
+    std::mt19937 random(12345);
+    const int noiseWidth = 777;
+    const int noiseHeight = 2 * ITERATION_MAP_BLOCK_ROWS + 5;
+    std::vector<int> noise((std::size_t)noiseWidth * noiseHeight);
+    for (std::size_t i = 0; i < noise.size(); ++i) {
+        switch (random() % 4) {
+        case 0: noise[i] = (int)(random() % 65535); break;
+        case 1: noise[i] = 65535 + (int)(random() % 1000000); break;
+        case 2: noise[i] = -(int)(random() % 1000) - 1; break;
+        default: noise[i] = 100; break;
+        }
+    }
+    if (!writeMap(path, noise, noiseWidth, noiseHeight, 2000000)) {
+        return 1;
+    }
+    long long noiseMismatches = compareMap(path, noise, true);
+    if (noiseMismatches < 0) {
+        return 1;
+    }
+    mismatches += noiseMismatches;
+    std::remove(path.c_str());
+
+    std::cout << "mismatches: " << mismatches << "\n";
+    if (mismatches != 0) {
+        std::cerr << "Error: the iteration map didn't read back what was written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
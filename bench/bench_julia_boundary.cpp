@@ -0,0 +1,86 @@
+// Benchmark: the boundary of the Douady rabbit Julia set (c = -0.123 + 0.745i) at 800x600, found
+// by escape-time rendering (every pixel iterated, then the edge between inside and outside
+// pixels) and by inverse iteration with julia_boundary(). Checks that the inverse-iteration
+// pixels really are on the boundary: each must be within a pixel of one that is inside the
+// escape-time set or close to it (the program fails otherwise).
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fractal/julia.h"
+#include "fractal/julia_boundary.h"
+
+namespace {
+
+const int WIDTH = 800;
+const int HEIGHT = 600;
+const int MAX_ITERATIONS = 1000;
+const std::complex<double> RABBIT(-0.123, 0.745);
+
+// Pixels that take this many iterations to escape count as close to the set. Where the rabbit's
+// parts pinch together the filled-in set is thinner than a pixel, so no pixel centre there is
+// inside, but the ones next to the boundary still escape slowly (far from it, a few iterations).
+const int NEAR_ITERATIONS = 10;
+
+} // namespace
+
+int main() {
+    JuliaView view;
+    view.center_real = dd_from(0.0);
+    view.center_imag = dd_from(0.0);
+    view.pixel_spacing = 4.0 / WIDTH;
+    view.width = WIDTH;
+    view.height = HEIGHT;
+
+    BenchTimer timer;
+    std::vector<int> counts((std::size_t)WIDTH * HEIGHT);
+    julia_render_rows(RABBIT, view, 0, HEIGHT, MAX_ITERATIONS, counts.data());
+    // Boundary pixels: inside pixels with an outside neighbour.
+    auto inside = [&](int x, int y) { return counts[(std::size_t)y * WIDTH + x] == MAX_ITERATIONS; };
+    long long escapeBoundary = 0;
+    for (int y = 1; y < HEIGHT - 1; ++y) {
+        for (int x = 1; x < WIDTH - 1; ++x) {
+            escapeBoundary += inside(x, y) && (!inside(x - 1, y) || !inside(x + 1, y) || !inside(x, y - 1) ||
+                                               !inside(x, y + 1));
+        }
+    }
+    benchReport("rabbit boundary (escape time)", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    timer.restart();
+    std::vector<std::uint8_t> visits;
+    long long points = julia_boundary(RABBIT, view, 4, visits);
+    benchReport("rabbit boundary (inverse iteration)", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    long long boundary = 0;
+    long long strays = 0;
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            if (visits[(std::size_t)y * WIDTH + x] == 0) {
+                continue;
+            }
+            ++boundary;
+            bool near = false;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int nx = x + dx;
+                    const int ny = y + dy;
+                    near |= nx >= 0 && nx < WIDTH && ny >= 0 && ny < HEIGHT &&
+                            counts[(std::size_t)ny * WIDTH + nx] >= NEAR_ITERATIONS;
+                }
+            }
+            strays += !near;
+        }
+    }
+    std::printf("  escape time: %lld boundary pixels; inverse iteration: %lld pixels from %lld points\n",
+                escapeBoundary, boundary, points);
+    std::cout << "strays: " << strays << "\n";
+    if (strays != 0 || boundary == 0) {
+        std::cerr << "Error: julia_boundary() marked pixels away from the Julia set" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Benchmark: object bounds in a 100 km world, queried with small boxes.
+// Compares a plain float Quadtree over world coordinates with the LargeWorldIndex (float
+// offsets from per-region anchors), and checks both against exact double-precision answers.
+// The float tree is off by up to ~4 mm out here; the large-world index by at most ~0.06 mm (float
+// resolution at 1 km offsets), so the few near misses it still gets wrong are gaps below that.
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "spatial/large_world.h"
+#include "spatial/quadtree.h"
+
+int main() {
+    const int numObjects = 100000;
+    const int numQueries = 20000;
+    const double worldSize = 100000.0; // 100 km, in metres.
+
+    // Small objects (crates, props: 0.2 - 2 m) and small queries (4 m boxes), packed densely in
+    // a strip far from the origin so that near misses of a few millimetres are common.
+    std::mt19937 gen(777);
+    std::uniform_real_distribution<double> along(worldSize - 2000.0, worldSize);
+    std::uniform_real_distribution<double> across(worldSize - 100.0, worldSize);
+    std::uniform_real_distribution<double> size(0.2, 2.0);
+
+    std::vector<WorldRect> bounds;
+    for (int i = 0; i < numObjects; ++i) {
+        bounds.push_back(WorldRect{along(gen), across(gen), size(gen), size(gen)});
+    }
+    std::vector<WorldRect> queries;
+    for (int i = 0; i < numQueries; ++i) {
+        queries.push_back(WorldRect{along(gen), across(gen), 4.0, 4.0});
+    }
+
+    // Float Quadtree over absolute world coordinates.
+    std::vector<GameObject> objects;
+    objects.reserve(numObjects);
+    for (int i = 0; i < numObjects; ++i) {
+        const WorldRect& b = bounds[i];
+        objects.emplace_back(i, Rect{static_cast<float>(b.x), static_cast<float>(b.y),
+                                     static_cast<float>(b.width), static_cast<float>(b.height)});
+    }
+    Quadtree floatTree(Rect{0, 0, static_cast<float>(worldSize), static_cast<float>(worldSize)}, 8);
+    for (GameObject& obj : objects) {
+        floatTree.insert(&obj);
+    }
+
+    LargeWorldIndex largeWorld(1024.0, 8);
+    BenchTimer timer;
+    for (int i = 0; i < numObjects; ++i) {
+        largeWorld.insert(i, bounds[i]);
+    }
+    benchReport("large world build", timer.seconds(), numObjects);
+
+    // Exact answers, by brute force in double precision over a sorted strip.
+    std::vector<int> byX(numObjects);
+    for (int i = 0; i < numObjects; ++i) {
+        byX[i] = i;
+    }
+    std::sort(byX.begin(), byX.end(), [&](int a, int b) { return bounds[a].x < bounds[b].x; });
+    auto exact = [&](const WorldRect& range, std::vector<int>& ids) {
+        for (int i : byX) {
+            if (bounds[i].x > range.x + range.width) {
+                break;
+            }
+            if (range.intersects(bounds[i])) {
+                ids.push_back(i);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+    };
+
+    std::vector<std::vector<int>> truth(numQueries);
+    for (int q = 0; q < numQueries; ++q) {
+        exact(queries[q], truth[q]);
+    }
+
+    timer.restart();
+    long long floatWrong = 0;
+    std::vector<GameObject*> found;
+    std::vector<int> ids;
+    for (int q = 0; q < numQueries; ++q) {
+        const WorldRect& r = queries[q];
+        found.clear();
+        floatTree.query(Rect{static_cast<float>(r.x), static_cast<float>(r.y),
+                             static_cast<float>(r.width), static_cast<float>(r.height)}, found);
+        ids.clear();
+        for (const GameObject* obj : found) {
+            ids.push_back(obj->id);
+        }
+        std::sort(ids.begin(), ids.end());
+        floatWrong += ids != truth[q];
+    }
+    benchReport("float quadtree query 4x4 m", timer.seconds(), numQueries);
+
+    timer.restart();
+    long long largeWorldWrong = 0;
+    for (int q = 0; q < numQueries; ++q) {
+        ids.clear();
+        largeWorld.query(queries[q], ids);
+        std::sort(ids.begin(), ids.end());
+        largeWorldWrong += ids != truth[q];
+    }
+    benchReport("large world query 4x4 m", timer.seconds(), numQueries);
+
+    std::cout << "queries with wrong results: " << floatWrong << " (float quadtree) "
+              << largeWorldWrong << " (large world)  regions: " << largeWorld.regionCount() << "\n";
+    return 0;
+}
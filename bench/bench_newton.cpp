@@ -0,0 +1,87 @@
+// Benchmark: Newton basins of z^3 - 1 and of a degree-7 polynomial over an 800x600 view.
+// Compares newton_basin() one point at a time with the lane-batched newton_basin_batch(), and
+// checks that both give exactly the same step counts and roots (the program fails otherwise).
+
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fractal/newton.h"
+
+namespace {
+
+const int WIDTH = 800;
+const int HEIGHT = 600;
+const int MAX_ITERATIONS = 64;
+
+template <int Degree>
+long long runDegree(const char* scalarName, const char* batchName, const std::vector<std::complex<double>>& roots) {
+    NewtonPolynomial<Degree> polynomial = newton_polynomial_from_roots<Degree>(roots.data());
+    auto pixel = [](int x, int y) {
+        return std::complex<double>((x - 0.5 * WIDTH) * 4.0 / WIDTH, (y - 0.5 * HEIGHT) * 4.0 / WIDTH);
+    };
+
+    BenchTimer timer;
+    std::vector<NewtonResult> reference(WIDTH * HEIGHT);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            reference[y * WIDTH + x] = newton_basin(polynomial, pixel(x, y), MAX_ITERATIONS);
+        }
+    }
+    benchReport(scalarName, timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    timer.restart();
+    std::vector<std::complex<double>> row(WIDTH);
+    std::vector<NewtonResult> batch(WIDTH * HEIGHT);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            row[x] = pixel(x, y);
+        }
+        newton_basin_batch(polynomial, row.data(), batch.data() + y * WIDTH, WIDTH, MAX_ITERATIONS);
+    }
+    benchReport(batchName, timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    long long mismatches = 0;
+    long long converged = 0;
+    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+        mismatches += batch[i].iterations != reference[i].iterations || batch[i].root != reference[i].root;
+        converged += reference[i].root >= 0;
+    }
+
+    // Edge cases: roots themselves, the critical point 0 (p' = 0), NaN/inf, short iteration caps.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::complex<double>> starts = {{0.0, 0.0}, {nan, 0.0}, {std::numeric_limits<double>::infinity(), 0.0},
+                                                {1e300, 1e300}, {0.3, 0.2}};
+    starts.insert(starts.end(), roots.begin(), roots.end());
+    std::vector<NewtonResult> results(starts.size());
+    for (int maxIterations : {0, 1, 5, 8, 9, 100}) {
+        newton_basin_batch(polynomial, starts.data(), results.data(), (int)starts.size(), maxIterations);
+        for (std::size_t i = 0; i < starts.size(); ++i) {
+            NewtonResult expected = newton_basin(polynomial, starts[i], maxIterations);
+            mismatches += results[i].iterations != expected.iterations || results[i].root != expected.root;
+        }
+    }
+    std::cout << "  degree " << Degree << ": " << converged << " of " << WIDTH * HEIGHT << " pixels converged\n";
+    return mismatches;
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::complex<double>> unity;
+    for (int k = 0; k < 3; ++k) {
+        unity.push_back(std::polar(1.0, 2.0 * 3.14159265358979323846 * k / 3));
+    }
+    std::vector<std::complex<double>> seven = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {0.5, 0.5}, {-0.7, 0.3}, {0.2, -0.9}};
+
+    long long mismatches = runDegree<3>("newton z^3-1 800x600", "newton z^3-1 800x600 (batch)", unity);
+    mismatches += runDegree<7>("newton degree 7 800x600", "newton degree 7 800x600 (batch)", seven);
+    std::cout << "mismatches: " << mismatches << "\n";
+    if (mismatches != 0) {
+        std::cerr << "Error: newton_basin_batch() differs from newton_basin()" << std::endl;
+        return 1;
+    }
+    return 0;
+}
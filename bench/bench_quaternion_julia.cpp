@@ -0,0 +1,117 @@
+// Benchmark: ray marching a quaternion Julia set at 320x240, one ray at a time with
+// quaternion_julia_march() and in 2x2 packets with quaternion_julia_march_packet().
+// Checks that both give exactly the same hits, distances and step counts (the program fails
+// otherwise), as well as the scalar and packet distance estimates on their own.
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fractal/quaternion_julia.h"
+
+namespace {
+
+const int WIDTH = 320;
+const int HEIGHT = 240;
+
+const QuaternionJulia FRACTAL = {{-0.2, 0.6, 0.2, 0.2}, 0.0, 12};
+
+// A camera at (0, 1, 3) looking at the origin, 45 degrees vertical field of view.
+const Vec3 EYE = {0.0, 1.0, 3.0};
+const double PIXEL_SIZE = 2.0 * 0.41421356237309515 / HEIGHT;
+
+Vec3 rayDirection(int x, int y) {
+    // forward = -EYE / |EYE|, right = (1, 0, 0), up = right x forward.
+    const double length = std::sqrt(10.0);
+    const Vec3 forward = {0.0, -1.0 / length, -3.0 / length};
+    const Vec3 up = {0.0, 3.0 / length, -1.0 / length};
+    const double sx = (x + 0.5 - 0.5 * WIDTH) * PIXEL_SIZE;
+    const double sy = (0.5 * HEIGHT - (y + 0.5)) * PIXEL_SIZE;
+    Vec3 d = {sx, forward.y + sy * up.y, forward.z + sy * up.z};
+    const double norm = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+    return Vec3{d.x / norm, d.y / norm, d.z / norm};
+}
+
+bool sameHit(const QuaternionJuliaHit& a, const QuaternionJuliaHit& b) {
+    return a.hit == b.hit && a.t == b.t && a.steps == b.steps;
+}
+
+} // namespace
+
+int main() {
+    const QuaternionJuliaMarch march = {0.9, PIXEL_SIZE, 256};
+
+    // Computed once for both runs: with -march=native the two copies of rayDirection() inlined
+    // into the loops below might fuse multiply-adds differently and give different rays.
+    std::vector<Vec3> directions(WIDTH * HEIGHT);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            directions[y * WIDTH + x] = rayDirection(x, y);
+        }
+    }
+
+    BenchTimer timer;
+    std::vector<QuaternionJuliaHit> reference(WIDTH * HEIGHT);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            reference[y * WIDTH + x] = quaternion_julia_march(FRACTAL, march, EYE, directions[y * WIDTH + x]);
+        }
+    }
+    benchReport("qjulia march 320x240", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    timer.restart();
+    std::vector<QuaternionJuliaHit> packets(WIDTH * HEIGHT);
+    for (int y = 0; y < HEIGHT; y += 2) {
+        for (int x = 0; x < WIDTH; x += 2) {
+            Vec3 packet[QJULIA_PACKET_LANES];
+            QuaternionJuliaHit hits[QJULIA_PACKET_LANES];
+            for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+                packet[l] = directions[(y + (l >> 1)) * WIDTH + x + (l & 1)];
+            }
+            quaternion_julia_march_packet(FRACTAL, march, EYE, packet, hits);
+            for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+                packets[(y + (l >> 1)) * WIDTH + x + (l & 1)] = hits[l];
+            }
+        }
+    }
+    benchReport("qjulia march 320x240 (packets)", timer.seconds(), (long long)WIDTH * HEIGHT);
+
+    long long mismatches = 0;
+    long long hitCount = 0;
+    long long steps = 0;
+    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+        mismatches += !sameHit(packets[i], reference[i]);
+        hitCount += reference[i].hit;
+        steps += reference[i].steps;
+    }
+
+    // Edge cases for the packet estimate: the origin, points in and far outside the set, NaN,
+    // and several iteration caps.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double xs[] = {0.0, 0.1, 5.0, nan, 1e300, -0.3, 0.0, 2.0};
+    const double ys[] = {0.0, 0.2, 0.0, 0.0, 0.0, 0.4, 1.1, 2.0};
+    const double zs[] = {0.0, -0.1, 0.0, 0.0, 0.0, 0.2, 0.0, 2.0};
+    for (int maxIterations : {1, 12, 100}) {
+        QuaternionJulia fractal = FRACTAL;
+        fractal.max_iterations = maxIterations;
+        for (int start = 0; start < 8; start += QJULIA_PACKET_LANES) {
+            double distance[QJULIA_PACKET_LANES];
+            quaternion_julia_distance_packet(fractal, xs + start, ys + start, zs + start, distance);
+            for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+                double expected = quaternion_julia_distance(fractal, Vec3{xs[start + l], ys[start + l], zs[start + l]});
+                mismatches += !(distance[l] == expected || (std::isnan(distance[l]) && std::isnan(expected)));
+            }
+        }
+    }
+
+    std::cout << "  " << hitCount << " of " << WIDTH * HEIGHT << " rays hit, " << (double)steps / (WIDTH * HEIGHT)
+              << " steps per ray\n";
+    std::cout << "mismatches: " << mismatches << "\n";
+    if (mismatches != 0) {
+        std::cerr << "Error: quaternion_julia_march_packet() differs from quaternion_julia_march()" << std::endl;
+        return 1;
+    }
+    return 0;
+}
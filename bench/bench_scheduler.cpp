@@ -0,0 +1,121 @@
+// Benchmark: the work-stealing scheduler in common/scheduler.h.
+//
+//   1. Per-task overhead: many empty tasks, spawned from one thread and via parallel_for.
+//   2. Load balancing on a skewed workload: Julia set tiles, where tiles touching the set
+//      cost up to max_iterations per pixel and tiles far outside escape almost at once.
+//      Reports the speedup over a sequential run and how evenly work landed on the threads.
+
+#include <algorithm>
+#include <complex>
+#include <iostream>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "common/scheduler.h"
+#include "fractal/julia.h"
+
+namespace {
+
+const int WIDTH = 800;
+const int HEIGHT = 600;
+const int TILE = 16;
+const int MAX_ITERATIONS = 256;
+const std::complex<double> JULIA_CONSTANT(-0.7, 0.27015);
+
+long long renderTile(int tile, std::vector<int>& iterations) {
+    int tilesPerRow = (WIDTH + TILE - 1) / TILE;
+    int x0 = (tile % tilesPerRow) * TILE;
+    int y0 = (tile / tilesPerRow) * TILE;
+    long long sum = 0;
+    for (int y = y0; y < std::min(y0 + TILE, HEIGHT); ++y) {
+        for (int x = x0; x < std::min(x0 + TILE, WIDTH); ++x) {
+            std::complex<double> z0(-2.0 + (double)x / WIDTH * 4.0, -1.5 + (double)y / HEIGHT * 3.0);
+            int n = julia_iterations(JULIA_CONSTANT, z0, MAX_ITERATIONS);
+            iterations[y * WIDTH + x] = n;
+            sum += n;
+        }
+    }
+    return sum;
+}
+
+// Max tasks run by one thread divided by the mean: 1.0 is perfect balance.
+void reportBalance(const Scheduler& scheduler) {
+    std::vector<Scheduler::SlotStats> stats = scheduler.stats();
+    std::uint64_t total = 0, most = 0, stolen = 0;
+    for (const Scheduler::SlotStats& slot : stats) {
+        total += slot.executed;
+        stolen += slot.stolen;
+        most = std::max(most, slot.executed);
+    }
+    double mean = static_cast<double>(total) / stats.size();
+    std::printf("    tasks per thread:");
+    for (const Scheduler::SlotStats& slot : stats) {
+        std::printf(" %llu", static_cast<unsigned long long>(slot.executed));
+    }
+    std::printf("   (imbalance %.2f, %llu stolen)\n", mean > 0 ? most / mean : 0.0,
+                static_cast<unsigned long long>(stolen));
+}
+
+} // namespace
+
+int main() {
+    Scheduler& scheduler = Scheduler::instance();
+    std::cout << "scheduler threads: " << scheduler.concurrency() << "\n\n";
+
+    // --- 1. Per-task overhead ---
+    const int numTasks = 200000;
+    std::atomic<int> counter{0};
+
+    BenchTimer timer;
+    {
+        TaskGroup group;
+        for (int i = 0; i < numTasks; ++i) {
+            group.run([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+        }
+        group.wait();
+    }
+    benchReport("spawn+run empty task (one spawner)", timer.seconds(), numTasks);
+
+    timer.restart();
+    parallel_for(0, numTasks, 1, [&counter](int begin, int end) {
+        counter.fetch_add(end - begin, std::memory_order_relaxed);
+    });
+    benchReport("parallel_for grain 1 (split tasks)", timer.seconds(), numTasks);
+
+    // --- 2. Skewed workload: Julia tiles ---
+    int numTiles = ((WIDTH + TILE - 1) / TILE) * ((HEIGHT + TILE - 1) / TILE);
+    std::vector<int> iterations(WIDTH * HEIGHT);
+    std::cout << "\njulia " << WIDTH << "x" << HEIGHT << ", " << numTiles << " tiles of "
+              << TILE << "x" << TILE << ", max " << MAX_ITERATIONS << " iterations\n";
+
+    timer.restart();
+    long long sequentialSum = 0;
+    for (int tile = 0; tile < numTiles; ++tile) {
+        sequentialSum += renderTile(tile, iterations);
+    }
+    double sequential = timer.seconds();
+    benchReport("tiles sequential", sequential, numTiles);
+
+    for (int grain : {1, 4, 16, 64}) {
+        std::atomic<long long> sum{0};
+        scheduler.resetStats();
+        timer.restart();
+        parallel_for(0, numTiles, grain, [&](int begin, int end) {
+            long long local = 0;
+            for (int tile = begin; tile < end; ++tile) {
+                local += renderTile(tile, iterations);
+            }
+            sum += local;
+        });
+        double seconds = timer.seconds();
+        char name[64];
+        std::snprintf(name, sizeof(name), "tiles parallel_for grain %d", grain);
+        benchReport(name, seconds, numTiles);
+        std::printf("    speedup %.2fx%s\n", sequential / seconds,
+                    sum.load() == sequentialSum ? "" : "   CHECKSUM MISMATCH");
+        reportBalance(scheduler);
+    }
+
+    std::cout << "\nchecksum: " << sequentialSum + counter.load() << "\n";
+    return 0;
+}
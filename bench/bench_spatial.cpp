@@ -0,0 +1,358 @@
+// Benchmark: building and querying the Quadtree with a scattered, game-like workload.
+// Many small objects spread over a large world, queried with small "view" rectangles.
+// The second half moves every object each frame and compares rebuilding the Quadtree per
+// frame against keeping one AabbTree up to date, and finding all overlapping pairs by querying
+// the Quadtree per object against keeping them with sweep-and-prune. The last part reorders the
+// object storage along a Hilbert curve to show the effect of memory locality on queries.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "spatial/aabb_tree.h"
+#include "spatial/compact_quadtree.h"
+#include "spatial/hilbert.h"
+#include "spatial/quadtree.h"
+#include "spatial/sweep_and_prune.h"
+#include "spatial/time_sliced_quadtree.h"
+
+int main() {
+    const int numObjects = 100000;
+    const int numQueries = 20000;
+    const float worldSize = 4096.0f;
+
+    // A fixed seed keeps every run (and every PGO training run) on the same workload.
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<float> position(0.0f, worldSize - 16.0f);
+    std::uniform_real_distribution<float> size(1.0f, 16.0f);
+
+    std::vector<GameObject> objects;
+    objects.reserve(numObjects);
+    for (int i = 0; i < numObjects; ++i) {
+        objects.emplace_back(i, Rect{position(gen), position(gen), size(gen), size(gen)});
+    }
+
+    std::vector<Rect> queries;
+    queries.reserve(numQueries);
+    for (int i = 0; i < numQueries; ++i) {
+        queries.push_back(Rect{position(gen), position(gen), 64.0f, 64.0f});
+    }
+
+    BenchTimer timer;
+    Quadtree quadtree(Rect{0, 0, worldSize, worldSize}, 8);
+    for (GameObject& obj : objects) {
+        quadtree.insert(&obj);
+    }
+    benchReport("quadtree build", timer.seconds(), numObjects);
+
+    // The same objects into a root that starts far too small and has to grow to fit them.
+    timer.restart();
+    Quadtree growingTree(Rect{0, 0, 64, 64}, 8);
+    for (GameObject& obj : objects) {
+        growingTree.insert(&obj);
+    }
+    benchReport("quadtree build (growing root)", timer.seconds(), numObjects);
+    std::cout << "objects: " << growingTree.size() << "  bounds: " << growingTree.bounds().width
+              << "x" << growingTree.bounds().height << "\n";
+
+    timer.restart();
+    std::vector<GameObject*> found;
+    long long checksum = 0;
+    for (const Rect& range : queries) {
+        found.clear();
+        quadtree.query(range, found);
+        checksum += static_cast<long long>(found.size());
+    }
+    benchReport("quadtree query 64x64", timer.seconds(), numQueries);
+
+    std::cout << "checksum: " << checksum << "\n";
+
+    // Rebuilding in time slices: at most ~1 ms of building per frame while queries continue
+    // against the previous tree. The longest frame shows how well the hitch is spread out.
+    std::vector<GameObject*> objectPointers;
+    for (GameObject& obj : objects) {
+        objectPointers.push_back(&obj);
+    }
+    TimeSlicedQuadtree slicedTree(Rect{0, 0, worldSize, worldSize}, 8);
+    slicedTree.beginRebuild(objectPointers);
+    slicedTree.finishRebuild();
+    slicedTree.beginRebuild(objectPointers);
+    int frames = 0;
+    double longestFrame = 0;
+    long long slicedChecksum = 0;
+    timer.restart();
+    bool switched = false;
+    while (!switched || slicedTree.retiring()) {
+        BenchTimer frameTimer;
+        switched = slicedTree.advance(std::chrono::microseconds(1000)) || switched;
+        longestFrame = std::max(longestFrame, frameTimer.seconds());
+        found.clear();
+        slicedTree.query(queries[frames % numQueries], found);
+        slicedChecksum += static_cast<long long>(found.size());
+        ++frames;
+    }
+    benchReport("quadtree rebuild (1 ms slices)", timer.seconds(), numObjects);
+    std::cout << "found: " << slicedChecksum << "  frames: " << frames
+              << "  longest frame: " << longestFrame * 1e3 << " ms\n";
+
+    // The same objects in the compact, flat-array representation.
+    timer.restart();
+    CompactQuadtree compactTree;
+    compactTree.build(objects);
+    benchReport("compact quadtree build", timer.seconds(), numObjects);
+
+    timer.restart();
+    long long compactChecksum = 0;
+    for (const Rect& range : queries) {
+        found.clear();
+        compactTree.query(range, found);
+        compactChecksum += static_cast<long long>(found.size());
+    }
+    benchReport("compact quadtree query 64x64", timer.seconds(), numQueries);
+    std::cout << "checksum: " << compactChecksum << "  memory: " << quadtree.memoryBytes() / 1024
+              << " KiB (quadtree) " << compactTree.memoryBytes() / 1024 << " KiB (compact)\n";
+
+    // Density heat-map style queries: large cells where only the number of objects matters.
+    std::vector<Rect> cells;
+    for (float y = 0; y < worldSize; y += 256.0f) {
+        for (float x = 0; x < worldSize; x += 256.0f) {
+            cells.push_back(Rect{x, y, 256.0f, 256.0f});
+        }
+    }
+    const int heatMapPasses = 20;
+
+    timer.restart();
+    long long listedTotal = 0;
+    for (int pass = 0; pass < heatMapPasses; ++pass) {
+        for (const Rect& cell : cells) {
+            found.clear();
+            quadtree.query(cell, found);
+            listedTotal += static_cast<long long>(found.size());
+        }
+    }
+    benchReport("quadtree query 256x256 + size", timer.seconds(), heatMapPasses * cells.size());
+
+    timer.restart();
+    long long countedTotal = 0;
+    for (int pass = 0; pass < heatMapPasses; ++pass) {
+        for (const Rect& cell : cells) {
+            countedTotal += quadtree.count(cell);
+        }
+    }
+    benchReport("quadtree count 256x256", timer.seconds(), heatMapPasses * cells.size());
+    std::cout << "checksum: " << listedTotal << " (query) " << countedTotal << " (count)\n";
+
+    // Spatially coherent batches: groups of 16 small ranges around the same spot (neighbouring
+    // agents looking around), answered one query at a time and as one packet per group.
+    const int packetSize = 16;
+    std::uniform_real_distribution<float> jitter(-48.0f, 48.0f);
+    std::vector<std::vector<Rect>> packets;
+    for (int i = 0; i + packetSize <= numQueries; i += packetSize) {
+        float cx = position(gen), cy = position(gen);
+        std::vector<Rect> group;
+        for (int k = 0; k < packetSize; ++k) {
+            group.push_back(Rect{cx + jitter(gen), cy + jitter(gen), 32.0f, 32.0f});
+        }
+        packets.push_back(group);
+    }
+
+    timer.restart();
+    long long singleTotal = 0;
+    for (const std::vector<Rect>& group : packets) {
+        for (const Rect& range : group) {
+            found.clear();
+            quadtree.query(range, found);
+            singleTotal += static_cast<long long>(found.size());
+        }
+    }
+    benchReport("quadtree query 32x32 (one by one)", timer.seconds(), packets.size() * packetSize);
+
+    timer.restart();
+    long long packetTotal = 0;
+    std::vector<std::vector<GameObject*>> packetFound;
+    for (const std::vector<Rect>& group : packets) {
+        for (std::vector<GameObject*>& list : packetFound) {
+            list.clear();
+        }
+        quadtree.queryPacket(group, packetFound);
+        for (const std::vector<GameObject*>& list : packetFound) {
+            packetTotal += static_cast<long long>(list.size());
+        }
+    }
+    benchReport("quadtree query 32x32 (packets of 16)", timer.seconds(), packets.size() * packetSize);
+    std::cout << "checksum: " << singleTotal << " (one by one) " << packetTotal << " (packets)\n";
+
+    timer.restart();
+    AabbTree aabbTree;
+    std::vector<int> proxies;
+    proxies.reserve(numObjects);
+    for (GameObject& obj : objects) {
+        proxies.push_back(aabbTree.insert(&obj));
+    }
+    benchReport("aabb tree build", timer.seconds(), numObjects);
+
+    timer.restart();
+    long long aabbChecksum = 0;
+    for (const Rect& range : queries) {
+        found.clear();
+        aabbTree.query(range, found);
+        aabbChecksum += static_cast<long long>(found.size());
+    }
+    benchReport("aabb tree query 64x64", timer.seconds(), numQueries);
+    std::cout << "checksum: " << aabbChecksum << "  height: " << aabbTree.height() << "\n";
+
+    // --- Moving objects ---
+    // Every object drifts with its own constant velocity (bouncing off the world edges);
+    // each frame runs a batch of queries against the new positions.
+    const int numFrames = 30;
+    const int queriesPerFrame = numQueries / numFrames;
+    std::uniform_real_distribution<float> speed(-1.5f, 1.5f);
+    std::vector<float> vx(numObjects), vy(numObjects);
+    for (int i = 0; i < numObjects; ++i) {
+        vx[i] = speed(gen);
+        vy[i] = speed(gen);
+    }
+    auto moveObjects = [&](std::vector<GameObject>& objs, std::vector<float>& velX,
+                           std::vector<float>& velY, int count) {
+        for (int i = 0; i < count; ++i) {
+            Rect& b = objs[i].bounds;
+            if (b.x + velX[i] < 0 || b.x + b.width + velX[i] > worldSize) velX[i] = -velX[i];
+            if (b.y + velY[i] < 0 || b.y + b.height + velY[i] > worldSize) velY[i] = -velY[i];
+            b.x += velX[i];
+            b.y += velY[i];
+        }
+    };
+
+    // Both runs start from the same positions and velocities, so their checksums must match.
+    std::vector<GameObject> start = objects;
+    std::vector<float> startVx = vx, startVy = vy;
+
+    timer.restart();
+    long long rebuildChecksum = 0;
+    for (int frame = 0; frame < numFrames; ++frame) {
+        moveObjects(objects, vx, vy, numObjects);
+        Quadtree frameTree(Rect{0, 0, worldSize, worldSize}, 8);
+        for (GameObject& obj : objects) {
+            frameTree.insert(&obj);
+        }
+        for (int q = 0; q < queriesPerFrame; ++q) {
+            found.clear();
+            frameTree.query(queries[frame * queriesPerFrame + q], found);
+            rebuildChecksum += static_cast<long long>(found.size());
+        }
+    }
+    benchReport("quadtree rebuild per frame", timer.seconds(), numFrames);
+
+    objects = start;
+    vx = startVx;
+    vy = startVy;
+    AabbTree movingTree;
+    for (int i = 0; i < numObjects; ++i) {
+        proxies[i] = movingTree.insert(&objects[i]);
+    }
+    timer.restart();
+    long long updateChecksum = 0;
+    for (int frame = 0; frame < numFrames; ++frame) {
+        moveObjects(objects, vx, vy, numObjects);
+        for (int i = 0; i < numObjects; ++i) {
+            movingTree.update(proxies[i], 4 * vx[i], 4 * vy[i]);
+        }
+        for (int q = 0; q < queriesPerFrame; ++q) {
+            found.clear();
+            movingTree.query(queries[frame * queriesPerFrame + q], found);
+            updateChecksum += static_cast<long long>(found.size());
+        }
+    }
+    benchReport("aabb tree update per frame", timer.seconds(), numFrames);
+    std::cout << "checksum: " << rebuildChecksum << " (quadtree) " << updateChecksum
+              << " (aabb tree)  reinsertions: " << movingTree.reinsertions()
+              << "  rotations: " << movingTree.rotations()
+              << "  height: " << movingTree.height() << "\n";
+
+    // --- All overlapping pairs ---
+    // A smaller crowd (each object's pairs are looked up every frame), same motion as above.
+    const int numPairObjects = 20000;
+    objects = start;
+    objects.erase(objects.begin() + numPairObjects, objects.end());
+    vx = startVx;
+    vy = startVy;
+
+    timer.restart();
+    long long queryPairs = 0;
+    for (int frame = 0; frame < numFrames; ++frame) {
+        moveObjects(objects, vx, vy, numPairObjects);
+        Quadtree frameTree(Rect{0, 0, worldSize, worldSize}, 8);
+        for (GameObject& obj : objects) {
+            frameTree.insert(&obj);
+        }
+        for (GameObject& obj : objects) {
+            found.clear();
+            frameTree.query(obj.bounds, found);
+            queryPairs += static_cast<long long>(found.size()) - 1; // Minus the object itself.
+        }
+    }
+    benchReport("quadtree pairs per frame", timer.seconds(), numFrames);
+
+    objects = start;
+    objects.erase(objects.begin() + numPairObjects, objects.end());
+    vx = startVx;
+    vy = startVy;
+    SweepAndPrune sap;
+    for (GameObject& obj : objects) {
+        sap.add(&obj);
+    }
+    sap.update();
+
+    timer.restart();
+    long long sapPairs = 0;
+    long long pairChanges = 0;
+    for (int frame = 0; frame < numFrames; ++frame) {
+        moveObjects(objects, vx, vy, numPairObjects);
+        sap.update();
+        sapPairs += 2 * static_cast<long long>(sap.pairCount()); // Count both orders, as above.
+        pairChanges += static_cast<long long>(sap.added().size() + sap.removed().size());
+    }
+    benchReport("sweep and prune pairs per frame", timer.seconds(), numFrames);
+    std::cout << "pairs: " << queryPairs << " (quadtree) " << sapPairs
+              << " (sweep and prune)  changes: " << pairChanges << "  swaps: " << sap.swaps()
+              << "\n";
+
+    // --- Storage order ---
+    // The objects were created in random order, so each query's results are scattered through
+    // the array. Reorder them along a Hilbert curve and remap the tree in place.
+    objects = start;
+    Quadtree orderedTree(Rect{0, 0, worldSize, worldSize}, 8);
+    for (GameObject& obj : objects) {
+        orderedTree.insert(&obj);
+    }
+    auto runQueries = [&]() {
+        long long sum = 0;
+        for (const Rect& range : queries) {
+            found.clear();
+            orderedTree.query(range, found);
+            for (const GameObject* obj : found) {
+                sum += obj->id; // Stand-in for the narrow phase: touch every result.
+            }
+        }
+        return sum;
+    };
+
+    timer.restart();
+    long long randomOrderSum = runQueries();
+    benchReport("quadtree query 64x64 (random order)", timer.seconds(), numQueries);
+
+    timer.restart();
+    std::vector<int> oldToNew = reorderAlongHilbert(objects, Rect{0, 0, worldSize, worldSize});
+    orderedTree.remap(objects.data(), oldToNew);
+    benchReport("hilbert reorder + remap", timer.seconds(), numObjects);
+
+    timer.restart();
+    long long hilbertOrderSum = runQueries();
+    benchReport("quadtree query 64x64 (hilbert order)", timer.seconds(), numQueries);
+    std::cout << "checksum: " << randomOrderSum << " (random) " << hilbertOrderSum
+              << " (hilbert)\n";
+    return 0;
+}
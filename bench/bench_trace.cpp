@@ -0,0 +1,53 @@
+// Benchmark: the cost of the tracing macros in common/trace.h, compiled in but idle
+// versus recording. Each "item" is one DP_TRACE_SCOPE (or DP_TRACE_COUNTER) executed.
+
+#include <iostream>
+
+#include "bench/bench_util.h"
+#include "common/trace.h"
+
+namespace {
+
+// Keeps the loop bodies from being optimized away.
+volatile long long sink = 0;
+
+void scopedWork(int i) {
+    DP_TRACE_SCOPE("bench scope");
+    sink = sink + i;
+}
+
+} // namespace
+
+int main() {
+    const int iterations = 2000000;
+
+    BenchTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        sink = sink + i;
+    }
+    benchReport("baseline loop", timer.seconds(), iterations);
+
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        scopedWork(i);
+    }
+    benchReport("scope, tracing stopped", timer.seconds(), iterations);
+
+    trace::start();
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        scopedWork(i);
+    }
+    benchReport("scope, tracing recording", timer.seconds(), iterations);
+
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        DP_TRACE_COUNTER("bench counter", i);
+    }
+    benchReport("counter, tracing recording", timer.seconds(), iterations);
+    trace::stop();
+    trace::clear();
+
+    std::cout << "checksum: " << sink << "\n";
+    return 0;
+}
@@ -0,0 +1,29 @@
+// Small helpers shared by the benchmark programs in this directory.
+// The benchmarks double as the training workloads for PGO builds (see README.md),
+// so they should exercise the same hot paths as the real programs.
+
+#pragma once
+
+#include <chrono>   // For steady_clock based timing
+#include <cstdio>   // For printf-style result lines
+
+// Measures wall-clock time from construction (or the last restart()).
+class BenchTimer {
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    void restart() { start = std::chrono::steady_clock::now(); }
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Prints one result line: total time, and the time per item so runs of different sizes compare.
+inline void benchReport(const char* name, double seconds, long long items) {
+    std::printf("%-36s %10.3f ms  %10.1f ns/item  (%lld items)\n",
+                name, seconds * 1e3, items > 0 ? seconds * 1e9 / items : 0.0, items);
+}
@@ -0,0 +1,110 @@
+# Build profiles shared by every target in the project:
+#
+#   DP_NATIVE_ARCH  Tune for the build machine (-march=native). Binaries won't run on older CPUs.
+#   DP_LTO          Link-time optimization, so the small shared libraries inline across targets.
+#   DP_PGO          Profile-guided optimization: OFF, GENERATE or USE.
+#                   GENERATE builds instrumented binaries; `cmake --build <dir> --target pgo-train`
+#                   then runs every benchmark registered with dp_add_benchmark() to collect
+#                   profiles into DP_PGO_DIR. USE rebuilds with those profiles applied.
+#
+# The Release/RelWithDebInfo profiles themselves are the standard CMAKE_BUILD_TYPE values;
+# CMakePresets.json combines them with the options above.
+
+include(CheckCXXCompilerFlag)
+include(CheckIPOSupported)
+
+option(DP_NATIVE_ARCH "Optimize for the build machine's CPU (-march=native)" OFF)
+option(DP_LTO "Enable link-time optimization" OFF)
+set(DP_PGO "OFF" CACHE STRING "Profile-guided optimization mode: OFF, GENERATE or USE")
+set_property(CACHE DP_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(DP_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profiles" CACHE PATH "Directory holding PGO profile data")
+
+if(DP_NATIVE_ARCH)
+  check_cxx_compiler_flag(-march=native DP_HAVE_MARCH_NATIVE)
+  if(DP_HAVE_MARCH_NATIVE)
+    add_compile_options(-march=native)
+  else()
+    message(WARNING "DP_NATIVE_ARCH is ON but the compiler does not accept -march=native")
+  endif()
+endif()
+
+if(DP_LTO)
+  check_ipo_supported(RESULT DP_HAVE_IPO OUTPUT DP_IPO_ERROR LANGUAGES CXX)
+  if(DP_HAVE_IPO)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+  else()
+    message(WARNING "DP_LTO is ON but LTO is not supported: ${DP_IPO_ERROR}")
+  endif()
+endif()
+
+string(TOUPPER "${DP_PGO}" DP_PGO)
+set(DP_CLANG_PROFDATA "${DP_PGO_DIR}/merged.profdata")
+
+if(DP_PGO STREQUAL "GENERATE")
+  file(MAKE_DIRECTORY "${DP_PGO_DIR}/raw")
+  if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    # Atomic counter updates keep the profiles consistent for multi-threaded programs.
+    add_compile_options(-fprofile-generate=${DP_PGO_DIR} -fprofile-update=atomic)
+    add_link_options(-fprofile-generate=${DP_PGO_DIR})
+  elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    add_compile_options(-fprofile-instr-generate)
+    add_link_options(-fprofile-instr-generate)
+    find_program(DP_LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+  else()
+    message(FATAL_ERROR "DP_PGO=GENERATE is only supported with GCC or Clang")
+  endif()
+elseif(DP_PGO STREQUAL "USE")
+  if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    # -fprofile-partial-training keeps code the benchmarks never reach optimized normally.
+    add_compile_options(-fprofile-use=${DP_PGO_DIR} -fprofile-correction
+                        -fprofile-partial-training -Wno-missing-profile)
+    add_link_options(-fprofile-use=${DP_PGO_DIR})
+  elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    if(NOT EXISTS "${DP_CLANG_PROFDATA}")
+      message(FATAL_ERROR "DP_PGO=USE but ${DP_CLANG_PROFDATA} does not exist; run the pgo-train target first")
+    endif()
+    add_compile_options(-fprofile-instr-use=${DP_CLANG_PROFDATA} -Wno-profile-instr-unprofiled)
+  else()
+    message(FATAL_ERROR "DP_PGO=USE is only supported with GCC or Clang")
+  endif()
+elseif(NOT DP_PGO STREQUAL "OFF")
+  message(FATAL_ERROR "DP_PGO must be OFF, GENERATE or USE (got '${DP_PGO}')")
+endif()
+
+# dp_add_benchmark(<name> <sources>...)
+# Adds a benchmark executable and registers it as a PGO training workload.
+function(dp_add_benchmark name)
+  add_executable(${name} ${ARGN})
+  set_property(GLOBAL APPEND PROPERTY DP_PGO_TRAINING_TARGETS ${name})
+endfunction()
+
+# dp_add_pgo_train_target()
+# Called once all benchmarks are known. In GENERATE mode, adds the `pgo-train` target that runs
+# every registered benchmark (and, for Clang, merges the raw profiles for the USE build).
+function(dp_add_pgo_train_target)
+  if(NOT DP_PGO STREQUAL "GENERATE")
+    return()
+  endif()
+
+  get_property(targets GLOBAL PROPERTY DP_PGO_TRAINING_TARGETS)
+  set(commands)
+  foreach(target IN LISTS targets)
+    list(APPEND commands COMMAND ${CMAKE_COMMAND} -E echo "PGO training: ${target}")
+    if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+      list(APPEND commands COMMAND ${CMAKE_COMMAND} -E env
+           "LLVM_PROFILE_FILE=${DP_PGO_DIR}/raw/${target}-%p.profraw" $<TARGET_FILE:${target}>)
+    else()
+      list(APPEND commands COMMAND $<TARGET_FILE:${target}>)
+    endif()
+  endforeach()
+
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    list(APPEND commands COMMAND ${DP_LLVM_PROFDATA} merge -output=${DP_CLANG_PROFDATA} ${DP_PGO_DIR}/raw)
+  endif()
+
+  add_custom_target(pgo-train ${commands}
+                    DEPENDS ${targets}
+                    WORKING_DIRECTORY "${CMAKE_BINARY_DIR}"
+                    COMMENT "Running benchmark workloads to collect PGO profiles in ${DP_PGO_DIR}"
+                    VERBATIM)
+endfunction()
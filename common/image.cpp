@@ -0,0 +1,65 @@
+#include "common/image.h"
+
+#include <cmath> // For std::floor/std::ceil when computing pixel spans
+
+void fillImage(const ImageView& view, Color color) {
+    if (view.empty()) {
+        return;
+    }
+    // Fill the first row pixel by pixel, then copy it to the others.
+    for (int x = 0; x < view.width; ++x) {
+        view.set(x, 0, color);
+    }
+    std::size_t rowBytes = static_cast<std::size_t>(view.width) * view.channels;
+    for (int y = 1; y < view.height; ++y) {
+        std::copy(view.row(0), view.row(0) + rowBytes, view.row(y));
+    }
+}
+
+void fillCircle(const ImageView& view, float cx, float cy, float radius, Color color) {
+    // Pixel centres are at (x + 0.5, y + 0.5); a pixel is inside if its centre is.
+    int y0 = std::max(0, static_cast<int>(std::floor(cy - radius)));
+    int y1 = std::min(view.height - 1, static_cast<int>(std::ceil(cy + radius)));
+    for (int y = y0; y <= y1; ++y) {
+        float dy = y + 0.5f - cy;
+        float span2 = radius * radius - dy * dy;
+        if (span2 < 0) {
+            continue;
+        }
+        // Solve for the horizontal span of this row once instead of testing every pixel.
+        float span = std::sqrt(span2);
+        int x0 = std::max(0, static_cast<int>(std::ceil(cx - span - 0.5f)));
+        int x1 = std::min(view.width - 1, static_cast<int>(std::floor(cx + span - 0.5f)));
+        for (int x = x0; x <= x1; ++x) {
+            view.set(x, y, color);
+        }
+    }
+}
+
+void strokeLine(const ImageView& view, float x0, float y0, float x1, float y1, float thickness, Color color) {
+    // A thick line with round caps is the set of points within 'radius' of the segment.
+    float radius = std::max(thickness * 0.5f, 0.5f);
+    int minX = std::max(0, static_cast<int>(std::floor(std::min(x0, x1) - radius)));
+    int maxX = std::min(view.width - 1, static_cast<int>(std::ceil(std::max(x0, x1) + radius)));
+    int minY = std::max(0, static_cast<int>(std::floor(std::min(y0, y1) - radius)));
+    int maxY = std::min(view.height - 1, static_cast<int>(std::ceil(std::max(y0, y1) + radius)));
+
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float length2 = dx * dx + dy * dy;
+    float radius2 = radius * radius;
+
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            float px = x + 0.5f - x0;
+            float py = y + 0.5f - y0;
+            // Project the pixel centre onto the segment, clamped to its end points.
+            float t = length2 > 0 ? std::min(1.0f, std::max(0.0f, (px * dx + py * dy) / length2)) : 0.0f;
+            float ex = px - t * dx;
+            float ey = py - t * dy;
+            if (ex * ex + ey * ey <= radius2) {
+                view.set(x, y, color);
+            }
+        }
+    }
+}
@@ -0,0 +1,100 @@
+// A common 8-bit image buffer shared by all generators, plus zero-copy views into it.
+//
+// Image owns tightly packed pixels (1 = gray, 3 = RGB or 4 = RGBA channels per pixel).
+// ImageView is a non-owning window onto pixels anywhere in memory: it has its own width
+// and height but keeps the parent's row stride, so a sub-rectangle of an image (one tile,
+// one thumbnail) can be rendered into or encoded without copying a single byte.
+// The encoders for these images live in common/image_codec.h.
+
+#pragma once
+
+#include <algorithm> // For std::min/std::max when clipping
+#include <cstddef>   // For std::ptrdiff_t strides
+#include <cstdint>   // For std::uint8_t pixel data
+#include <vector>    // For the owned pixel storage
+
+// An 8-bit color. Gray images store its luminance; RGB images ignore alpha.
+struct Color {
+    std::uint8_t r, g, b, a = 255;
+};
+
+struct ImageView {
+    std::uint8_t* data = nullptr; // First byte of pixel (0, 0).
+    int width = 0;
+    int height = 0;
+    int channels = 0;             // Bytes per pixel: 1, 3 or 4.
+    std::ptrdiff_t stride = 0;    // Bytes from the start of one row to the start of the next.
+
+    bool empty() const { return data == nullptr || width <= 0 || height <= 0; }
+
+    std::uint8_t* row(int y) const { return data + y * stride; }
+    std::uint8_t* pixel(int x, int y) const { return row(y) + x * channels; }
+
+    // True when rows follow each other without gaps, so the whole view is one memory block.
+    bool contiguous() const { return stride == static_cast<std::ptrdiff_t>(width) * channels; }
+
+    // A view of the rectangle (x, y, w, h) of this view, clipped to its bounds.
+    ImageView subview(int x, int y, int w, int h) const {
+        int x0 = std::max(0, x), y0 = std::max(0, y);
+        int x1 = std::min(width, x + w), y1 = std::min(height, y + h);
+        ImageView view = *this;
+        view.data = (x1 > x0 && y1 > y0) ? pixel(x0, y0) : nullptr;
+        view.width = std::max(0, x1 - x0);
+        view.height = std::max(0, y1 - y0);
+        return view;
+    }
+
+    // Writes 'color' to pixel (x, y) in this view's channel layout. No bounds check.
+    void set(int x, int y, Color color) const {
+        std::uint8_t* p = pixel(x, y);
+        if (channels == 1) {
+            // Integer Rec. 601 luma; the weights add up to 256.
+            p[0] = static_cast<std::uint8_t>((color.r * 77 + color.g * 150 + color.b * 29) >> 8);
+            return;
+        }
+        p[0] = color.r;
+        p[1] = color.g;
+        p[2] = color.b;
+        if (channels == 4) {
+            p[3] = color.a;
+        }
+    }
+};
+
+class Image {
+public:
+    Image() = default;
+    Image(int width, int height, int channels)
+        : w(width), h(height), c(channels),
+          pixels(static_cast<std::size_t>(width) * height * channels) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int channels() const { return c; }
+
+    std::uint8_t* data() { return pixels.data(); }
+    const std::uint8_t* data() const { return pixels.data(); }
+    std::size_t sizeBytes() const { return pixels.size(); }
+
+    ImageView view() {
+        return ImageView{pixels.data(), w, h, c, static_cast<std::ptrdiff_t>(w) * c};
+    }
+    ImageView view(int x, int y, int width, int height) { return view().subview(x, y, width, height); }
+
+private:
+    int w = 0;
+    int h = 0;
+    int c = 0;
+    std::vector<std::uint8_t> pixels;
+};
+
+// --- Simple rasterization, used by the vector-art generators to produce raster output ---
+
+// Sets every pixel of 'view' to 'color'.
+void fillImage(const ImageView& view, Color color);
+
+// Fills the disc centred at (cx, cy). Parts outside the view are clipped.
+void fillCircle(const ImageView& view, float cx, float cy, float radius, Color color);
+
+// Draws a line segment with round caps, 'thickness' pixels wide. Clipped to the view.
+void strokeLine(const ImageView& view, float x0, float y0, float x1, float y1, float thickness, Color color);
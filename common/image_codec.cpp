@@ -0,0 +1,261 @@
+#include "common/image_codec.h"
+
+#include <cctype>   // For std::tolower on file extensions
+#include <cstring>  // For std::memcmp/std::memcpy
+#include <fstream>  // For writing files
+#include <iostream> // For error messages
+
+#include <zlib.h>   // For deflate and crc32 in the PNG encoder
+
+#include "common/trace.h"
+
+namespace {
+
+void putU32BE(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool supportedChannels(const ImageView& view) {
+    return !view.empty() && (view.channels == 1 || view.channels == 3 || view.channels == 4);
+}
+
+// --- PNG helpers ---
+
+// Appends a PNG chunk: length, type, data, CRC of type + data.
+void putPngChunk(std::vector<std::uint8_t>& out, const char type[4], const std::uint8_t* data, std::size_t size) {
+    putU32BE(out, static_cast<std::uint32_t>(size));
+    std::size_t typeStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) {
+        out.insert(out.end(), data, data + size);
+    }
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, out.data() + typeStart, static_cast<uInt>(size + 4));
+    putU32BE(out, static_cast<std::uint32_t>(crc));
+}
+
+} // namespace
+
+bool encodePpm(const ImageView& view, std::vector<std::uint8_t>& out) {
+    DP_TRACE_SCOPE("encode ppm");
+    if (!supportedChannels(view)) {
+        return false;
+    }
+    std::string header = (view.channels == 1 ? "P5\n" : "P6\n") + std::to_string(view.width) + " " +
+                         std::to_string(view.height) + "\n255\n";
+    out.insert(out.end(), header.begin(), header.end());
+
+    int outChannels = view.channels == 1 ? 1 : 3;
+    std::size_t start = out.size();
+    out.resize(start + static_cast<std::size_t>(view.width) * view.height * outChannels);
+    std::uint8_t* dst = out.data() + start;
+    for (int y = 0; y < view.height; ++y) {
+        const std::uint8_t* src = view.row(y);
+        if (view.channels == outChannels) {
+            std::memcpy(dst, src, static_cast<std::size_t>(view.width) * outChannels);
+            dst += static_cast<std::size_t>(view.width) * outChannels;
+        } else {
+            // RGBA -> RGB: PPM has no alpha channel.
+            for (int x = 0; x < view.width; ++x, src += 4, dst += 3) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+        }
+    }
+    return true;
+}
+
+bool encodeQoi(const ImageView& view, std::vector<std::uint8_t>& out) {
+    DP_TRACE_SCOPE("encode qoi");
+    if (!supportedChannels(view)) {
+        return false;
+    }
+    // Op codes from the QOI specification (qoiformat.org).
+    const std::uint8_t OP_INDEX = 0x00, OP_DIFF = 0x40, OP_LUMA = 0x80, OP_RUN = 0xc0;
+    const std::uint8_t OP_RGB = 0xfe, OP_RGBA = 0xff;
+
+    int outChannels = view.channels == 4 ? 4 : 3;
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    putU32BE(out, static_cast<std::uint32_t>(view.width));
+    putU32BE(out, static_cast<std::uint32_t>(view.height));
+    out.push_back(static_cast<std::uint8_t>(outChannels));
+    out.push_back(0); // sRGB with linear alpha
+    out.reserve(out.size() + static_cast<std::size_t>(view.width) * view.height * (outChannels + 1) / 2);
+
+    struct Rgba { std::uint8_t r, g, b, a; };
+    Rgba index[64] = {};
+    Rgba prev = {0, 0, 0, 255};
+    int run = 0;
+    long long remaining = static_cast<long long>(view.width) * view.height;
+
+    for (int y = 0; y < view.height; ++y) {
+        const std::uint8_t* src = view.row(y);
+        for (int x = 0; x < view.width; ++x, src += view.channels) {
+            --remaining;
+            Rgba px;
+            if (view.channels == 1) {
+                px = {src[0], src[0], src[0], 255};
+            } else {
+                px = {src[0], src[1], src[2], view.channels == 4 ? src[3] : std::uint8_t(255)};
+            }
+
+            if (std::memcmp(&px, &prev, sizeof(px)) == 0) {
+                ++run;
+                if (run == 62 || remaining == 0) {
+                    out.push_back(static_cast<std::uint8_t>(OP_RUN | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                out.push_back(static_cast<std::uint8_t>(OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            int hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+            if (std::memcmp(&index[hash], &px, sizeof(px)) == 0) {
+                out.push_back(static_cast<std::uint8_t>(OP_INDEX | hash));
+            } else {
+                index[hash] = px;
+                if (px.a == prev.a) {
+                    // Differences wrap around like the spec's signed 8-bit arithmetic.
+                    int vr = static_cast<signed char>(px.r - prev.r);
+                    int vg = static_cast<signed char>(px.g - prev.g);
+                    int vb = static_cast<signed char>(px.b - prev.b);
+                    int vgR = vr - vg;
+                    int vgB = vb - vg;
+                    if (vr >= -2 && vr <= 1 && vg >= -2 && vg <= 1 && vb >= -2 && vb <= 1) {
+                        out.push_back(static_cast<std::uint8_t>(OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+                    } else if (vgR >= -8 && vgR <= 7 && vg >= -32 && vg <= 31 && vgB >= -8 && vgB <= 7) {
+                        out.push_back(static_cast<std::uint8_t>(OP_LUMA | (vg + 32)));
+                        out.push_back(static_cast<std::uint8_t>((vgR + 8) << 4 | (vgB + 8)));
+                    } else {
+                        out.insert(out.end(), {OP_RGB, px.r, px.g, px.b});
+                    }
+                } else {
+                    out.insert(out.end(), {OP_RGBA, px.r, px.g, px.b, px.a});
+                }
+            }
+            prev = px;
+        }
+    }
+
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1}); // End marker
+    return true;
+}
+
+bool encodePng(const ImageView& view, std::vector<std::uint8_t>& out, int level) {
+    DP_TRACE_SCOPE("encode png");
+    if (!supportedChannels(view)) {
+        return false;
+    }
+    static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.insert(out.end(), signature, signature + 8);
+
+    std::vector<std::uint8_t> header;
+    putU32BE(header, static_cast<std::uint32_t>(view.width));
+    putU32BE(header, static_cast<std::uint32_t>(view.height));
+    header.push_back(8); // Bit depth
+    header.push_back(view.channels == 1 ? 0 : view.channels == 3 ? 2 : 6); // Gray, RGB or RGBA
+    header.insert(header.end(), {0, 0, 0}); // Deflate, adaptive filtering, no interlace
+    putPngChunk(out, "IHDR", header.data(), header.size());
+
+    z_stream stream = {};
+    if (deflateInit(&stream, level) != Z_OK) {
+        return false;
+    }
+
+    // Every row gets the "Up" filter (difference to the row above): one subtraction per byte,
+    // and it turns smooth gradients and flat areas into long runs of zeros for deflate.
+    std::size_t rowBytes = static_cast<std::size_t>(view.width) * view.channels;
+    std::vector<std::uint8_t> filtered(rowBytes + 1);
+    std::vector<std::uint8_t> compressed(deflateBound(&stream, static_cast<uLong>((rowBytes + 1) * view.height)));
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    for (int y = 0; y < view.height; ++y) {
+        const std::uint8_t* current = view.row(y);
+        filtered[0] = 2; // Filter type: Up
+        if (y == 0) {
+            std::memcpy(filtered.data() + 1, current, rowBytes);
+        } else {
+            const std::uint8_t* above = view.row(y - 1);
+            for (std::size_t i = 0; i < rowBytes; ++i) {
+                filtered[i + 1] = static_cast<std::uint8_t>(current[i] - above[i]);
+            }
+        }
+        stream.next_in = filtered.data();
+        stream.avail_in = static_cast<uInt>(filtered.size());
+        if (deflate(&stream, y + 1 == view.height ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+            deflateEnd(&stream);
+            return false;
+        }
+    }
+    std::size_t compressedSize = compressed.size() - stream.avail_out;
+    deflateEnd(&stream);
+
+    putPngChunk(out, "IDAT", compressed.data(), compressedSize);
+    putPngChunk(out, "IEND", nullptr, 0);
+    return true;
+}
+
+bool encodeImage(const ImageView& view, ImageFormat format, std::vector<std::uint8_t>& out) {
+    switch (format) {
+    case ImageFormat::Ppm: return encodePpm(view, out);
+    case ImageFormat::Qoi: return encodeQoi(view, out);
+    case ImageFormat::Png: return encodePng(view, out);
+    }
+    return false;
+}
+
+bool imageFormatFromFilename(const std::string& filename, ImageFormat& format) {
+    std::size_t dot = filename.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = filename.substr(dot + 1);
+    for (char& ch : extension) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    if (extension == "ppm" || extension == "pgm") {
+        format = ImageFormat::Ppm;
+    } else if (extension == "qoi") {
+        format = ImageFormat::Qoi;
+    } else if (extension == "png") {
+        format = ImageFormat::Png;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool writeImage(const ImageView& view, const std::string& filename) {
+    DP_TRACE_SCOPE("write image");
+    ImageFormat format;
+    if (!imageFormatFromFilename(filename, format)) {
+        std::cerr << "Error: Unknown image format for " << filename << " (use .png, .qoi or .ppm)" << std::endl;
+        return false;
+    }
+
+    std::vector<std::uint8_t> encoded;
+    if (!encodeImage(view, format, encoded)) {
+        std::cerr << "Error: Could not encode " << filename << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+    if (!file) {
+        std::cerr << "Error: Could not write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
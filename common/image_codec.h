@@ -0,0 +1,42 @@
+// Encoders for the shared Image/ImageView type (common/image.h).
+//
+//   PPM - binary P5 (gray) / P6 (RGB). No compression at all: the fastest to write.
+//   QOI - "Quite OK Image" format: lossless, one pass, a few ops per pixel. Typically
+//         compresses about as well as a fast PNG at a fraction of the cost.
+//   PNG - the universally viewable option, compressed with zlib at a fast level (1) by default.
+//
+// All encoders read straight from the (possibly strided) view, so a tile or thumbnail of a
+// larger image is encoded without copying it out first. Alpha is dropped by PPM; gray images
+// are written as RGB by QOI (which has no gray mode).
+
+#pragma once
+
+#include <cstdint>  // For std::uint8_t output bytes
+#include <string>   // For file names
+#include <vector>   // For in-memory encoded output
+
+#include "common/image.h"
+
+enum class ImageFormat {
+    Ppm,
+    Qoi,
+    Png,
+};
+
+// Level 1 trades a little file size for several times faster compression than zlib's default.
+const int PNG_FAST_LEVEL = 1;
+
+// Each encode function appends the encoded file to 'out' and returns false if the view
+// can't be represented (empty, or an unsupported channel count).
+bool encodePpm(const ImageView& view, std::vector<std::uint8_t>& out);
+bool encodeQoi(const ImageView& view, std::vector<std::uint8_t>& out);
+bool encodePng(const ImageView& view, std::vector<std::uint8_t>& out, int level = PNG_FAST_LEVEL);
+
+bool encodeImage(const ImageView& view, ImageFormat format, std::vector<std::uint8_t>& out);
+
+// Picks the format from the file extension (.ppm/.pgm, .qoi, .png). Returns false if unknown.
+bool imageFormatFromFilename(const std::string& filename, ImageFormat& format);
+
+// Encodes 'view' in the format chosen by the file extension and writes it to 'filename'.
+// Prints an error and returns false on failure.
+bool writeImage(const ImageView& view, const std::string& filename);
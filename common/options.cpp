@@ -0,0 +1,209 @@
+#include "common/options.h"
+
+#include <cstdlib>  // For std::strtol/std::strtod
+#include <fstream>  // For config files
+#include <iostream> // For error messages
+#include <sstream>  // For formatting defaults
+
+namespace {
+
+std::string trim(const std::string& text) {
+    std::size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    std::size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+template <typename T>
+std::string toText(const T& value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+} // namespace
+
+Options::Options(std::string program, std::string description)
+    : program(std::move(program)), description(std::move(description)) {}
+
+void Options::add(const std::string& name, int& value, const std::string& help, int minimum, int maximum) {
+    options.push_back({name, help, toText(value), false, [&value, name, minimum, maximum](const std::string& text) {
+        char* end = nullptr;
+        long parsed = std::strtol(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0') {
+            std::cerr << "Error: --" << name << " expects an integer, got '" << text << "'" << std::endl;
+            return false;
+        }
+        if (parsed < minimum || parsed > maximum) {
+            std::cerr << "Error: --" << name << " must be between " << minimum << " and " << maximum << std::endl;
+            return false;
+        }
+        value = static_cast<int>(parsed);
+        return true;
+    }});
+}
+
+void Options::add(const std::string& name, double& value, const std::string& help, double minimum, double maximum) {
+    options.push_back({name, help, toText(value), false, [&value, name, minimum, maximum](const std::string& text) {
+        char* end = nullptr;
+        double parsed = std::strtod(text.c_str(), &end);
+        if (text.empty() || *end != '\0') {
+            std::cerr << "Error: --" << name << " expects a number, got '" << text << "'" << std::endl;
+            return false;
+        }
+        if (!(parsed >= minimum && parsed <= maximum)) {
+            std::cerr << "Error: --" << name << " must be between " << minimum << " and " << maximum << std::endl;
+            return false;
+        }
+        value = parsed;
+        return true;
+    }});
+}
+
+void Options::add(const std::string& name, std::string& value, const std::string& help) {
+    options.push_back({name, help, value.empty() ? "\"\"" : value, false, [&value](const std::string& text) {
+        value = text;
+        return true;
+    }});
+}
+
+void Options::add(const std::string& name, bool& value, const std::string& help) {
+    options.push_back({name, help, value ? "true" : "false", true, [&value, name](const std::string& text) {
+        if (text == "true" || text == "1" || text == "yes" || text == "on") {
+            value = true;
+        } else if (text == "false" || text == "0" || text == "no" || text == "off") {
+            value = false;
+        } else {
+            std::cerr << "Error: --" << name << " expects true or false, got '" << text << "'" << std::endl;
+            return false;
+        }
+        return true;
+    }});
+}
+
+const Options::Option* Options::find(const std::string& name) const {
+    for (const Option& option : options) {
+        if (option.name == name) {
+            return &option;
+        }
+    }
+    return nullptr;
+}
+
+bool Options::set(const std::string& name, const std::string& value, bool hasValue, const std::string& where) {
+    const Option* option = find(name);
+    if (!option) {
+        // --no-<flag> turns a boolean off.
+        if (name.compare(0, 3, "no-") == 0 && !hasValue) {
+            const Option* flag = find(name.substr(3));
+            if (flag && flag->isFlag) {
+                return flag->set("false");
+            }
+        }
+        std::cerr << "Error: unknown setting '" << name << "'" << where << " (see --help)" << std::endl;
+        return false;
+    }
+    if (!hasValue) {
+        if (!option->isFlag) {
+            std::cerr << "Error: --" << name << " needs a value" << where << std::endl;
+            return false;
+        }
+        return option->set("true");
+    }
+    return option->set(value);
+}
+
+bool Options::loadFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open config file " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        std::string where = " in " + filename + ":" + std::to_string(lineNumber);
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            if (!set(line, "", false, where)) {
+                return false;
+            }
+        } else if (!set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)), true, where)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Options::parse(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printHelp(std::cout);
+            exit = 0;
+            return false;
+        }
+        if (arg.compare(0, 2, "--") != 0 || arg.size() == 2) {
+            std::cerr << "Error: unexpected argument '" << arg << "' (see --help)" << std::endl;
+            exit = 1;
+            return false;
+        }
+
+        std::string name = arg.substr(2);
+        std::string value;
+        bool hasValue = false;
+        std::size_t equals = name.find('=');
+        if (equals != std::string::npos) {
+            value = name.substr(equals + 1);
+            name.erase(equals);
+            hasValue = true;
+        } else {
+            // "--name value" for everything except flags, which never take a separate value.
+            const Option* option = find(name);
+            bool wantsValue = name == "config" || (option && !option->isFlag);
+            if (wantsValue && i + 1 < argc) {
+                value = argv[++i];
+                hasValue = true;
+            }
+        }
+
+        bool ok;
+        if (name == "config") {
+            ok = hasValue ? loadFile(value) : (std::cerr << "Error: --config needs a file name" << std::endl, false);
+        } else {
+            ok = set(name, value, hasValue, "");
+        }
+        if (!ok) {
+            exit = 1;
+            return false;
+        }
+    }
+    return true;
+}
+
+void Options::printHelp(std::ostream& out) const {
+    out << "Usage: " << program << " [--setting=value ...] [--config FILE]\n";
+    if (!description.empty()) {
+        out << description << "\n";
+    }
+    out << "\nSettings:\n";
+    for (const Option& option : options) {
+        std::string left = "  --" + option.name + (option.isFlag ? "" : "=VALUE");
+        out << left;
+        out << std::string(left.size() < 28 ? 28 - left.size() : 1, ' ');
+        out << option.help << " (default: " << option.defaultValue << ")\n";
+    }
+    out << "  --config=FILE             Read settings from FILE, one \"name = value\" per line\n";
+    out << "  --help                    Show this message\n";
+}
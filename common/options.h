@@ -0,0 +1,66 @@
+// Command-line and config-file settings for the programs.
+//
+// Each program keeps its settings in ordinary variables holding the defaults, registers them
+// once, and lets Options overwrite them from the command line:
+//
+//   int width = 800;
+//   Options options("julia_fractal", "Renders a Julia set.");
+//   options.add("width", width, "Image width in pixels", 1);
+//   if (!options.parse(argc, argv)) return options.exitCode();
+//
+// Accepted forms: --name=value, --name value, and --flag / --no-flag for booleans.
+// --config FILE reads "name = value" lines (# starts a comment) at that point of the command
+// line, so later arguments override the file. --help prints every setting with its default.
+
+#pragma once
+
+#include <functional> // For the per-option parse callbacks
+#include <limits>     // For the default (unbounded) ranges
+#include <ostream>    // For printing help
+#include <string>     // For names, values and help texts
+#include <vector>     // For the registered options
+
+class Options {
+public:
+    Options(std::string program, std::string description);
+
+    // Registers a setting. 'value' holds the default and receives the parsed value.
+    // Numbers outside [minimum, maximum] are rejected with an error message.
+    void add(const std::string& name, int& value, const std::string& help,
+             int minimum = std::numeric_limits<int>::min(),
+             int maximum = std::numeric_limits<int>::max());
+    void add(const std::string& name, double& value, const std::string& help,
+             double minimum = -std::numeric_limits<double>::infinity(),
+             double maximum = std::numeric_limits<double>::infinity());
+    void add(const std::string& name, std::string& value, const std::string& help);
+    void add(const std::string& name, bool& value, const std::string& help);
+
+    // Parses the command line. Returns false when the program should exit right away,
+    // either because of an error (already printed) or because --help was shown.
+    bool parse(int argc, char** argv);
+
+    // Exit status to use when parse() returned false: 0 after --help, 1 after an error.
+    int exitCode() const { return exit; }
+
+    // Reads "name = value" lines from a file. Returns false (after printing why) on error.
+    bool loadFile(const std::string& filename);
+
+    void printHelp(std::ostream& out) const;
+
+private:
+    struct Option {
+        std::string name;
+        std::string help;
+        std::string defaultValue;
+        bool isFlag;
+        std::function<bool(const std::string&)> set; // Returns false if the text is invalid.
+    };
+
+    const Option* find(const std::string& name) const;
+    bool set(const std::string& name, const std::string& value, bool hasValue, const std::string& where);
+
+    std::string program;
+    std::string description;
+    std::vector<Option> options;
+    int exit = 0;
+};
@@ -0,0 +1,220 @@
+#include "common/scheduler.h"
+
+#include <string> // For worker thread names
+
+#include "common/trace.h"
+
+namespace {
+
+// Which scheduler (if any) the current thread is a worker of, and its slot index.
+thread_local Scheduler* tlsScheduler = nullptr;
+thread_local int tlsSlot = 0;
+
+} // namespace
+
+Scheduler::Scheduler(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if (numThreads == 0) {
+        numThreads = 1; // hardware_concurrency() may not know.
+    }
+
+    // Slot 0 belongs to whichever outside thread waits on a group; it counts as one of
+    // the numThreads, so we only start numThreads - 1 background workers.
+    for (unsigned i = 0; i < numThreads; ++i) {
+        slots.push_back(std::make_unique<Slot>());
+    }
+    for (unsigned i = 1; i < numThreads; ++i) {
+        threads.emplace_back([this, i] { workerLoop(static_cast<int>(i)); });
+    }
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+Scheduler& Scheduler::instance() {
+    static Scheduler scheduler;
+    return scheduler;
+}
+
+int Scheduler::currentSlot() const {
+    return tlsScheduler == this ? tlsSlot : 0;
+}
+
+void Scheduler::spawn(std::function<void()> fn, TaskPriority priority, TaskGroup* group) {
+    if (group) {
+        group->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int p = static_cast<int>(priority);
+    Slot& slot = *slots[currentSlot()];
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.queues[p].push_back(Task{std::move(fn), group});
+        slot.sizes[p].fetch_add(1, std::memory_order_relaxed);
+    }
+    queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the sleep mutex (even briefly) orders this against a worker that has just
+    // checked 'queued' and is about to sleep, so the notification can't be lost.
+    if (!threads.empty()) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wakeUp.notify_one();
+    }
+}
+
+bool Scheduler::popOwn(Slot& slot, int priority, Task& task) {
+    if (slot.sizes[priority].load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    std::deque<Task>& queue = slot.queues[priority];
+    if (queue.empty()) {
+        return false;
+    }
+    task = std::move(queue.back());
+    queue.pop_back();
+    slot.sizes[priority].fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Scheduler::steal(int thiefIndex, int priority, Task& task) {
+    // Start at the neighbouring slot so thieves spread out instead of all hitting slot 0.
+    int count = static_cast<int>(slots.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Slot& victim = *slots[(thiefIndex + offset) % count];
+        if (victim.sizes[priority].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        std::deque<Task>& queue = victim.queues[priority];
+        if (queue.empty()) {
+            continue;
+        }
+        task = std::move(queue.front());
+        queue.pop_front();
+        victim.sizes[priority].fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool Scheduler::tryRunOne(int slotIndex) {
+    Slot& own = *slots[slotIndex];
+    Task task;
+    for (int p = 0; p < NUM_PRIORITIES; ++p) {
+        if (popOwn(own, p, task)) {
+            execute(slotIndex, task);
+            return true;
+        }
+        if (steal(slotIndex, p, task)) {
+            own.stolen.fetch_add(1, std::memory_order_relaxed);
+            execute(slotIndex, task);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::execute(int slotIndex, Task& task) {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+
+    TaskGroup* group = task.group;
+    try {
+        task.fn();
+    } catch (...) {
+        if (group) {
+            std::lock_guard<std::mutex> lock(group->errorMutex);
+            if (!group->error) {
+                group->error = std::current_exception();
+            }
+        }
+    }
+    // Release the task's captures before reporting completion: the group's waiter may
+    // destroy objects they refer to as soon as 'pending' hits zero.
+    task.fn = nullptr;
+
+    slots[slotIndex]->executed.fetch_add(1, std::memory_order_relaxed);
+    if (group) {
+        group->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void Scheduler::workerLoop(int slotIndex) {
+    tlsScheduler = this;
+    tlsSlot = slotIndex;
+    trace::setThreadName("worker " + std::to_string(slotIndex));
+
+    while (true) {
+        if (tryRunOne(slotIndex)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] {
+            return stopping.load() || queued.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+std::vector<Scheduler::SlotStats> Scheduler::stats() const {
+    std::vector<SlotStats> result;
+    for (const auto& slot : slots) {
+        result.push_back({slot->executed.load(), slot->stolen.load()});
+    }
+    return result;
+}
+
+void Scheduler::resetStats() {
+    for (auto& slot : slots) {
+        slot->executed = 0;
+        slot->stolen = 0;
+    }
+}
+
+// --- TaskGroup ---
+
+TaskGroup::~TaskGroup() {
+    // Never leave tasks behind that point at a destroyed group.
+    if (pending.load(std::memory_order_acquire) > 0) {
+        try {
+            wait();
+        } catch (...) {
+            // Destructors must not throw; the error was the caller's to collect via wait().
+        }
+    }
+}
+
+void TaskGroup::run(std::function<void()> fn, TaskPriority priority) {
+    scheduler.spawn(std::move(fn), priority, this);
+}
+
+void TaskGroup::wait() {
+    int slotIndex = scheduler.currentSlot();
+    while (pending.load(std::memory_order_acquire) > 0) {
+        // Help out instead of blocking: this is what makes waiting inside a task safe.
+        if (!scheduler.tryRunOne(slotIndex)) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        std::swap(failure, error);
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
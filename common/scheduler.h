@@ -0,0 +1,163 @@
+// A small work-stealing task scheduler shared by all the generators.
+//
+// Every worker thread owns a deque of tasks per priority level. A worker pushes and pops
+// its own tasks at the back (LIFO, so freshly split work stays hot in its cache) and, when
+// it runs dry, steals from the front of other workers' deques (FIFO, so thieves take the
+// oldest and usually largest pieces of work). Threads that are not workers (e.g. main)
+// share one extra slot and help execute tasks while they wait for a TaskGroup.
+//
+// On top of that sit two building blocks:
+//   TaskGroup     - fork/join: run() tasks, then wait() for all of them.
+//   parallel_for  - splits an index range recursively until pieces are at most 'grain' long.
+
+#pragma once
+
+#include <atomic>     // For task counters and worker statistics
+#include <condition_variable> // For putting idle workers to sleep
+#include <cstdint>    // For fixed-width statistic counters
+#include <deque>      // For the per-worker task queues
+#include <exception>  // For carrying task exceptions back to wait()
+#include <functional> // For std::function task bodies
+#include <memory>     // For std::unique_ptr worker slots
+#include <mutex>      // For protecting queues
+#include <thread>     // For worker threads
+#include <vector>     // For slots and statistics
+
+// Tasks of a higher priority are always taken before lower-priority ones, both from a
+// worker's own queue and when stealing.
+enum class TaskPriority {
+    High = 0,   // Work someone is waiting on right now (e.g. visible tiles).
+    Normal = 1, // The default.
+    Low = 2,    // Background work (prefetching, speculative rendering).
+};
+
+class TaskGroup;
+
+class Scheduler {
+public:
+    static constexpr int NUM_PRIORITIES = 3;
+
+    // Per-slot counters, used by the scheduler benchmark to judge load balance.
+    // Slot 0 is shared by all non-worker threads; slots 1..N are the worker threads.
+    struct SlotStats {
+        std::uint64_t executed; // Tasks run by this slot.
+        std::uint64_t stolen;   // Of those, how many were taken from another slot's queue.
+    };
+
+    // numThreads is the total number of threads doing work, including the thread that
+    // waits on a TaskGroup. 0 means "one per hardware thread".
+    explicit Scheduler(unsigned numThreads = 0);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // The process-wide scheduler used by the programs and by parallel_for.
+    static Scheduler& instance();
+
+    // Number of threads that can execute tasks at once (workers + one waiting thread).
+    unsigned concurrency() const { return static_cast<unsigned>(slots.size()); }
+
+    // Queues a task. If 'group' is given, the group's wait() will not return before it ran.
+    void spawn(std::function<void()> fn, TaskPriority priority = TaskPriority::Normal,
+               TaskGroup* group = nullptr);
+
+    std::vector<SlotStats> stats() const;
+    void resetStats();
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    // One slot per worker thread (plus the shared slot 0). Each has a deque per priority.
+    struct Slot {
+        std::mutex mutex;
+        std::deque<Task> queues[NUM_PRIORITIES];
+        std::atomic<int> sizes[NUM_PRIORITIES] = {}; // Lets thieves skip empty queues without locking.
+        std::atomic<std::uint64_t> executed{0};
+        std::atomic<std::uint64_t> stolen{0};
+    };
+
+    // Runs one queued task if there is any; returns false if every queue was empty.
+    bool tryRunOne(int slotIndex);
+    bool popOwn(Slot& slot, int priority, Task& task);
+    bool steal(int thiefIndex, int priority, Task& task);
+    void execute(int slotIndex, Task& task);
+    void workerLoop(int slotIndex);
+    int currentSlot() const;
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<std::thread> threads;
+
+    std::atomic<int> queued{0};        // Tasks sitting in any queue.
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+};
+
+// Fork/join: tasks started with run() may themselves run() more tasks into the same group.
+// wait() executes queued tasks on the calling thread until the whole group has finished,
+// so it is safe to wait from inside a task. The first exception thrown by a task is
+// rethrown from wait().
+class TaskGroup {
+public:
+    explicit TaskGroup(Scheduler& scheduler = Scheduler::instance()) : scheduler(scheduler) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> fn, TaskPriority priority = TaskPriority::Normal);
+    void wait();
+
+    Scheduler& owner() const { return scheduler; }
+
+private:
+    friend class Scheduler;
+
+    Scheduler& scheduler;
+    std::atomic<int> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+namespace detail {
+
+template <typename Fn>
+void parallel_for_split(TaskGroup& group, int begin, int end, int grain, const Fn& fn,
+                        TaskPriority priority) {
+    // Hand the upper half to the scheduler and keep splitting the lower half ourselves,
+    // so a thief always gets the largest remaining chunk.
+    while (end - begin > grain) {
+        int mid = begin + (end - begin) / 2;
+        group.run([&group, mid, end, grain, &fn, priority] {
+            parallel_for_split(group, mid, end, grain, fn, priority);
+        }, priority);
+        end = mid;
+    }
+    fn(begin, end);
+}
+
+} // namespace detail
+
+// Calls fn(chunkBegin, chunkEnd) for disjoint chunks covering [begin, end), in parallel.
+// Chunks are at most 'grain' long; grain <= 0 picks one that gives every thread ~8 chunks.
+template <typename Fn>
+void parallel_for(int begin, int end, int grain, const Fn& fn,
+                  TaskPriority priority = TaskPriority::Normal,
+                  Scheduler& scheduler = Scheduler::instance()) {
+    if (end <= begin) {
+        return;
+    }
+    if (grain <= 0) {
+        int chunks = static_cast<int>(scheduler.concurrency()) * 8;
+        grain = (end - begin + chunks - 1) / chunks;
+    }
+    TaskGroup group(scheduler);
+    detail::parallel_for_split(group, begin, end, grain, fn, priority);
+    group.wait();
+}
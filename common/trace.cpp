@@ -0,0 +1,218 @@
+#include "common/trace.h"
+
+#include <algorithm> // For std::min
+#include <cstdio>    // For writing the JSON file
+#include <cstdlib>   // For std::getenv
+#include <iostream>  // For status messages
+#include <memory>    // For std::unique_ptr thread buffers
+#include <mutex>     // For the buffer registry
+#include <vector>    // For ring buffers
+
+namespace trace {
+
+namespace detail {
+std::atomic<bool> active{false};
+} // namespace detail
+
+namespace {
+
+// Events per thread before the oldest ones are overwritten. Must be a power of two.
+const std::uint64_t RING_CAPACITY = 1u << 16;
+
+enum class EventKind : std::uint8_t { Scope, Counter };
+
+struct Event {
+    const char* name;
+    std::int64_t timeNs;     // Start of a scope, or time of a counter sample.
+    std::int64_t durationNs; // Scopes only.
+    double value;            // Counters only.
+    EventKind kind;
+};
+
+// One per thread that ever recorded an event. Only its owner thread writes to it;
+// 'written' is published with release order so an exporter sees complete events.
+struct ThreadBuffer {
+    int tid = 0;
+    std::string name;
+    std::vector<Event> ring = std::vector<Event>(RING_CAPACITY);
+    std::atomic<std::uint64_t> written{0};
+};
+
+// Buffers are never freed, so events of threads that have already exited still get exported.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local ThreadBuffer* tlsBuffer = nullptr;
+thread_local std::string tlsThreadName; // Applied when (if ever) the thread records its first event.
+
+ThreadBuffer& threadBuffer() {
+    if (!tlsBuffer) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.push_back(std::make_unique<ThreadBuffer>());
+        tlsBuffer = r.buffers.back().get();
+        tlsBuffer->tid = static_cast<int>(r.buffers.size());
+        tlsBuffer->name = tlsThreadName;
+    }
+    return *tlsBuffer;
+}
+
+void push(const Event& event) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::uint64_t n = buffer.written.load(std::memory_order_relaxed);
+    buffer.ring[n & (RING_CAPACITY - 1)] = event;
+    buffer.written.store(n + 1, std::memory_order_release);
+}
+
+// Trace names are usually plain literals, but keep the JSON valid whatever they contain.
+void writeJsonString(std::FILE* file, const char* text) {
+    std::fputc('"', file);
+    for (const char* p = text; *p; ++p) {
+        unsigned char ch = static_cast<unsigned char>(*p);
+        if (ch == '"' || ch == '\\') {
+            std::fputc('\\', file);
+            std::fputc(ch, file);
+        } else if (ch < 0x20) {
+            std::fprintf(file, "\\u%04x", ch);
+        } else {
+            std::fputc(ch, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+namespace detail {
+
+void recordScope(const char* name, std::int64_t startNs, std::int64_t endNs) {
+    push(Event{name, startNs, endNs - startNs, 0.0, EventKind::Scope});
+}
+
+void recordCounter(const char* name, std::int64_t timeNs, double value) {
+    push(Event{name, timeNs, 0, value, EventKind::Counter});
+}
+
+} // namespace detail
+
+void start() { detail::active.store(true, std::memory_order_relaxed); }
+
+void stop() { detail::active.store(false, std::memory_order_relaxed); }
+
+void clear() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& buffer : r.buffers) {
+        buffer->written.store(0, std::memory_order_relaxed);
+    }
+}
+
+void setThreadName(const std::string& name) {
+    // Threads that never record anything shouldn't pay for a ring buffer just to be named.
+    tlsThreadName = name;
+    if (tlsBuffer) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        tlsBuffer->name = name;
+    }
+}
+
+bool writeChromeJson(const std::string& filename) {
+    std::FILE* file = std::fopen(filename.c_str(), "w");
+    if (!file) {
+        std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
+        return false;
+    }
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // Timestamps are written relative to the earliest event, in microseconds.
+    std::int64_t originNs = INT64_MAX;
+    for (const auto& buffer : r.buffers) {
+        std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+        std::uint64_t count = std::min(written, RING_CAPACITY);
+        for (std::uint64_t i = written - count; i < written; ++i) {
+            originNs = std::min(originNs, buffer->ring[i & (RING_CAPACITY - 1)].timeNs);
+        }
+    }
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    bool first = true;
+    auto separator = [&] {
+        std::fputs(first ? "" : ",\n", file);
+        first = false;
+    };
+
+    for (const auto& buffer : r.buffers) {
+        if (!buffer->name.empty()) {
+            separator();
+            std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->tid);
+            writeJsonString(file, buffer->name.c_str());
+            std::fputs("}}", file);
+        }
+
+        std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+        std::uint64_t count = std::min(written, RING_CAPACITY);
+        for (std::uint64_t i = written - count; i < written; ++i) {
+            const Event& event = buffer->ring[i & (RING_CAPACITY - 1)];
+            separator();
+            std::fputs("{\"name\":", file);
+            writeJsonString(file, event.name);
+            double ts = (event.timeNs - originNs) / 1000.0;
+            if (event.kind == EventKind::Scope) {
+                std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                             buffer->tid, ts, event.durationNs / 1000.0);
+            } else {
+                std::fprintf(file, ",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%.17g}}",
+                             buffer->tid, ts, event.value);
+            }
+        }
+    }
+    std::fputs("\n]}\n", file);
+
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Error: Could not write " << filename << std::endl;
+    }
+    return ok;
+}
+
+// --- Session ---
+
+std::string fileFromEnvironment() {
+    const char* value = std::getenv("DP_TRACE");
+    return value ? value : "";
+}
+
+Session::Session() : Session(fileFromEnvironment()) {}
+
+Session::Session(std::string filename) : filename(std::move(filename)) {
+    if (!this->filename.empty()) {
+#if !DP_TRACING
+        std::cerr << "Warning: tracing was disabled at build time (DP_TRACING=OFF); "
+                  << this->filename << " will be empty." << std::endl;
+#endif
+        setThreadName("main");
+        start();
+    }
+}
+
+Session::~Session() {
+    if (filename.empty()) {
+        return;
+    }
+    stop();
+    if (writeChromeJson(filename)) {
+        std::cerr << "Trace written to " << filename << std::endl;
+    }
+}
+
+} // namespace trace
@@ -0,0 +1,118 @@
+// Lightweight tracing: scoped timers and counters, exported as Chrome trace JSON
+// (open the file in chrome://tracing or https://ui.perfetto.dev to see a timeline).
+//
+//   void renderTile(...) {
+//       DP_TRACE_SCOPE("julia tile");        // Records start time and duration of this scope.
+//       ...
+//       DP_TRACE_COUNTER("tiles done", n);   // Records a value over time.
+//   }
+//
+// Cost model:
+//   - Built with DP_TRACING=0 (cmake -DDP_TRACING=OFF) the macros expand to nothing.
+//   - Compiled in but not started: one relaxed atomic load and a branch per scope.
+//   - Started: two clock reads and one store into the calling thread's own ring buffer.
+//     No locks and no allocation after a thread's first event. When a ring buffer is full the
+//     oldest events are overwritten, so a long run keeps its most recent history.
+//
+// Names must be string literals (or otherwise outlive the trace): only the pointer is stored.
+// The easiest way to use it from a program is a Session at the top of main().
+
+#pragma once
+
+#include <atomic>  // For the global on/off switch
+#include <chrono>  // For timestamps
+#include <cstdint> // For fixed-width event fields
+#include <string>  // For file names
+
+#ifndef DP_TRACING
+#define DP_TRACING 1
+#endif
+
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> active;
+
+inline std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void recordScope(const char* name, std::int64_t startNs, std::int64_t endNs);
+void recordCounter(const char* name, std::int64_t timeNs, double value);
+} // namespace detail
+
+inline bool enabled() { return detail::active.load(std::memory_order_relaxed); }
+
+// Starts or stops recording. Events recorded so far are kept until clear().
+void start();
+void stop();
+void clear();
+
+// Names the calling thread in the exported timeline (e.g. "worker 3"). Cheap: nothing is
+// allocated until the thread records its first event.
+void setThreadName(const std::string& name);
+
+// Writes every recorded event as Chrome trace JSON. Call it once the traced work has
+// finished; events still being recorded by other threads may or may not be included.
+bool writeChromeJson(const std::string& filename);
+
+// Times the enclosing scope. Use through DP_TRACE_SCOPE.
+class Scope {
+public:
+    explicit Scope(const char* name) : name(enabled() ? name : nullptr) {
+        if (this->name) {
+            startNs = detail::nowNs();
+        }
+    }
+    ~Scope() {
+        if (name) {
+            detail::recordScope(name, startNs, detail::nowNs());
+        }
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    std::int64_t startNs = 0;
+};
+
+inline void counter(const char* name, double value) {
+    if (enabled()) {
+        detail::recordCounter(name, detail::nowNs(), value);
+    }
+}
+
+// The value of the DP_TRACE environment variable, or "" if it isn't set. Programs with a
+// --trace option use it as that option's default.
+std::string fileFromEnvironment();
+
+// Starts tracing when constructed with a non-empty file name and writes the trace there
+// when destroyed. The default constructor takes the file name from the DP_TRACE
+// environment variable, so any program can be traced without changing how it's run:
+//   DP_TRACE=julia.json ./julia_fractal
+class Session {
+public:
+    Session();
+    explicit Session(std::string filename);
+    ~Session();
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+private:
+    std::string filename;
+};
+
+} // namespace trace
+
+#define DP_TRACE_CONCAT_INNER(a, b) a##b
+#define DP_TRACE_CONCAT(a, b) DP_TRACE_CONCAT_INNER(a, b)
+
+#if DP_TRACING
+#define DP_TRACE_SCOPE(name) ::trace::Scope DP_TRACE_CONCAT(dpTraceScope, __LINE__)(name)
+#define DP_TRACE_COUNTER(name, value) ::trace::counter((name), static_cast<double>(value))
+#else
+#define DP_TRACE_SCOPE(name) static_cast<void>(0)
+#define DP_TRACE_COUNTER(name, value) static_cast<void>(0)
+#endif
@@ -6,79 +6,114 @@
 #include <vector>
 #include <cmath> // For std::sin and std::cos
 #include <random> // For random number generation
+#include <string> // For the output file name
 
-// Define the dimensions of our texture
-const int TEXTURE_WIDTH = 128;
-const int TEXTURE_HEIGHT = 128;
+#include "common/image.h"       // The shared grayscale/RGB image buffer
+#include "common/image_codec.h" // For saving the texture as PNG/QOI/PPM
+#include "common/options.h"     // For --width/--height/... on the command line
+#include "common/scheduler.h"   // For parallel_for across rows
+#include "common/trace.h"       // For timing the generation (run with --trace=texture.json)
 
-// Structure to represent a pixel's color (grayscale in this case)
-struct Pixel {
-    unsigned char intensity; // 0 (black) to 255 (white)
-};
+// The dimensions of our texture. These are the defaults; run with --width/--height to change them.
+const int DEFAULT_TEXTURE_WIDTH = 128;
+const int DEFAULT_TEXTURE_HEIGHT = 128;
 
-// Function to generate a single pixel's value based on its coordinates.
-// This function is the core of our procedural generation.
-// The 'offset' parameter is crucial for creating variations.
-Pixel generatePixel(int x, int y, float offset) {
-    Pixel p;
-
-    // We'll use a combination of sine and cosine waves to create a smooth,
-    // repeating pattern. The input to sin/cos will be a combination of the
-    // pixel coordinates (x, y) and the offset.
-    // Multiplying by a frequency value (e.g., 0.05f) controls how many
-    // waves appear across the texture.
-    float value = std::sin(x * 0.05f + offset) * std::cos(y * 0.05f - offset);
+// Each pixel is a single grayscale intensity: 0 (black) to 255 (white).
+// The texture is stored in the shared Image type from common/image.h with one channel,
+// so it can be written straight to an image file.
 
+// Maps a wave value in [-1, 1] to a pixel intensity.
+inline unsigned char toIntensity(float value) {
     // The 'value' will range from -1.0 to 1.0. We need to map this to
     // our 0-255 intensity range.
     // First, shift it to 0.0 to 2.0 by adding 1.0.
     // Then, scale it to 0.0 to 255.0 by multiplying by 127.5 (half of 255).
-    p.intensity = static_cast<unsigned char>((value + 1.0f) * 127.5f);
+    return static_cast<unsigned char>((value + 1.0f) * 127.5f);
+}
 
-    return p;
+// Generates rows [rowBegin, rowEnd) of the texture. This is the core of our procedural generation.
+//
+// We'll use a combination of sine and cosine waves to create a smooth,
+// repeating pattern: value = sin(x * 0.05 + offset) * cos(y * 0.05 - offset).
+// Multiplying by a frequency value (e.g., 0.05f) controls how many
+// waves appear across the texture. The 'offset' parameter is crucial for creating variations.
+//
+// The sine only depends on x, so it is computed once per column instead of once per pixel,
+// and each pixel becomes a single multiplication.
+void generateRows(const ImageView& texture, int rowBegin, int rowEnd, float offset) {
+    const int width = texture.width;
+    std::vector<float> sines(width);
+    for (int x = 0; x < width; ++x) {
+        sines[x] = std::sin(x * 0.05f + offset);
+    }
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        float cosine = std::cos(y * 0.05f - offset);
+        unsigned char* row = texture.row(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = toIntensity(sines[x] * cosine);
+        }
+    }
 }
 
 // Function to generate the entire texture.
-// It iterates through each pixel and calls generatePixel.
-std::vector<Pixel> generateTexture() {
-    std::vector<Pixel> texture;
-    texture.reserve(TEXTURE_WIDTH * TEXTURE_HEIGHT); // Pre-allocate memory for efficiency
+// Rows don't depend on each other, so they are generated in parallel on the shared scheduler.
+Image generateTexture(int width, int height, unsigned int seed) {
+    DP_TRACE_SCOPE("texture generation");
+    Image texture(width, height, 1); // One channel (gray). Every pixel is allocated up front so rows can be filled independently.
 
     // We use a random offset to make each generated texture unique.
-    // For truly repeatable generation, you would seed the random number generator
-    // with a fixed value.
-    std::random_device rd;
-    std::mt19937 gen(rd()); // Mersenne Twister engine for good randomness
+    // For truly repeatable generation, pass a fixed --seed.
+    std::mt19937 gen(seed); // Mersenne Twister engine for good randomness
     std::uniform_real_distribution<float> dist(0.0f, 100.0f); // Range for the offset
     float offset = dist(gen);
 
-    for (int y = 0; y < TEXTURE_HEIGHT; ++y) {
-        for (int x = 0; x < TEXTURE_WIDTH; ++x) {
-            // Call generatePixel for each coordinate.
-            // The offset is passed to ensure a consistent pattern across the texture,
-            // but a different offset means a different pattern.
-            texture.push_back(generatePixel(x, y, offset));
-        }
-    }
+    // parallel_for hands out chunks of rows (at most 16 rows each) to the worker threads.
+    ImageView pixels = texture.view();
+    parallel_for(0, height, 16, [&](int rowBegin, int rowEnd) {
+        DP_TRACE_SCOPE("texture rows");
+        generateRows(pixels, rowBegin, rowEnd, offset);
+    });
 
     return texture;
 }
 
 // --- Example Usage ---
-int main() {
-    std::cout << "Generating a " << TEXTURE_WIDTH << "x" << TEXTURE_HEIGHT << " texture...\n";
+int main(int argc, char** argv) {
+    int width = DEFAULT_TEXTURE_WIDTH;
+    int height = DEFAULT_TEXTURE_HEIGHT;
+    int seed = -1;
+    std::string output = "texture.png";
+    std::string traceFile = trace::fileFromEnvironment();
+
+    Options options("texture_generator", "Generates a tileable grayscale wave texture.");
+    options.add("width", width, "Texture width in pixels", 1, 65536);
+    options.add("height", height, "Texture height in pixels", 1, 65536);
+    options.add("seed", seed, "Random seed for the pattern offset (-1: different every run)", -1);
+    options.add("output", output, "Output image (.png, .qoi or .ppm)");
+    options.add("trace", traceFile, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(traceFile);
+
+    std::cout << "Generating a " << width << "x" << height << " texture...\n";
 
-    std::vector<Pixel> myTexture = generateTexture();
+    unsigned int actualSeed = seed >= 0 ? static_cast<unsigned int>(seed) : std::random_device{}();
+    Image myTexture = generateTexture(width, height, actualSeed);
 
     std::cout << "Texture generated. First 10 pixels (intensity):\n";
-    for (int i = 0; i < 10 && i < myTexture.size(); ++i) {
-        std::cout << static_cast<int>(myTexture[i].intensity) << " ";
+    for (int i = 0; i < 10 && i < myTexture.width(); ++i) {
+        std::cout << static_cast<int>(myTexture.data()[i]) << " ";
     }
     std::cout << "\n";
 
-    // In a real application, you would now save this 'myTexture' data to an image file
-    // (e.g., BMP, PNG) or use it directly in a graphics API.
-    // For demonstration, we just print a few pixel values.
+    // Save the texture so it can be viewed (or loaded by a graphics API).
+    // The format follows the extension: .png, .qoi (fastest compressed) or .ppm (uncompressed).
+    // writeImage() prints the reason if it fails; the program then exits with 1.
+    if (!writeImage(myTexture.view(), output)) {
+        return 1;
+    }
+    std::cout << "Texture saved to " << output << "\n";
 
     return 0;
-}
\ No newline at end of file
+}
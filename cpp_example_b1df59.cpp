@@ -8,34 +8,41 @@
 #include <random>   // For generating random numbers, crucial for random walks
 #include <cmath>    // For mathematical functions like sin, cos (though not strictly needed here, good practice)
 #include <fstream>  // To write the output to a file (e.g., an SVG file)
+#include <string>   // For output file names
+
+#include "common/image.h"       // The shared image buffer, for a raster version of the art
+#include "common/image_codec.h" // To save that raster version as PNG/QOI/PPM
+#include "common/options.h"     // To change the configuration from the command line
+#include "common/scheduler.h"   // To run the independent random walks in parallel
+#include "common/trace.h"       // To time each stage (run with --trace=art.json)
 
 // --- Configuration ---
-const int IMAGE_WIDTH = 800;  // The width of our generated artwork in pixels.
-const int IMAGE_HEIGHT = 600; // The height of our generated artwork in pixels.
-const int NUM_WALKS = 50;     // The number of independent random walks to perform.
-const int STEPS_PER_WALK = 200; // How many steps each random walk will take.
-const int MIN_LINE_THICKNESS = 1; // Minimum thickness for lines.
-const int MAX_LINE_THICKNESS = 5; // Maximum thickness for lines.
-const int MIN_RADIUS = 5;     // Minimum radius for circles.
-const int MAX_RADIUS = 20;    // Maximum radius for circles.
+// The defaults below can all be changed at run time, e.g. --walks=200 (see --help).
+struct ArtConfig {
+    int image_width = 800;      // The width of our generated artwork in pixels.
+    int image_height = 600;     // The height of our generated artwork in pixels.
+    int num_walks = 50;         // The number of independent random walks to perform.
+    int steps_per_walk = 200;   // How many steps each random walk will take.
+    int min_line_thickness = 1; // Minimum thickness for lines.
+    int max_line_thickness = 5; // Maximum thickness for lines.
+    int min_radius = 5;         // Minimum radius for circles.
+    int max_radius = 20;        // Maximum radius for circles.
+};
 
 // --- Helper Functions ---
 
+// Every random walk gets its own random number engine (see main), so walks can run
+// on different threads without sharing - and fighting over - one generator.
+
 // Generates a random integer within a specified range [min, max]
-int randomInt(int min, int max) {
-    // This uses a Mersenne Twister engine, a high-quality random number generator.
-    // static ensures that the engine and distribution are created only once,
-    // making it efficient and ensuring better randomness across calls.
-    static std::random_device rd; // Seed from a hardware entropy source if available.
-    static std::mt19937 gen(rd()); // Mersenne Twister engine initialized with the seed.
+int randomInt(std::mt19937& gen, int min, int max) {
+    // 'gen' is a Mersenne Twister engine, a high-quality random number generator.
     std::uniform_int_distribution<> distrib(min, max); // Distribution that produces integers uniformly.
     return distrib(gen); // Generate and return a random number.
 }
 
 // Generates a random floating-point number within a specified range [min, max]
-float randomFloat(float min, float max) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
+float randomFloat(std::mt19937& gen, float min, float max) {
     std::uniform_real_distribution<> distrib(min, max); // Distribution for floating-point numbers.
     return distrib(gen);
 }
@@ -81,37 +88,40 @@ struct ArtElement {
 
 // This function performs a single random walk and generates a series of points.
 // The points are then used to create drawing elements (lines or circles).
-std::vector<ArtElement> generateRandomWalk(Point start_point) {
+// All randomness comes from 'gen', the walk's own random number engine.
+std::vector<ArtElement> generateRandomWalk(const ArtConfig& config, Point start_point, std::mt19937& gen) {
+    DP_TRACE_SCOPE("random walk");
     std::vector<ArtElement> elements; // To store the shapes generated by this walk.
+    elements.reserve(config.steps_per_walk); // Every step adds exactly one shape.
     Point current_pos = start_point; // The current position of our "walker".
 
     // For each step in the walk:
-    for (int i = 0; i < STEPS_PER_WALK; ++i) {
+    for (int i = 0; i < config.steps_per_walk; ++i) {
         // Determine the next random movement.
         // dx and dy represent the change in x and y coordinates.
-        int dx = randomInt(-5, 5); // Move horizontally by -5 to +5 pixels.
-        int dy = randomInt(-5, 5); // Move vertically by -5 to +5 pixels.
+        int dx = randomInt(gen, -5, 5); // Move horizontally by -5 to +5 pixels.
+        int dy = randomInt(gen, -5, 5); // Move vertically by -5 to +5 pixels.
 
         Point next_pos = {current_pos.x + dx, current_pos.y + dy}; // Calculate the next position.
 
         // --- Boundary Checking ---
         // Ensure the walker stays within the image boundaries.
         // This prevents drawing outside our canvas.
-        next_pos.x = std::max(0, std::min(IMAGE_WIDTH - 1, next_pos.x));
-        next_pos.y = std::max(0, std::min(IMAGE_HEIGHT - 1, next_pos.y));
+        next_pos.x = std::max(0, std::min(config.image_width - 1, next_pos.x));
+        next_pos.y = std::max(0, std::min(config.image_height - 1, next_pos.y));
 
         // --- Decide what to draw: Line or Circle? ---
         // We'll randomly choose between drawing a line or a circle at this step.
-        if (randomInt(0, 1) == 0) { // 50% chance of drawing a line
+        if (randomInt(gen, 0, 1) == 0) { // 50% chance of drawing a line
             Line segment;
             segment.start = current_pos; // The line starts from the current position.
             segment.end = next_pos;      // The line ends at the newly calculated position.
-            segment.thickness = randomInt(MIN_LINE_THICKNESS, MAX_LINE_THICKNESS); // Random thickness.
+            segment.thickness = randomInt(gen, config.min_line_thickness, config.max_line_thickness); // Random thickness.
             elements.push_back({ShapeType::LINE, segment, {}}); // Add the line to our list of elements.
         } else { // 50% chance of drawing a circle
             Circle dot;
             dot.center = next_pos; // The circle is centered at the new position.
-            dot.radius = randomInt(MIN_RADIUS, MAX_RADIUS); // Random radius.
+            dot.radius = randomInt(gen, config.min_radius, config.max_radius); // Random radius.
             elements.push_back({ShapeType::CIRCLE, {}, dot}); // Add the circle to our list of elements.
         }
 
@@ -124,17 +134,19 @@ std::vector<ArtElement> generateRandomWalk(Point start_point) {
 // SVG (Scalable Vector Graphics) is a great format for web-based and scalable vector art.
 // It's also human-readable, making it easy to understand how the art is represented.
 
-void saveAsSVG(const std::vector<ArtElement>& all_elements, const std::string& filename) {
+// Returns false (after printing an error) if the file can't be written.
+bool saveAsSVG(const ArtConfig& config, const std::vector<ArtElement>& all_elements, const std::string& filename) {
+    DP_TRACE_SCOPE("svg serialization");
     std::ofstream svg_file(filename); // Open the file for writing.
 
     if (!svg_file.is_open()) {
         std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
-        return;
+        return false;
     }
 
     // --- SVG Header ---
     // This defines the SVG canvas size and other properties.
-    svg_file << "<svg width=\"" << IMAGE_WIDTH << "\" height=\"" << IMAGE_HEIGHT << "\" xmlns=\"http://www.w3.org/2000/svg\">\n";
+    svg_file << "<svg width=\"" << config.image_width << "\" height=\"" << config.image_height << "\" xmlns=\"http://www.w3.org/2000/svg\">\n";
 
     // --- Background ---
     // A simple white background. You could add gradients or other fills here.
@@ -161,45 +173,129 @@ void saveAsSVG(const std::vector<ArtElement>& all_elements, const std::string& f
 
     // --- SVG Footer ---
     svg_file << "</svg>\n";
-    svg_file.close(); // Close the file.
+    svg_file.close(); // Close the file (this flushes it, so a full disk shows up here).
+    if (!svg_file) {
+        std::cerr << "Error: Could not write file " << filename << "." << std::endl;
+        return false;
+    }
     std::cout << "Abstract art saved to " << filename << std::endl;
+    return true;
+}
+
+// --- Raster Output ---
+// The same elements, drawn into a pixel image with the shared rasterizer. Unlike SVG, the
+// result can be viewed anywhere and compared pixel by pixel between runs.
+
+// Returns false (after writeImage() has printed an error) if the image can't be written.
+bool saveAsImage(const ArtConfig& config, const std::vector<ArtElement>& all_elements, const std::string& filename) {
+    DP_TRACE_SCOPE("rasterize art");
+    Image image(config.image_width, config.image_height, 3); // RGB
+    ImageView canvas = image.view();
+    fillImage(canvas, Color{255, 255, 255}); // The same white background as the SVG.
+
+    const Color black = {0, 0, 0};
+    for (const auto& element : all_elements) {
+        if (element.type == ShapeType::LINE) {
+            const Line& line = element.line;
+            strokeLine(canvas, line.start.x, line.start.y, line.end.x, line.end.y, line.thickness, black);
+        } else if (element.type == ShapeType::CIRCLE) {
+            const Circle& circle = element.circle;
+            fillCircle(canvas, circle.center.x, circle.center.y, circle.radius, black);
+        }
+    }
+
+    if (!writeImage(canvas, filename)) {
+        return false;
+    }
+    std::cout << "Abstract art saved to " << filename << std::endl;
+    return true;
 }
 
 // --- Main Execution ---
 
-int main() {
+int main(int argc, char** argv) {
+    ArtConfig config;
+    int seed_option = -1;
+    std::string svg_output = "abstract_art.svg";
+    std::string image_output = "abstract_art.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("abstract_art", "Generates abstract art from random walks of lines and circles.");
+    options.add("width", config.image_width, "Canvas width in pixels", 1, 65536);
+    options.add("height", config.image_height, "Canvas height in pixels", 1, 65536);
+    options.add("walks", config.num_walks, "Number of independent random walks", 0);
+    options.add("steps", config.steps_per_walk, "Steps taken by each walk", 0);
+    options.add("min-thickness", config.min_line_thickness, "Minimum line thickness", 1);
+    options.add("max-thickness", config.max_line_thickness, "Maximum line thickness", 1);
+    options.add("min-radius", config.min_radius, "Minimum circle radius", 1);
+    options.add("max-radius", config.max_radius, "Maximum circle radius", 1);
+    options.add("seed", seed_option, "Random seed (-1: different art every run)", -1);
+    options.add("svg", svg_output, "SVG output file (empty: don't write one)");
+    options.add("output", image_output, "Raster output file, .png/.qoi/.ppm (empty: don't write one)");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    if (config.min_line_thickness > config.max_line_thickness || config.min_radius > config.max_radius) {
+        std::cerr << "Error: each minimum must not be larger than its maximum." << std::endl;
+        return 1;
+    }
+    trace::Session traceSession(trace_file);
+
     std::vector<ArtElement> all_art_elements; // A collection to hold all elements from all walks.
 
-    // Generate multiple random walks.
-    // Each walk starts from a random point within the image.
-    for (int i = 0; i < NUM_WALKS; ++i) {
-        Point start_point = {randomInt(0, IMAGE_WIDTH), randomInt(0, IMAGE_HEIGHT)}; // Pick a random starting point.
-        std::vector<ArtElement> walk_elements = generateRandomWalk(start_point); // Generate elements for this walk.
-        // Add the elements from this walk to our main collection.
+    // One seed for the whole picture; each walk derives its own engine from it.
+    // The same --seed always produces the same art, however many threads run the walks.
+    unsigned int seed = seed_option >= 0 ? static_cast<unsigned int>(seed_option) : std::random_device{}();
+
+    // Generate multiple random walks, in parallel on the shared scheduler.
+    // Each walk writes only to its own slot in 'walks', so no locking is needed.
+    std::vector<std::vector<ArtElement>> walks(config.num_walks);
+    parallel_for(0, config.num_walks, 1, [&](int walkBegin, int walkEnd) {
+        for (int i = walkBegin; i < walkEnd; ++i) {
+            std::seed_seq walk_seed{seed, static_cast<unsigned int>(i)};
+            std::mt19937 gen(walk_seed); // This walk's own random number engine.
+            // Each walk starts from a random point within the image.
+            Point start_point = {randomInt(gen, 0, config.image_width), randomInt(gen, 0, config.image_height)}; // Pick a random starting point.
+            walks[i] = generateRandomWalk(config, start_point, gen); // Generate elements for this walk.
+        }
+    });
+
+    // Add the elements from every walk to our main collection, in walk order.
+    for (const std::vector<ArtElement>& walk_elements : walks) {
         all_art_elements.insert(all_art_elements.end(), walk_elements.begin(), walk_elements.end());
     }
 
-    // Save the generated art to an SVG file.
-    saveAsSVG(all_art_elements, "abstract_art.svg");
+    // Save the generated art to an SVG file, and as a raster image.
+    // A failed write ends the program with exit code 1.
+    if (!svg_output.empty() && !saveAsSVG(config, all_art_elements, svg_output)) {
+        return 1;
+    }
+    if (!image_output.empty() && !saveAsImage(config, all_art_elements, image_output)) {
+        return 1;
+    }
 
     return 0; // Indicate successful execution.
 }
 
 // Example Usage:
-// Compile this code using a C++ compiler (like g++):
-// g++ -std=c++11 -o abstract_art abstract_art_tutorial.cpp
+// Build this program with the project's CMake build (see README.md):
+// cmake --preset release && cmake --build --preset release --target abstract_art
 //
 // Then run the executable:
-// ./abstract_art
+// ./build/release/abstract_art
 //
-// This will create a file named "abstract_art.svg" in the same directory.
-// You can open this SVG file in a web browser or an SVG editor to view your abstract art.
+// This will create files named "abstract_art.svg" and "abstract_art.png" in the same directory.
+// You can open the SVG file in a web browser or an SVG editor to view your abstract art,
+// and the PNG in any image viewer.
 //
-// Experiment by changing the constants at the top of the file:
-// - IMAGE_WIDTH, IMAGE_HEIGHT: Change the canvas size.
-// - NUM_WALKS: More walks will create a denser image.
-// - STEPS_PER_WALK: Longer walks create more connected or sprawling shapes.
-// - MIN/MAX values for thickness and radius: Affect the visual style.
+// Experiment by changing the configuration on the command line (./abstract_art --help lists it all),
+// or by putting "name = value" lines in a file and passing --config=FILE:
+// - --width, --height: Change the canvas size.
+// - --walks: More walks will create a denser image.
+// - --steps: Longer walks create more connected or sprawling shapes.
+// - --min-thickness/--max-thickness and --min-radius/--max-radius: Affect the visual style.
+// - --seed: Reproduce a piece you liked.
 //
 // You could also extend this by:
 // - Adding color generation (e.g., random RGB values).
@@ -8,169 +8,90 @@
 // We will focus on building the basic Quadtree structure and its `insert` and `query` methods.
 
 #include <iostream> // For console output
+#include <string>   // For the trace file name
 #include <vector>   // For storing collections of objects
-#include <array>    // For fixed-size array of child Quadtree nodes
-#include <memory>   // For std::unique_ptr to manage memory of child nodes
 
-// 1. Basic Structures: Define simple types for bounding boxes and game objects.
+#include "common/options.h" // For --capacity and the world size on the command line
 
-// Represents an axis-aligned bounding box (AABB).
-// Used for game object bounds and Quadtree node boundaries.
-struct Rect {
-    float x, y, width, height;
+// 1. Basic Structures and 2. The Quadtree Class live in the shared spatial library,
+// so the benchmarks and other programs can use the exact same code:
+//   spatial/geometry.h - Rect (an axis-aligned bounding box) and GameObject.
+//   spatial/quadtree.h - The Quadtree with its `subdivide`, `insert` and `query` methods.
+#include "spatial/quadtree.h"
+#include "spatial/hilbert.h"  // For reordering the object storage along a Hilbert curve
 
-    // Checks if this rectangle contains a point (px, py).
-    // Not directly used in this tutorial's core logic but useful for general Rect utility.
-    bool contains(float px, float py) const {
-        return px >= x && px <= x + width &&
-               py >= y && py <= y + height;
-    }
-
-    // Checks if this rectangle intersects with another rectangle.
-    // This is crucial for both object insertion and querying in the Quadtree.
-    bool intersects(const Rect& other) const {
-        return !(x + width < other.x ||
-                 y + height < other.y ||
-                 x > other.x + other.width ||
-                 y > other.y + other.height);
-    }
-};
-
-// Represents a simple game object with an ID and a bounding box.
-// In a real game, this would be a more complex class with rendering, physics, etc.
-struct GameObject {
-    int id;       // A unique identifier for the object
-    Rect bounds;  // The bounding box of the object
-
-    // Constructor to easily create GameObjects.
-    GameObject(int id, Rect bounds) : id(id), bounds(bounds) {}
-};
-
-// 2. The Quadtree Class: The core of our spatial partitioning system.
-
-class Quadtree {
-private:
-    Rect boundary;                       // The area this Quadtree node covers.
-    int capacity;                        // Max objects this node can hold before subdividing.
-    std::vector<GameObject*> objects;    // Objects stored directly in this node.
-
-    bool divided = false;                // True if this node has subdivided into children.
-    // An array of unique_pointers to child Quadtree nodes.
-    // std::unique_ptr ensures automatic memory management (children are deleted when parent is).
-    // children[0]: North-East, children[1]: North-West, children[2]: South-East, children[3]: South-West
-    std::array<std::unique_ptr<Quadtree>, 4> children; 
-
-public:
-    // Constructor: Initializes a Quadtree node with its boundary and object capacity.
-    Quadtree(Rect boundary, int capacity) : boundary(boundary), capacity(capacity) {}
-
-    // subdivide(): Splits this Quadtree node into four equal-sized children.
-    void subdivide() {
-        float subWidth = boundary.width / 2;
-        float subHeight = boundary.height / 2;
-        float x = boundary.x;
-        float y = boundary.y;
-
-        // Create and store the four new child Quadtree nodes using make_unique.
-        children[0] = std::make_unique<Quadtree>(Rect{x + subWidth, y, subWidth, subHeight}, capacity);      // North-East
-        children[1] = std::make_unique<Quadtree>(Rect{x, y, subWidth, subHeight}, capacity);                  // North-West
-        children[2] = std::make_unique<Quadtree>(Rect{x + subWidth, y + subHeight, subWidth, subHeight}, capacity); // South-East
-        children[3] = std::make_unique<Quadtree>(Rect{x, y + subHeight, subWidth, subHeight}, capacity);      // South-West
-
-        divided = true; // Mark this node as having children.
-    }
-
-    // insert(): Adds a GameObject to the Quadtree.
-    // Returns true if the object was successfully inserted into this branch, false otherwise.
-    bool insert(GameObject* obj) {
-        // 1. If the object's bounding box doesn't intersect this node's boundary, it cannot be stored here.
-        if (!boundary.intersects(obj->bounds)) {
-            return false;
-        }
-
-        // 2. If this node has space (below capacity) AND hasn't subdivided yet, add the object directly.
-        if (objects.size() < capacity && !divided) {
-            objects.push_back(obj);
-            return true;
-        }
-
-        // 3. If at capacity or already divided:
-        //    If not divided yet, subdivide this node first.
-        if (!divided) {
-            subdivide();
-        }
-
-        // 4. Try to insert the object into one of the child nodes.
-        //    We iterate through children and try to insert. If any child successfully takes the object, we're done.
-        for (int i = 0; i < 4; ++i) {
-            if (children[i]->insert(obj)) {
-                return true; // Object was fully contained and inserted into a child.
-            }
-        }
-        
-        // 5. If the object's bounds intersect this node's boundary but do not fit *entirely* within any single child
-        //    (e.g., the object spans across multiple quadrants), it stays in this (parent) node's object list.
-        //    This is crucial for objects that cannot be fully contained by a single child node after subdivision.
-        objects.push_back(obj); 
-        return true;
-    }
-
-    // query(): Finds all objects in the Quadtree that intersect with a given 'range' (Rect).
-    // Stores the found objects in the 'found' vector.
-    void query(const Rect& range, std::vector<GameObject*>& found) {
-        // 1. If the query range does not intersect this node's boundary, no objects here can match.
-        if (!boundary.intersects(range)) {
-            return;
-        }
-
-        // 2. Add objects directly stored in *this* node that intersect the query range.
-        for (GameObject* obj : objects) {
-            if (range.intersects(obj->bounds)) {
-                found.push_back(obj);
-            }
-        }
-
-        // 3. If this node has children, recursively query them as well.
-        if (divided) {
-            for (int i = 0; i < 4; ++i) {
-                children[i]->query(range, found);
-            }
-        }
-    }
-};
+// DP_TRACE_SCOPE marks the stages we want to see on a timeline; run with
+// --trace=quadtree.json to record one (see common/trace.h).
+#include "common/trace.h"
 
 // 3. Example Usage: Demonstrating how to use the Quadtree.
 
-int main() {
+int main(int argc, char** argv) {
     // Define the overall game world boundary (e.g., a 800x600 pixel game screen).
-    Rect worldBoundary = {0, 0, 800, 600};
+    double worldWidth = 800;
+    double worldHeight = 600;
     int capacity = 4; // Each Quadtree node can hold up to 4 objects before it tries to subdivide.
+    std::string traceFile = trace::fileFromEnvironment();
+
+    // All of these can be changed at run time, e.g. --capacity=1 to watch the tree subdivide more.
+    Options options("quadtree_demo", "Builds a Quadtree over a few game objects and runs range queries.");
+    options.add("world-width", worldWidth, "Width of the game world", 1.0);
+    options.add("world-height", worldHeight, "Height of the game world", 1.0);
+    options.add("capacity", capacity, "Objects a node holds before it subdivides", 1);
+    options.add("trace", traceFile, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(traceFile);
+
+    Rect worldBoundary = {0, 0, static_cast<float>(worldWidth), static_cast<float>(worldHeight)};
 
     // Create the main Quadtree for the entire game world.
     Quadtree quadtree(worldBoundary, capacity);
     std::cout << "Quadtree initialized for world (" << worldBoundary.width << "x" << worldBoundary.height << ") with node capacity " << capacity << ".\n\n";
 
-    // Create some example game objects. Note: Using stack-allocated objects here.
-    // If dynamically allocated, you'd manage their memory.
-    GameObject obj1(1, {10, 10, 20, 20});
-    GameObject obj2(2, {700, 50, 30, 30});
-    GameObject obj3(3, {50, 500, 40, 40});
-    GameObject obj4(4, {300, 250, 50, 50});
-    GameObject obj5(5, {320, 270, 10, 10}); // Close to obj4
-    GameObject obj6(6, {150, 150, 60, 60}); // Larger object, might span quadrants
-    GameObject obj7(7, {380, 290, 20, 20}); // Near center, potentially spans
-    GameObject obj8(8, {750, 550, 10, 10}); // Far corner
+    // Create some example game objects. They live in one std::vector (not as separate stack
+    // variables), so they sit next to each other in memory and can be reordered later.
+    // The tree only stores pointers, so the vector must not grow (reallocate) after inserting.
+    std::vector<GameObject> objects = {
+        GameObject(1, {10, 10, 20, 20}),
+        GameObject(2, {700, 50, 30, 30}),
+        GameObject(3, {50, 500, 40, 40}),
+        GameObject(4, {300, 250, 50, 50}),
+        GameObject(5, {320, 270, 10, 10}), // Close to obj4
+        GameObject(6, {150, 150, 60, 60}), // Larger object, might span quadrants
+        GameObject(7, {380, 290, 20, 20}), // Near center, potentially spans
+        GameObject(8, {750, 550, 10, 10}), // Far corner
+        GameObject(9, {1000, 700, 20, 20}), // Wandered off the world: the tree grows to keep it
+    };
 
     std::cout << "Inserting objects into the Quadtree...\n";
-    quadtree.insert(&obj1);
-    quadtree.insert(&obj2);
-    quadtree.insert(&obj3);
-    quadtree.insert(&obj4);
-    quadtree.insert(&obj5);
-    quadtree.insert(&obj6);
-    quadtree.insert(&obj7);
-    quadtree.insert(&obj8);
-    std::cout << "All objects inserted.\n\n";
+    {
+        DP_TRACE_SCOPE("quadtree build");
+        for (GameObject& obj : objects) {
+            quadtree.insert(&obj);
+        }
+    }
+    std::cout << "All objects inserted.\n";
+    // insert() never drops an object that is outside the world: the root grows toward it by adding
+    // a level above itself (the old tree becomes one quadrant of the new root), doubling in size.
+    const Rect& treeBounds = quadtree.bounds();
+    std::cout << "The tree now covers (" << treeBounds.x << "," << treeBounds.y << ") size "
+              << treeBounds.width << "x" << treeBounds.height << ".\n\n";
+
+    // Objects near each other in the world should also be near each other in memory, so the loop
+    // over a query's results reads neighbouring objects instead of jumping around. Sorting the
+    // storage along a Hilbert curve does that; remap() then points the tree at the new slots.
+    {
+        DP_TRACE_SCOPE("hilbert reorder");
+        std::vector<int> oldToNew = reorderAlongHilbert(objects, worldBoundary);
+        quadtree.remap(objects.data(), oldToNew);
+    }
+    std::cout << "Storage order along the Hilbert curve (IDs): ";
+    for (const GameObject& obj : objects) {
+        std::cout << obj.id << " ";
+    }
+    std::cout << "\n\n";
 
     // Define a 'query range' – this could be a player's attack radius, a camera's view, etc.
     Rect queryRange = {280, 200, 100, 100}; // A 100x100 area around (280, 200)
@@ -178,7 +99,11 @@ int main() {
               << queryRange.x << "," << queryRange.y << "," << queryRange.width << "," << queryRange.height << ")\n";
 
     std::vector<GameObject*> potentialColliders;
-    quadtree.query(queryRange, potentialColliders); // Populate the vector with found objects.
+    {
+        DP_TRACE_SCOPE("quadtree query");
+        quadtree.query(queryRange, potentialColliders); // Populate the vector with found objects.
+    }
+    DP_TRACE_COUNTER("objects found", potentialColliders.size());
 
     // Print the results of the query.
     if (potentialColliders.empty()) {
@@ -196,7 +121,11 @@ int main() {
     // Another query example: Simulating a player's view at the start of the world.
     Rect playerView = {0, 0, 100, 100}; 
     std::vector<GameObject*> objectsInPlayerView;
-    quadtree.query(playerView, objectsInPlayerView);
+    {
+        DP_TRACE_SCOPE("quadtree query");
+        quadtree.query(playerView, objectsInPlayerView);
+    }
+    DP_TRACE_COUNTER("objects found", objectsInPlayerView.size());
     std::cout << "Querying objects within player's view (bounds: " 
               << playerView.x << "," << playerView.y << "," << playerView.width << "," << playerView.height << ")\n";
     if (!objectsInPlayerView.empty()) {
@@ -208,10 +137,30 @@ int main() {
     } else {
         std::cout << "  No objects currently in player's view.\n";
     }
+    std::cout << "\n";
+
+    // When only the number of objects matters (a density heat-map, a level-of-detail decision),
+    // count() answers without building a list: every node knows how many objects its subtree
+    // holds and the box around them, so subtrees that lie entirely inside the range are added whole.
+    std::cout << "Object density (objects per quarter of the world):\n";
+    {
+        DP_TRACE_SCOPE("quadtree count");
+        float halfWidth = worldBoundary.width / 2;
+        float halfHeight = worldBoundary.height / 2;
+        for (int row = 0; row < 2; ++row) {
+            std::cout << " ";
+            for (int col = 0; col < 2; ++col) {
+                Rect cell = {col * halfWidth, row * halfHeight, halfWidth, halfHeight};
+                std::cout << " " << quadtree.count(cell);
+            }
+            std::cout << "\n";
+        }
+    }
+    std::cout << "  (" << quadtree.size() << " objects in total)\n";
 
     // The std::unique_ptr for children automatically handles memory cleanup when the Quadtree
     // (and its child unique_ptrs) go out of scope, so no manual `delete` for Quadtree nodes is needed.
-    // Since our GameObjects are stack-allocated in main, no special cleanup is required for them.
+    // The GameObjects are owned by the 'objects' vector, which frees them when main returns.
 
     return 0;
 }
\ No newline at end of file
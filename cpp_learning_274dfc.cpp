@@ -4,120 +4,399 @@
 // We will focus on the core concept of iterating a complex function to determine pixel color.
 // The SFML library is used for basic graphics output. You'll need to install it separately.
 // Installation instructions can be found on the official SFML website.
+// The rendered fractal is also saved to julia.png, so the program is still useful
+// (and still builds) on machines without SFML; the build defines DP_HAVE_SFML when it is found.
 
+#ifdef DP_HAVE_SFML
 #include <SFML/Graphics.hpp> // Include the SFML graphics library for window and drawing functions.
+#endif
+#include <algorithm>          // For copying a finished frame to be saved.
+#include <atomic>             // For cancelling a frame that is no longer wanted.
+#include <chrono>             // For how long the window waits for a frame.
 #include <complex>           // Include the complex number library for easy handling of complex numbers.
-#include <vector>            // Include vector for storing pixel data.
-
-// Define the dimensions of our fractal window.
-const int WIDTH = 800;
-const int HEIGHT = 600;
-
-// This function calculates the number of iterations it takes for a point
-// to escape a certain boundary when repeatedly applying the Julia set function.
-// This iteration count determines the color of the pixel.
-int julia_iterations(std::complex<double> c, std::complex<double> z0, int max_iterations) {
-    // c: The constant complex number defining the specific Julia set.
-    // z0: The initial complex number representing the pixel's position in the complex plane.
-    // max_iterations: The maximum number of iterations to perform before assuming the point is within the set.
-
-    std::complex<double> z = z0; // Initialize z with the starting point.
-
-    for (int i = 0; i < max_iterations; ++i) {
-        // The core Julia set iteration: z = z*z + c
-        // This is the complex function that generates the fractal pattern.
-        z = z * z + c;
-
-        // Check if the magnitude of z has exceeded a certain threshold (e.g., 2.0).
-        // If it exceeds the threshold, the point is considered to "escape" and is not part of the set.
-        if (std::norm(z) > 4.0) { // std::norm(z) calculates the squared magnitude of z.
-            return i; // Return the number of iterations it took to escape.
+#include <condition_variable> // For waking the render thread and waiting for its frames.
+#include <iostream>          // For status messages.
+#include <mutex>              // For handing views and frames between the threads.
+#include <string>            // For file names.
+#include <thread>             // For the window's render thread.
+#include <vector>            // For the iteration counts of every pixel.
+
+#include "common/image.h"       // Image: the shared pixel buffer we render into.
+#include "common/image_codec.h" // writeImage(): saves the fractal as PNG/QOI/PPM.
+#include "common/options.h"     // Options: every setting below can be changed on the command line.
+#include "common/scheduler.h"   // parallel_for(): renders rows on all CPU cores.
+#include "common/trace.h"       // DP_TRACE_SCOPE: timeline of the render (run with --trace=julia.json).
+#include "fractal/julia.h"      // julia_render_rows(): the escape-time core of the renderer.
+
+// Default dimensions of our fractal window (change them with --width/--height).
+const int DEFAULT_WIDTH = 800;
+const int DEFAULT_HEIGHT = 600;
+
+// The escape-time function julia_iterations() (and julia_render_rows(), which runs it over
+// whole rows of a view) lives in fractal/julia.h so that the benchmarks and other tools can share it.
+
+// 4. Generating the Fractal Pixels
+// Renders the Julia set for 'julia_constant' over 'view' into 'pixels' (which must be view-sized).
+// If 'cancel' is given and becomes true, the remaining rows are skipped: the window's render
+// thread (step 7) uses that to drop a frame the user has already zoomed away from.
+static void render_julia(std::complex<double> julia_constant, const JuliaView& view, int max_iterations,
+                         const ImageView& pixels, const std::atomic<bool>* cancel = nullptr) {
+    const int width = view.width;
+    const int height = view.height;
+    // Rows are independent, so they are rendered in parallel on the shared scheduler.
+    // Rows near the set take many more iterations than the rest; the small grain (4 rows)
+    // lets idle threads steal that work instead of waiting on one slow chunk.
+    // Each thread only writes its own rows, so no locking is needed.
+    std::vector<int> iteration_counts((std::size_t)width * height);
+    parallel_for(0, height, 4, [&](int rowBegin, int rowEnd) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return;
+        }
+        DP_TRACE_SCOPE("julia tile"); // One chunk of rows: the unit of work a thread picks up.
+
+        // Calculate the number of iterations for these rows. julia_render_rows() maps each pixel
+        // (x, y) to its point in the complex plane and runs julia_iterations() on it, several
+        // pixels at a time, so the CPU is not waiting on one long chain of multiplications.
+        julia_render_rows(julia_constant, view, rowBegin, rowEnd, max_iterations, iteration_counts.data());
+
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int iterations = iteration_counts[(std::size_t)y * width + x];
+
+                // 5. Coloring the Pixels
+                // The color is determined by the number of iterations.
+                // We use a simple coloring scheme:
+                // - If the point is inside the set (max_iterations reached), color it black.
+                // - Otherwise, color it based on the number of iterations to create a gradient.
+                Color pixel_color;
+                if (iterations == max_iterations) {
+                    pixel_color = Color{0, 0, 0}; // Point is likely in the set (black).
+                } else {
+                    // Map iterations to a color gradient. This is a basic example;
+                    // more sophisticated coloring can create stunning visuals.
+                    // We're using 'iterations' to control the R, G, B components.
+                    unsigned char color_value = static_cast<unsigned char>((iterations * 255) / max_iterations);
+                    pixel_color = Color{color_value, static_cast<unsigned char>(color_value / 2),
+                                        static_cast<unsigned char>(color_value / 4)}; // A simple hue shift.
+                }
+                pixels.set(x, y, pixel_color); // Set the color of the pixel in the image.
+            }
         }
+    });
+}
+
+// 6. Saving the Fractal
+// Writes 'pixels' to 'output' (if one was asked for). Returns false if that fails.
+static bool save_julia(const ImageView& pixels, const std::string& output) {
+    if (output.empty()) {
+        return true;
     }
-    return max_iterations; // If the point didn't escape within max_iterations, it's considered inside the set.
+    if (!writeImage(pixels, output)) {
+        return false; // writeImage() has printed why.
+    }
+    std::cout << "Julia set saved to " << output << std::endl;
+    return true;
 }
 
-int main() {
+#ifdef DP_HAVE_SFML
+// 7a. A Render Thread for the Window
+// Rendering a frame takes far longer than drawing one, so the window doesn't render itself:
+// it hands each new view to this render thread and carries on handling events. The thread
+// renders into a back buffer and, when the frame is complete, swaps it with the front buffer
+// that the window copies from (double buffering), so the window never sees half a frame.
+class FrameRenderer {
+public:
+    FrameRenderer(std::complex<double> julia_constant, int max_iterations, int width, int height)
+        : julia_constant(julia_constant), max_iterations(max_iterations),
+          front(width, height, 4), back(width, height, 4), thread([this] { run(); }) {}
+
+    ~FrameRenderer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            cancel = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+    // Asks for a frame of 'view' and returns the number that frame will carry (1, 2, ...).
+    // A frame still being rendered for an older view is abandoned.
+    int request(const JuliaView& view) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_view = view;
+        pending_number = ++requests_made;
+        has_request = true;
+        cancel = true;
+        wake.notify_all();
+        return pending_number;
+    }
+
+    // True while a requested frame hasn't been taken yet.
+    bool busy() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return has_request || rendering || frame_ready;
+    }
+
+    // Waits (without using the CPU) until a frame is ready, for at most 'timeout'.
+    void wait_for_frame(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        frame_done.wait_for(lock, timeout, [this] { return frame_ready; });
+    }
+
+    // If a new frame is ready, uploads it into 'texture' (and copies it into 'copy', if given)
+    // and returns its number from request(). Returns 0 if there is no new frame.
+    int take_frame(sf::Texture& texture, Image* copy = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!frame_ready) {
+            return 0;
+        }
+        texture.update(front.data());
+        if (copy) {
+            std::copy(front.data(), front.data() + front.sizeBytes(), copy->data());
+        }
+        frame_ready = false;
+        return front_number;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || has_request; }); // Sleeps until there is work.
+            if (stopping) {
+                return;
+            }
+            JuliaView view = pending_view;
+            int number = pending_number;
+            has_request = false;
+            cancel = false;
+            rendering = true;
+            lock.unlock();
+
+            render_julia(julia_constant, view, max_iterations, back.view(), &cancel);
+
+            lock.lock();
+            rendering = false;
+            if (!cancel) {
+                std::swap(front, back); // Publish the finished frame.
+                front_number = number;
+                frame_ready = true;
+                frame_done.notify_all();
+            }
+        }
+    }
+
+    std::complex<double> julia_constant;
+    int max_iterations;
+
+    std::mutex mutex; // Guards everything below except 'back', which only the render thread touches.
+    std::condition_variable wake;       // Signalled when there is a new request (or on shutdown).
+    std::condition_variable frame_done; // Signalled when a frame was published.
+    JuliaView pending_view = {};
+    int pending_number = 0;
+    int requests_made = 0;
+    int front_number = 0; // The request() number of the frame in 'front'.
+    bool has_request = false;
+    bool rendering = false;
+    bool frame_ready = false;
+    bool stopping = false;
+    std::atomic<bool> cancel{false};
+    Image front;
+    Image back;
+
+    std::thread thread; // Last, so it starts once everything above is initialized.
+};
+#endif
+
+int main(int argc, char** argv) {
+    // 0. Reading the Settings
+    int width = DEFAULT_WIDTH;
+    int height = DEFAULT_HEIGHT;
+    double c_real = -0.7;     // Example constant for a common Julia set...
+    double c_imag = 0.27015;  // ...see step 2.
+    int max_iterations = 100; // Number of iterations for each pixel. Higher values give more detail but take longer.
+    double center_real = 0.0; // The point of the complex plane at the centre of the image...
+    double center_imag = 0.0;
+    double zoom = 1.0;        // ...and how far to magnify around it.
+    std::string output = "julia.png";
+    bool show_window = true;
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_fractal", "Renders a Julia set, saves it and shows it in a window.");
+    options.add("width", width, "Image width in pixels", 1, 65536);
+    options.add("height", height, "Image height in pixels", 1, 65536);
+    options.add("c-real", c_real, "Real part of the Julia constant c");
+    options.add("c-imag", c_imag, "Imaginary part of the Julia constant c");
+    options.add("max-iterations", max_iterations, "Iterations before a point counts as inside the set", 1);
+    options.add("center-real", center_real, "Real part of the point at the centre of the image");
+    options.add("center-imag", center_imag, "Imaginary part of the point at the centre of the image");
+    options.add("zoom", zoom, "Magnification around the centre (1: the whole set)", 1e-3);
+    options.add("output", output, "Output image, .png/.qoi/.ppm (empty: don't write one)");
+    options.add("window", show_window, "Show the fractal in a window (needs SFML)");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
     // 1. Setting up the SFML Window
-    sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "Julia Set Fractal"); // Create a window with specified dimensions and title.
+    // The window is opened in step 7, before anything is rendered: the render thread fills it in.
+    bool use_window = false;
+#ifdef DP_HAVE_SFML
+    use_window = show_window;
+#endif
 
     // 2. Defining the Julia Set Parameters
     // The constant 'c' defines the specific Julia set we want to visualize.
     // Different values of 'c' produce vastly different fractal patterns.
-    std::complex<double> julia_constant(-0.7, 0.27015); // Example constant for a common Julia set.
+    std::complex<double> julia_constant(c_real, c_imag);
 
     // 3. Creating an Image to Store Pixel Data
-    sf::Image fractal_image;
-    fractal_image.create(WIDTH, HEIGHT); // Create an empty image with the window's dimensions.
+    // RGBA (4 channels) is the layout SFML textures use, so the pixels can be uploaded as they are.
+    Image fractal_image(width, height, 4); // Create an empty image with the window's dimensions.
+    ImageView pixels = fractal_image.view();
 
-    // 4. Generating the Fractal Pixels
-    int max_iterations = 100; // Number of iterations for each pixel. Higher values give more detail but take longer.
+    // Which part of the complex plane to show. At --zoom=1 the window spans [-2.0, 2.0] horizontally
+    // (and proportionally less vertically: [-1.5, 1.5] at 800x600) around the centre; every
+    // doubling of the zoom halves the distance between neighbouring pixels.
+    JuliaView view;
+    view.center_real = dd_from(center_real);
+    view.center_imag = dd_from(center_imag);
+    view.pixel_spacing = 4.0 / (width * zoom);
+    view.width = width;
+    view.height = height;
 
-    for (int x = 0; x < WIDTH; ++x) {
-        for (int y = 0; y < HEIGHT; ++y) {
-            // Map the pixel coordinates (x, y) to the complex plane.
-            // We're mapping the screen coordinates to a specific region of the complex plane.
-            // Here, we map the pixel grid [0, WIDTH]x[0, HEIGHT] to the complex region [-2.0, 2.0]x[-1.5, 1.5].
-            // You can adjust these ranges to zoom into different parts of the fractal.
-            double real_part = -2.0 + (double)x / WIDTH * 4.0;
-            double imag_part = -1.5 + (double)y / HEIGHT * 3.0;
-            std::complex<double> z0(real_part, imag_part); // The initial complex number for this pixel.
-
-            // Calculate the number of iterations for this point.
-            int iterations = julia_iterations(julia_constant, z0, max_iterations);
-
-            // 5. Coloring the Pixels
-            // The color is determined by the number of iterations.
-            // We use a simple coloring scheme:
-            // - If the point is inside the set (max_iterations reached), color it black.
-            // - Otherwise, color it based on the number of iterations to create a gradient.
-            sf::Color pixel_color;
-            if (iterations == max_iterations) {
-                pixel_color = sf::Color::Black; // Point is likely in the set.
-            } else {
-                // Map iterations to a color gradient. This is a basic example;
-                // more sophisticated coloring can create stunning visuals.
-                // We're using 'iterations' to control the R, G, B components.
-                unsigned char color_value = static_cast<unsigned char>((iterations * 255) / max_iterations);
-                pixel_color = sf::Color(color_value, color_value / 2, color_value / 4); // A simple hue shift.
-            }
-            fractal_image.setPixel(x, y, pixel_color); // Set the color of the pixel in the image.
-        }
+    // Once pixels are closer together than about 1e-13, doubles can't tell them apart any more and
+    // the picture turns into blocks; the renderer then switches to double-double arithmetic
+    // (about 32 digits instead of 16, several times slower). See fractal/double_double.h.
+    if (julia_view_precision(view) == FractalPrecision::DoubleDouble) {
+        std::cout << "Deep zoom: rendering with double-double precision." << std::endl;
+    }
+
+    // 4. Generating the Fractal Pixels (and 5. Coloring them): see render_julia() above.
+    // Without a window the fractal is rendered right here and saved (step 6); with one, the
+    // window's render thread does it and the first frame of the starting view is saved.
+    if (!use_window) {
+        render_julia(julia_constant, view, max_iterations, pixels);
+        return save_julia(pixels, output) ? 0 : 1;
     }
 
-    // 6. Displaying the Fractal
-    sf::Texture fractal_texture;
-    fractal_texture.loadFromImage(fractal_image); // Load the image data into a texture.
+    // 7. Displaying the Fractal
+#ifdef DP_HAVE_SFML
+    sf::RenderWindow window(sf::VideoMode(width, height), "Julia Set Fractal"); // Create a window with specified dimensions and title.
+    window.setVerticalSyncEnabled(true); // display() waits for the screen's refresh instead of spinning.
+
+    // Two textures, also double-buffered: a new frame is uploaded into the one not on screen,
+    // then the sprite switches to it, so the GPU is never reading a texture while it changes.
+    sf::Texture textures[2];
+    textures[0].create(width, height);
+    textures[1].create(width, height);
+    textures[0].update(fractal_image.data()); // Black (and transparent) until the first frame arrives.
+    int shown = 0;
     sf::Sprite fractal_sprite;
-    fractal_sprite.setTexture(fractal_texture); // Create a sprite to draw the texture.
+    fractal_sprite.setTexture(textures[shown]); // Create a sprite to draw the texture.
+
+    // Controls: the mouse wheel zooms in and out around the cursor, a left click centres the view
+    // on the clicked point, R goes back to the starting view, and Escape quits.
+    FrameRenderer renderer(julia_constant, max_iterations, width, height);
+    const JuliaView start_view = view;
+    bool redraw = true;
+
+    // The starting view is the first frame asked for. It is saved (step 6) when it arrives; if
+    // the user moves away before that, it is saved when they come back with R, or at the end.
+    const int first_frame = renderer.request(view);
+    int output_frame = output.empty() ? 0 : first_frame; // The frame to save (0: nothing left to save).
+    bool saved = true;
 
     // Main application loop
+    // It only runs when something happens. With nothing to do it sleeps in waitEvent() until
+    // the user acts; while a frame is being rendered it also wakes up when the frame is ready.
+    // (The render thread can't wake waitEvent(), hence the short waits on the frame instead.)
     while (window.isOpen()) {
         sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close(); // Close the window if the close button is clicked.
+        bool have_event;
+        if (renderer.busy()) {
+            renderer.wait_for_frame(std::chrono::milliseconds(16));
+            have_event = window.pollEvent(event);
+        } else {
+            have_event = window.waitEvent(event);
+        }
+
+        for (; have_event; have_event = window.pollEvent(event)) {
+            bool view_changed = false;
+            if (event.type == sf::Event::Closed ||
+                (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close(); // Close the window if the close button (or Escape) is pressed.
+            } else if (event.type == sf::Event::MouseWheelScrolled) {
+                // Zoom by 2x per notch, keeping the point under the cursor where it is.
+                double factor = event.mouseWheelScroll.delta > 0 ? 0.5 : 2.0;
+                DoubleDouble cursor_real = view.center_real + two_prod(event.mouseWheelScroll.x - 0.5 * width, view.pixel_spacing);
+                DoubleDouble cursor_imag = view.center_imag + two_prod(event.mouseWheelScroll.y - 0.5 * height, view.pixel_spacing);
+                view.center_real = cursor_real + (view.center_real - cursor_real) * factor;
+                view.center_imag = cursor_imag + (view.center_imag - cursor_imag) * factor;
+                view.pixel_spacing *= factor;
+                view_changed = true;
+            } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                view.center_real = view.center_real + two_prod(event.mouseButton.x - 0.5 * width, view.pixel_spacing);
+                view.center_imag = view.center_imag + two_prod(event.mouseButton.y - 0.5 * height, view.pixel_spacing);
+                view_changed = true;
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
+                view = start_view;
+                if (output_frame != 0) {
+                    output_frame = renderer.request(view); // Not saved yet: this frame will do.
+                } else {
+                    view_changed = true;
+                }
+            } else if (event.type == sf::Event::GainedFocus || event.type == sf::Event::Resized) {
+                redraw = true;
+            }
+            if (view_changed) {
+                renderer.request(view);
             }
         }
 
-        window.clear(); // Clear the window with a background color (default is black).
-        window.draw(fractal_sprite); // Draw the fractal sprite onto the window.
-        window.display(); // Update the window to show what has been drawn.
+        int frame = renderer.take_frame(textures[1 - shown], output_frame != 0 ? &fractal_image : nullptr);
+        if (frame != 0) {
+            if (frame == output_frame) {
+                saved = save_julia(pixels, output);
+                output_frame = 0;
+            }
+            shown = 1 - shown;
+            fractal_sprite.setTexture(textures[shown]);
+            redraw = true;
+        }
+        if (redraw && window.isOpen()) {
+            window.clear(); // Clear the window with a background color (default is black).
+            window.draw(fractal_sprite); // Draw the fractal sprite onto the window.
+            window.display(); // Update the window to show what has been drawn.
+            redraw = false;
+        }
     }
 
-    return 0; // Indicate successful execution.
+    // Closed before the starting view was ever finished: render it now, to save it.
+    if (output_frame != 0) {
+        render_julia(julia_constant, start_view, max_iterations, pixels);
+        saved = save_julia(pixels, output);
+    }
+    return saved ? 0 : 1;
+#else
+    return 0; // Not reached: without SFML there is no window.
+#endif
 }
 
 // Example Usage:
 // To compile and run this code:
-// 1. Make sure you have SFML installed.
-// 2. Save the code as a .cpp file (e.g., julia_fractal.cpp).
-// 3. Compile using a C++ compiler like g++:
-//    g++ julia_fractal.cpp -o julia_fractal -lsfml-graphics -lsfml-window -lsfml-system
-// 4. Run the executable:
-//    ./julia_fractal
+// 1. Make sure you have SFML installed (optional: needed only for the window).
+// 2. Build it with the project's CMake build (see README.md), which links SFML for you:
+//    cmake --preset release && cmake --build --preset release --target julia_fractal
+// 3. Run the executable:
+//    ./build/release/julia_fractal
 //
-// You should see a graphical window displaying a Julia set fractal.
-// Try changing the 'julia_constant' variable to see different fractal patterns!
-// Experiment with 'max_iterations' to control detail and computation time.
-// Adjust the mapping of pixel coordinates to the complex plane (real_part, imag_part) to zoom and pan.
\ No newline at end of file
+// You should see a graphical window displaying a Julia set fractal, and find it saved as julia.png.
+// Without SFML the program still builds; it just skips the window.
+// Try changing the Julia constant (--c-real, --c-imag) to see different fractal patterns!
+// Experiment with --max-iterations to control detail and computation time.
+// Run with --help to see every setting; --config=FILE reads them from "name = value" lines.
+// In the window, scroll to zoom in and out around the cursor, click to recentre, press R to reset.
+// Each new view is rendered on a separate thread, so the window stays responsive while it works.
\ No newline at end of file
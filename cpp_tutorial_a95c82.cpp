@@ -7,6 +7,13 @@
 #include <iostream> // For console output (e.g., error messages)
 #include <vector>   // For storing points that define our triangle
 #include <cmath>    // For mathematical operations if needed (not strictly for Sierpinski, but good to have)
+#include <string>   // For file names
+
+#include "common/image.h"       // The shared image buffer, to rasterize the triangle
+#include "common/image_codec.h" // To save the rasterized triangle as PNG/QOI/PPM
+#include "common/options.h"     // For --depth and friends on the command line
+#include "common/scheduler.h"   // For generating large branches of the fractal in parallel
+#include "common/trace.h"       // For timing each stage (run with --trace=sierpinski.json)
 
 // --- Graphics Library Placeholder ---
 // For simplicity and broad compatibility, we'll simulate graphics.
@@ -26,6 +33,11 @@ void drawLine(const Point& p1, const Point& p2) {
     std::cout << "Drawing line from (" << p1.x << ", " << p1.y << ") to (" << p2.x << ", " << p2.y << ")\n";
 }
 
+// Represents one edge of a triangle, waiting to be drawn.
+struct Segment {
+    Point start, end;
+};
+
 // --- Recursive Fractal Generation ---
 
 // Function to calculate the midpoint between two points.
@@ -34,19 +46,26 @@ Point midpoint(const Point& p1, const Point& p2) {
     return {(p1.x + p2.x) / 2.0, (p1.y + p2.y) / 2.0};
 }
 
-// The core recursive function to draw the Sierpinski Triangle.
+// Below this depth a branch is too small to be worth handing to another thread
+// (a branch of depth d produces 3^(d+1) segments).
+const int PARALLEL_MIN_DEPTH = 6;
+
+// The core recursive function to build the Sierpinski Triangle.
+// Instead of drawing right away, it appends the edges to 'segments' in drawing order,
+// which lets big branches be generated in parallel and still come out in the same order.
 // Parameters:
 //   p1, p2, p3: The three vertices of the current triangle.
 //   depth: The current level of recursion. Controls the complexity of the fractal.
-void drawSierpinski(Point p1, Point p2, Point p3, int depth) {
+//   segments: Where the edges of the finished triangles are collected.
+void drawSierpinski(Point p1, Point p2, Point p3, int depth, std::vector<Segment>& segments) {
     // Base Case: If the depth is 0, we've reached the desired complexity.
     // We draw the outermost triangle (or stop subdividing).
     if (depth == 0) {
-        // Draw the current triangle's edges.
+        // Record the current triangle's edges.
         // This is where the visual lines would appear in a real graphics context.
-        drawLine(p1, p2);
-        drawLine(p2, p3);
-        drawLine(p3, p1);
+        segments.push_back({p1, p2});
+        segments.push_back({p2, p3});
+        segments.push_back({p3, p1});
         return; // Stop recursion for this branch
     }
 
@@ -59,23 +78,85 @@ void drawSierpinski(Point p1, Point p2, Point p3, int depth) {
     // Now, we recursively call drawSierpinski for the three smaller triangles
     // formed by the original vertices and the midpoints.
     // Each recursive call reduces the depth by 1.
-
-    // Top triangle (using p1 and the two new midpoints)
-    drawSierpinski(p1, m12, m31, depth - 1);
-
-    // Left triangle (using p2 and the two new midpoints)
-    drawSierpinski(p2, m23, m12, depth - 1);
-
-    // Right triangle (using p3 and the two new midpoints)
-    drawSierpinski(p3, m31, m23, depth - 1);
+    if (depth < PARALLEL_MIN_DEPTH) {
+        // Top triangle (using p1 and the two new midpoints)
+        drawSierpinski(p1, m12, m31, depth - 1, segments);
+
+        // Left triangle (using p2 and the two new midpoints)
+        drawSierpinski(p2, m23, m12, depth - 1, segments);
+
+        // Right triangle (using p3 and the two new midpoints)
+        drawSierpinski(p3, m31, m23, depth - 1, segments);
+    } else {
+        // Big branches: fork the three sub-triangles onto the scheduler, each with its own
+        // segment list, then join and append them in the same top/left/right order.
+        DP_TRACE_SCOPE("sierpinski branch");
+        std::vector<Segment> top, left, right;
+        TaskGroup group;
+        group.run([&] { drawSierpinski(p1, m12, m31, depth - 1, top); });
+        group.run([&] { drawSierpinski(p2, m23, m12, depth - 1, left); });
+        drawSierpinski(p3, m31, m23, depth - 1, right);
+        group.wait();
+
+        segments.insert(segments.end(), top.begin(), top.end());
+        segments.insert(segments.end(), left.begin(), left.end());
+        segments.insert(segments.end(), right.begin(), right.end());
+    }
 
     // Important Note: We DO NOT draw the middle triangle (formed by m12, m23, m31).
     // This is what creates the "holes" and the characteristic Sierpinski pattern.
 }
 
+// --- Raster Output ---
+// Besides printing, we rasterize the segments into a grayscale image with the shared
+// rasterizer, so the fractal can actually be looked at.
+
+const int CANVAS_WIDTH = 400;  // Large enough for the example triangle below.
+const int CANVAS_HEIGHT = 450;
+
+// The deepest level the canvas can show: at depth 10 the smallest triangles of the 300-pixel
+// example are already about a third of a pixel across, and every level triples the segments
+// (depth 16 would be 3^17, about 129 million, several GiB).
+const int MAX_DEPTH = 10;
+
+// Prints an error and returns false if the image can't be written.
+bool saveAsImage(const std::vector<Segment>& segments, const std::string& filename) {
+    DP_TRACE_SCOPE("rasterize sierpinski");
+    Image image(CANVAS_WIDTH, CANVAS_HEIGHT, 1); // One channel (gray) is all a line drawing needs.
+    fillImage(image.view(), Color{255, 255, 255});
+    for (const Segment& segment : segments) {
+        strokeLine(image.view(), static_cast<float>(segment.start.x), static_cast<float>(segment.start.y),
+                   static_cast<float>(segment.end.x), static_cast<float>(segment.end.y), 1.0f, Color{0, 0, 0});
+    }
+    if (!writeImage(image.view(), filename)) {
+        return false;
+    }
+    std::cout << "Sierpinski triangle saved to " << filename << std::endl;
+    return true;
+}
+
 // --- Example Usage ---
 
-int main() {
+int main(int argc, char** argv) {
+    // Define the desired depth of recursion.
+    // Higher depth means more intricate patterns.
+    // Be careful: depth grows exponentially, so keep it reasonable for testing.
+    int recursion_depth = 4; // Try values like 0, 1, 2, 3, 4 with --depth
+    bool print_lines = true;
+    std::string output = "sierpinski.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("sierpinski", "Generates a Sierpinski triangle by recursive subdivision.");
+    options.add("depth", recursion_depth, "Recursion depth (the number of lines grows as 3^(depth+1))", 0,
+                MAX_DEPTH);
+    options.add("print", print_lines, "Print every line that is drawn");
+    options.add("output", output, "Output image, .png/.qoi/.ppm (empty: don't write one)");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
     std::cout << "--- Generating Sierpinski Triangle ---" << std::endl;
 
     // Define the initial triangle vertices.
@@ -85,18 +166,30 @@ int main() {
     Point start_p2 = {50.0, 400.0};  // Bottom-left vertex
     Point start_p3 = {350.0, 400.0}; // Bottom-right vertex
 
-    // Define the desired depth of recursion.
-    // Higher depth means more intricate patterns.
-    // Be careful: depth grows exponentially, so keep it reasonable for testing.
-    int recursion_depth = 4; // Try values like 0, 1, 2, 3, 4
-
     std::cout << "Initial triangle points: P1(" << start_p1.x << ", " << start_p1.y
               << "), P2(" << start_p2.x << ", " << start_p2.y << "), P3(" << start_p3.x << ", " << start_p3.y << ")\n";
     std::cout << "Recursion depth: " << recursion_depth << std::endl;
     std::cout << "\n--- Drawing Process ---" << std::endl;
 
-    // Call the recursive function to start drawing.
-    drawSierpinski(start_p1, start_p2, start_p3, recursion_depth);
+    // Call the recursive function to build the triangle, then draw its edges in order.
+    std::vector<Segment> segments;
+    {
+        DP_TRACE_SCOPE("sierpinski generation");
+        drawSierpinski(start_p1, start_p2, start_p3, recursion_depth, segments);
+    }
+    if (print_lines) {
+        DP_TRACE_SCOPE("print segments");
+        for (const Segment& segment : segments) {
+            drawLine(segment.start, segment.end);
+        }
+    }
+
+    if (!output.empty()) {
+        std::cout << "\n";
+        if (!saveAsImage(segments, output)) {
+            return 1;
+        }
+    }
 
     std::cout << "\n--- Fractal Generation Complete ---" << std::endl;
 
@@ -0,0 +1,121 @@
+// Double-double arithmetic: a number stored as the unevaluated sum hi + lo of two doubles,
+// where lo holds the rounding error of hi. That gives about 106 bits of mantissa (~32 decimal
+// digits) instead of 53, using nothing but ordinary double operations.
+//
+// The fractal renderers need it for deep zooms: once neighbouring pixels are closer together than
+// about 1e-13, plain doubles can no longer tell their coordinates (or the orbits that start from
+// them) apart, and the picture turns into blocks. Double-double pushes that limit to about 1e-28
+// at roughly 5-10x the cost of double, which is far cheaper than arbitrary precision.
+//
+// Everything is inline so the compiler can keep hi/lo in registers and vectorize loops over
+// several numbers (see julia_iterations_dd_batch() in fractal/julia.h).
+
+#pragma once
+
+#include <cmath> // std::fma
+
+// two_prod() needs the exact rounding error of a product. A fused multiply-add gives it in one
+// instruction; without one (e.g. a baseline x86-64 build, where std::fma would be a slow library
+// call) Dekker's algorithm computes the same exact error with plain multiplies.
+#if defined(__FMA__) || defined(__AVX2__) || defined(__ARM_FEATURE_FMA)
+#define DP_DOUBLE_DOUBLE_FMA 1
+#else
+#define DP_DOUBLE_DOUBLE_FMA 0
+#endif
+
+struct DoubleDouble {
+    double hi; // The value rounded to double.
+    double lo; // What hi is missing: |lo| <= half an ulp of hi.
+};
+
+inline DoubleDouble dd_from(double value) {
+    return DoubleDouble{value, 0.0};
+}
+
+inline double dd_to_double(DoubleDouble a) {
+    return a.hi + a.lo;
+}
+
+// --- Error-free transformations ---
+// Each returns the rounded result in hi and its exact rounding error in lo.
+
+// a + b for any a and b.
+inline DoubleDouble two_sum(double a, double b) {
+    double s = a + b;
+    double bb = s - a;
+    double err = (a - (s - bb)) + (b - bb);
+    return DoubleDouble{s, err};
+}
+
+// a + b when |a| >= |b| (or a == 0): three operations instead of six.
+inline DoubleDouble quick_two_sum(double a, double b) {
+    double s = a + b;
+    double err = b - (s - a);
+    return DoubleDouble{s, err};
+}
+
+// a * b.
+inline DoubleDouble two_prod(double a, double b) {
+    double p = a * b;
+#if DP_DOUBLE_DOUBLE_FMA
+    double err = std::fma(a, b, -p); // The fused a*b - p is exact: it is what rounding a*b lost.
+#else
+    // Split each factor into two 26-bit halves, whose products are exact in a double.
+    const double SPLITTER = 134217729.0; // 2^27 + 1
+    double ta = SPLITTER * a;
+    double aHi = ta - (ta - a);
+    double aLo = a - aHi;
+    double tb = SPLITTER * b;
+    double bHi = tb - (tb - b);
+    double bLo = b - bHi;
+    double err = ((aHi * bHi - p) + aHi * bLo + aLo * bHi) + aLo * bLo;
+#endif
+    return DoubleDouble{p, err};
+}
+
+// --- Arithmetic ---
+// These are the "sloppy" variants (relative error ~2^-104 instead of ~2^-106), which is plenty
+// for escape-time iteration and about half the cost of the fully accurate ones.
+
+inline DoubleDouble operator+(DoubleDouble a, DoubleDouble b) {
+    DoubleDouble s = two_sum(a.hi, b.hi);
+    s.lo += a.lo + b.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+inline DoubleDouble operator-(DoubleDouble a) {
+    return DoubleDouble{-a.hi, -a.lo};
+}
+
+inline DoubleDouble operator-(DoubleDouble a, DoubleDouble b) {
+    return a + (-b);
+}
+
+inline DoubleDouble operator*(DoubleDouble a, DoubleDouble b) {
+    DoubleDouble p = two_prod(a.hi, b.hi);
+    p.lo += a.hi * b.lo + a.lo * b.hi; // a.lo * b.lo is below the precision we keep.
+    return quick_two_sum(p.hi, p.lo);
+}
+
+inline DoubleDouble operator*(DoubleDouble a, double b) {
+    DoubleDouble p = two_prod(a.hi, b);
+    p.lo += a.lo * b;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+inline DoubleDouble dd_sqr(DoubleDouble a) {
+    DoubleDouble p = two_prod(a.hi, a.hi);
+    p.lo += 2.0 * a.hi * a.lo;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+// Multiplying by a power of two is exact, so both halves just scale.
+inline DoubleDouble dd_twice(DoubleDouble a) {
+    return DoubleDouble{2.0 * a.hi, 2.0 * a.lo};
+}
+
+// A complex number with double-double parts, for the deep-zoom escape-time loops.
+struct DoubleDoubleComplex {
+    DoubleDouble re;
+    DoubleDouble im;
+};
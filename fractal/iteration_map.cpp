@@ -0,0 +1,466 @@
+#include "fractal/iteration_map.h"
+
+#include <algorithm> // For std::min
+#include <cstring>   // For memcpy
+#include <iostream>  // For error messages
+#include <iterator>  // For reading a whole file
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DP_HAVE_MMAP 1
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap/munmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+#endif
+
+// File layout, all numbers little-endian:
+//   header  "DPIM", version, width, height, max_iterations, block rows (u32 each),
+//           index offset (u64), block count, reserved (u32 each)
+//   blocks  compressed block data, one after the other
+//   index   per block: offset (u64), compressed size, raw size (u32 each)
+// A block's raw data is its low-byte plane, its high-byte plane (one byte per pixel each), then
+// its overflow values (4 bytes each).
+static const char MAGIC[4] = {'D', 'P', 'I', 'M'};
+static const std::uint32_t VERSION = 1;
+static const std::size_t HEADER_SIZE = 40;
+static const std::size_t INDEX_OFFSET_POSITION = 24;
+static const std::size_t INDEX_ENTRY_SIZE = 16;
+
+// Keeps a block's raw size (up to 6 bytes per pixel with overflow values) within 32 bits.
+static const int MAX_WIDTH = 1 << 22;
+
+static void put_u32(std::uint8_t* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = (std::uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_u64(std::uint8_t* out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = (std::uint8_t)(value >> (8 * i));
+    }
+}
+
+static std::uint32_t get_u32(const std::uint8_t* in) {
+    return (std::uint32_t)in[0] | (std::uint32_t)in[1] << 8 | (std::uint32_t)in[2] << 16 | (std::uint32_t)in[3] << 24;
+}
+
+static std::uint64_t get_u64(const std::uint8_t* in) {
+    return (std::uint64_t)get_u32(in) | (std::uint64_t)get_u32(in + 4) << 32;
+}
+
+// --- The LZ step ---
+//
+// The stream is a series of sequences, as in LZ4: a token byte (literal count in the high
+// nibble, match length - LZ_MIN_MATCH in the low one; 15 means "more in the following bytes",
+// each adding up to 255), the literals, then a 2-byte distance back to the match. The last
+// sequence has literals only, and ends the stream.
+
+static const int LZ_MIN_MATCH = 4;
+static const int LZ_HASH_BITS = 14;
+static const std::size_t LZ_MAX_DISTANCE = 65535;
+
+static void put_length(std::vector<std::uint8_t>& out, std::size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back((std::uint8_t)length);
+}
+
+static void put_sequence(std::vector<std::uint8_t>& out, const std::uint8_t* literals, std::size_t literal_count,
+                         std::size_t distance, std::size_t match_length) {
+    const std::size_t match_code = match_length > 0 ? match_length - LZ_MIN_MATCH : 0;
+    out.push_back((std::uint8_t)((literal_count < 15 ? literal_count : 15) << 4 | (match_code < 15 ? match_code : 15)));
+    if (literal_count >= 15) {
+        put_length(out, literal_count - 15);
+    }
+    out.insert(out.end(), literals, literals + literal_count);
+    if (match_length > 0) {
+        out.push_back((std::uint8_t)distance);
+        out.push_back((std::uint8_t)(distance >> 8));
+        if (match_code >= 15) {
+            put_length(out, match_code - 15);
+        }
+    }
+}
+
+void iteration_map_compress(const std::uint8_t* in, std::size_t size, std::vector<std::uint8_t>& out) {
+    // The last position each 4-byte sequence was seen at (plus one; 0: never).
+    std::vector<std::uint32_t> table((std::size_t)1 << LZ_HASH_BITS, 0);
+    std::size_t anchor = 0; // Start of the literals not yet written.
+    std::size_t position = 0;
+    std::size_t misses = 0;
+    while (position + LZ_MIN_MATCH <= size) {
+        std::uint32_t sequence;
+        std::memcpy(&sequence, in + position, 4);
+        const std::uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        const std::size_t candidate = table[hash];
+        table[hash] = (std::uint32_t)(position + 1);
+
+        if (candidate > 0 && position - (candidate - 1) <= LZ_MAX_DISTANCE &&
+            std::memcmp(in + candidate - 1, in + position, 4) == 0) {
+            const std::size_t match = candidate - 1;
+            std::size_t length = LZ_MIN_MATCH;
+            while (position + length < size && in[match + length] == in[position + length]) {
+                ++length;
+            }
+            put_sequence(out, in + anchor, position - anchor, position - match, length);
+            position += length;
+            anchor = position;
+            misses = 0;
+        } else {
+            // Skip ahead faster the longer nothing matches, so incompressible data goes quickly.
+            position += 1 + (misses++ >> 5);
+        }
+    }
+    put_sequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+// Reads a length continued over extra bytes. Returns false if the input runs out.
+static bool get_length(const std::uint8_t*& in, const std::uint8_t* end, std::size_t& length) {
+    std::uint8_t byte;
+    do {
+        if (in == end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool iteration_map_decompress(const std::uint8_t* in, std::size_t size, std::uint8_t* out, std::size_t out_size) {
+    const std::uint8_t* end = in + size;
+    std::size_t written = 0;
+    while (in < end) {
+        const std::uint8_t token = *in++;
+        std::size_t literal_count = token >> 4;
+        if (literal_count == 15 && !get_length(in, end, literal_count)) {
+            return false;
+        }
+        if (literal_count > (std::size_t)(end - in) || literal_count > out_size - written) {
+            return false;
+        }
+        std::memcpy(out + written, in, literal_count);
+        in += literal_count;
+        written += literal_count;
+        if (in == end) {
+            break; // The last sequence: literals only.
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        const std::size_t distance = (std::size_t)in[0] | (std::size_t)in[1] << 8;
+        in += 2;
+        std::size_t match_length = token & 15;
+        if (match_length == 15 && !get_length(in, end, match_length)) {
+            return false;
+        }
+        match_length += LZ_MIN_MATCH;
+        if (distance == 0 || distance > written || match_length > out_size - written) {
+            return false;
+        }
+        // Byte by byte: a match may overlap the bytes it is producing (distance 1 is a run).
+        const std::uint8_t* from = out + written - distance;
+        for (std::size_t i = 0; i < match_length; ++i) {
+            out[written + i] = from[i];
+        }
+        written += match_length;
+    }
+    return written == out_size;
+}
+
+// --- Blocks ---
+
+// Steps 1-3 of the format (see the header) for 'count' counts, rows of 'width'.
+static void pack_block(const int* counts, std::size_t count, int width, std::vector<std::uint8_t>& raw) {
+    raw.assign(2 * count, 0);
+    std::uint8_t* low = raw.data();
+    std::uint8_t* high = raw.data() + count;
+    std::vector<std::uint8_t> overflow;
+    for (std::size_t row = 0; row < count; row += width) {
+        std::uint16_t previous = 0;
+        for (std::size_t i = row; i < row + width; ++i) {
+            std::uint16_t code = ITERATION_MAP_ESCAPE;
+            if (counts[i] >= 0 && counts[i] < ITERATION_MAP_ESCAPE) {
+                code = (std::uint16_t)counts[i];
+            } else {
+                std::uint8_t value[4];
+                put_u32(value, (std::uint32_t)counts[i]);
+                overflow.insert(overflow.end(), value, value + 4);
+            }
+            const std::int16_t delta = (std::int16_t)(std::uint16_t)(code - previous);
+            const std::uint16_t zigzag = (std::uint16_t)((std::uint16_t)delta << 1 ^ (std::uint16_t)(delta >> 15));
+            low[i] = (std::uint8_t)zigzag;
+            high[i] = (std::uint8_t)(zigzag >> 8);
+            previous = code;
+        }
+    }
+    raw.insert(raw.end(), overflow.begin(), overflow.end());
+}
+
+// Undoes pack_block(). Returns false if the overflow list doesn't match the escapes.
+static bool unpack_block(const std::vector<std::uint8_t>& raw, std::size_t count, int width, int* counts) {
+    const std::uint8_t* low = raw.data();
+    const std::uint8_t* high = raw.data() + count;
+    const std::uint8_t* overflow = raw.data() + 2 * count;
+    const std::uint8_t* overflow_end = raw.data() + raw.size();
+    for (std::size_t row = 0; row < count; row += width) {
+        std::uint16_t previous = 0;
+        for (std::size_t i = row; i < row + width; ++i) {
+            const std::uint16_t zigzag = (std::uint16_t)(low[i] | high[i] << 8);
+            const std::uint16_t delta = (std::uint16_t)((zigzag >> 1) ^ (std::uint16_t)-(zigzag & 1));
+            const std::uint16_t code = (std::uint16_t)(previous + delta);
+            if (code == ITERATION_MAP_ESCAPE) {
+                if (overflow_end - overflow < 4) {
+                    return false;
+                }
+                counts[i] = (int)get_u32(overflow);
+                overflow += 4;
+            } else {
+                counts[i] = code;
+            }
+            previous = code;
+        }
+    }
+    return overflow == overflow_end;
+}
+
+// --- Writer ---
+
+IterationMapWriter::~IterationMapWriter() {
+    if (is_open) {
+        close();
+    }
+}
+
+bool IterationMapWriter::open(const std::string& path, int width, int height, int max_iterations) {
+    if (width <= 0 || width > MAX_WIDTH || height <= 0) {
+        std::cerr << "Error: an iteration map can't be " << width << "x" << height << std::endl;
+        return false;
+    }
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Error: could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+    this->path = path;
+    this->width = width;
+    this->height = height;
+    rows_written = 0;
+    pending.clear();
+    index.clear();
+
+    std::uint8_t header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, 4);
+    put_u32(header + 4, VERSION);
+    put_u32(header + 8, (std::uint32_t)width);
+    put_u32(header + 12, (std::uint32_t)height);
+    put_u32(header + 16, (std::uint32_t)max_iterations);
+    put_u32(header + 20, (std::uint32_t)ITERATION_MAP_BLOCK_ROWS);
+    // The index offset and block count (bytes 24..35) are filled in by close().
+    file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    offset = HEADER_SIZE;
+    is_open = true;
+    return (bool)file;
+}
+
+bool IterationMapWriter::write_rows(const int* counts, int rows) {
+    if (!is_open || rows < 0 || rows > height - rows_written) {
+        std::cerr << "Error: too many rows for the iteration map " << path << std::endl;
+        return false;
+    }
+    while (rows > 0) {
+        const int pending_rows = (int)(pending.size() / width);
+        const int take = std::min(rows, ITERATION_MAP_BLOCK_ROWS - pending_rows);
+        pending.insert(pending.end(), counts, counts + (std::size_t)take * width);
+        counts += (std::size_t)take * width;
+        rows -= take;
+        rows_written += take;
+        if (pending_rows + take == ITERATION_MAP_BLOCK_ROWS && !flush_block()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IterationMapWriter::flush_block() {
+    if (pending.empty()) {
+        return true;
+    }
+    std::vector<std::uint8_t> raw;
+    pack_block(pending.data(), pending.size(), width, raw);
+    std::vector<std::uint8_t> compressed;
+    iteration_map_compress(raw.data(), raw.size(), compressed);
+
+    index.push_back(BlockEntry{offset, (std::uint32_t)compressed.size(), (std::uint32_t)raw.size()});
+    file.write(reinterpret_cast<const char*>(compressed.data()), (std::streamsize)compressed.size());
+    offset += compressed.size();
+    pending.clear();
+    if (!file) {
+        std::cerr << "Error: could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool IterationMapWriter::close() {
+    if (!is_open) {
+        return false;
+    }
+    is_open = false;
+    if (rows_written != height) {
+        std::cerr << "Error: " << path << " got " << rows_written << " of " << height << " rows" << std::endl;
+        file.close();
+        return false;
+    }
+    if (!flush_block()) {
+        file.close();
+        return false;
+    }
+
+    const std::uint64_t index_offset = offset;
+    std::vector<std::uint8_t> entries(index.size() * INDEX_ENTRY_SIZE);
+    for (std::size_t b = 0; b < index.size(); ++b) {
+        put_u64(&entries[b * INDEX_ENTRY_SIZE], index[b].offset);
+        put_u32(&entries[b * INDEX_ENTRY_SIZE + 8], index[b].compressed_size);
+        put_u32(&entries[b * INDEX_ENTRY_SIZE + 12], index[b].raw_size);
+    }
+    file.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)entries.size());
+    offset += entries.size();
+
+    std::uint8_t location[12];
+    put_u64(location, index_offset);
+    put_u32(location + 8, (std::uint32_t)index.size());
+    file.seekp(INDEX_OFFSET_POSITION);
+    file.write(reinterpret_cast<const char*>(location), sizeof(location));
+    file.close();
+    if (!file) {
+        std::cerr << "Error: could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Reader ---
+
+IterationMapReader::~IterationMapReader() {
+    release();
+}
+
+void IterationMapReader::release() {
+#ifdef DP_HAVE_MMAP
+    if (mapping != nullptr) {
+        munmap(mapping, (std::size_t)size);
+    }
+#endif
+    mapping = nullptr;
+    data = nullptr;
+    size = 0;
+    buffer.clear();
+    index.clear();
+}
+
+// Whether 'raw_size' can be the raw size of a block of 'count' pixels: both byte planes, and a
+// whole number of overflow values, at most one per pixel.
+static bool raw_size_fits(std::uint64_t raw_size, std::uint64_t count) {
+    return raw_size >= 2 * count && raw_size <= 6 * count && (raw_size - 2 * count) % 4 == 0;
+}
+
+bool IterationMapReader::open(const std::string& path, bool map) {
+    release();
+    this->path = path;
+
+#ifdef DP_HAVE_MMAP
+    if (map) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (fd >= 0 && fstat(fd, &status) == 0 && status.st_size > 0) {
+            void* mapped = mmap(nullptr, (std::size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                mapping = mapped;
+                data = static_cast<const std::uint8_t*>(mapped);
+                size = (std::uint64_t)status.st_size;
+            }
+        }
+        if (fd >= 0) {
+            ::close(fd); // The mapping stays valid without the descriptor.
+        }
+    }
+#else
+    (void)map;
+#endif
+    if (data == nullptr) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: could not open " << path << std::endl;
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, 4) != 0 || get_u32(data + 4) != VERSION) {
+        std::cerr << "Error: " << path << " is not an iteration map" << std::endl;
+        release();
+        return false;
+    }
+    const std::uint32_t width = get_u32(data + 8);
+    const std::uint32_t height = get_u32(data + 12);
+    const std::uint32_t block_rows = get_u32(data + 20);
+    const std::uint64_t index_offset = get_u64(data + 24);
+    const std::uint32_t blocks = get_u32(data + 32);
+    const bool valid = width > 0 && width <= (std::uint32_t)MAX_WIDTH && height > 0 && height <= 0x7fffffff &&
+                       block_rows == (std::uint32_t)ITERATION_MAP_BLOCK_ROWS &&
+                       blocks == (height + block_rows - 1) / block_rows && index_offset <= size &&
+                       (size - index_offset) / INDEX_ENTRY_SIZE >= blocks;
+    if (!valid) {
+        std::cerr << "Error: " << path << " is not a complete iteration map" << std::endl;
+        release();
+        return false;
+    }
+    map_width = (int)width;
+    map_height = (int)height;
+    map_max_iterations = (int)get_u32(data + 16);
+
+    for (std::uint32_t b = 0; b < blocks; ++b) {
+        const std::uint8_t* entry = data + index_offset + (std::uint64_t)b * INDEX_ENTRY_SIZE;
+        BlockEntry block = {get_u64(entry), get_u32(entry + 8), get_u32(entry + 12)};
+        // The raw size is trusted only as far as the block's pixels allow: two byte planes plus
+        // at most one 4-byte overflow value per pixel, so a damaged index can't make read_block()
+        // allocate more than 6 bytes per pixel.
+        const std::uint64_t count = (std::uint64_t)(std::min((b + 1) * block_rows, height) - b * block_rows) * width;
+        if (block.offset > index_offset || block.compressed_size > index_offset - block.offset ||
+            !raw_size_fits(block.raw_size, count)) {
+            std::cerr << "Error: " << path << " has a damaged block index" << std::endl;
+            release();
+            return false;
+        }
+        index.push_back(block);
+    }
+    return true;
+}
+
+int IterationMapReader::block_end_row(int block) const {
+    return std::min((block + 1) * ITERATION_MAP_BLOCK_ROWS, map_height);
+}
+
+bool IterationMapReader::read_block(int block, std::vector<int>& counts) const {
+    const BlockEntry& entry = index[block];
+    const std::size_t count = (std::size_t)(block_end_row(block) - block * ITERATION_MAP_BLOCK_ROWS) * map_width;
+    if (!raw_size_fits(entry.raw_size, count)) { // Checked by open() too; never allocate blindly.
+        std::cerr << "Error: block " << block << " of " << path << " is damaged" << std::endl;
+        return false;
+    }
+    std::vector<std::uint8_t> raw(entry.raw_size);
+    counts.resize(count);
+    if (!iteration_map_decompress(data + entry.offset, entry.compressed_size, raw.data(), raw.size()) ||
+        !unpack_block(raw, count, map_width, counts.data())) {
+        std::cerr << "Error: block " << block << " of " << path << " is damaged" << std::endl;
+        return false;
+    }
+    return true;
+}
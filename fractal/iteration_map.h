@@ -0,0 +1,124 @@
+// A compact file format for iteration counts ("iteration maps"), so renders can be archived and
+// colored again later without iterating a single point again.
+//
+// As plain ints a 16384 x 16384 map takes 1 GiB. Here the counts go through four steps:
+//   1. 16 bits instead of 32: counts below ITERATION_MAP_ESCAPE are stored as uint16. Larger
+//      ones (and negative ones) are stored as ITERATION_MAP_ESCAPE, and their full value is
+//      appended to the block's overflow list.
+//   2. Delta coding: each 16-bit code is replaced by its difference to the pixel on its left,
+//      zigzagged so small steps either way become small numbers. Neighbouring counts are
+//      similar, so most values end up near 0, and flat regions become runs of zeros.
+//   3. Byte planes: all the low bytes of a block come first, then all the high bytes (nearly
+//      all zero after step 2).
+//   4. A fast LZ77 compressor in the style of LZ4. A run comes out as one match at distance 1
+//      (run-length coding for free) and repeated structure as matches further back; decoding is
+//      little more than a copy loop.
+//
+// The map is split into blocks of ITERATION_MAP_BLOCK_ROWS rows, each compressed on its own and
+// listed in an index at the end of the file. The writer only ever holds one block, and a reader
+// can decode any block without touching the others, so coloring passes stream through a map
+// (or split it across threads) one band of rows at a time. The reader memory-maps the file
+// where the platform allows, so only the blocks actually decoded are read from disk.
+
+#pragma once
+
+#include <cstdint> // For the encoded bytes
+#include <fstream> // For the writer's output file
+#include <string>  // For file names
+#include <vector>  // For blocks and the index
+
+const int ITERATION_MAP_BLOCK_ROWS = 64;
+const std::uint16_t ITERATION_MAP_ESCAPE = 0xFFFF;
+
+// Writes an iteration map row by row. Every function prints an error and returns false on
+// failure (after which the file is incomplete and should be discarded).
+class IterationMapWriter {
+public:
+    IterationMapWriter() = default;
+    ~IterationMapWriter(); // Calls close() if it hasn't been.
+    IterationMapWriter(const IterationMapWriter&) = delete;
+    IterationMapWriter& operator=(const IterationMapWriter&) = delete;
+
+    bool open(const std::string& path, int width, int height, int max_iterations);
+
+    // Appends 'rows' rows of counts ('rows' * width values, row by row). Rows can be handed in
+    // in any portions; they are compressed and written whenever a block is full.
+    bool write_rows(const int* counts, int rows);
+
+    // Writes the last block and the index. Fails if fewer than 'height' rows were written.
+    bool close();
+
+    // Bytes written so far (the whole file once closed).
+    std::uint64_t bytes_written() const { return offset; }
+
+private:
+    bool flush_block();
+
+    struct BlockEntry {
+        std::uint64_t offset;
+        std::uint32_t compressed_size;
+        std::uint32_t raw_size;
+    };
+
+    std::ofstream file;
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int rows_written = 0;
+    std::vector<int> pending; // Rows of the block being filled.
+    std::vector<BlockEntry> index;
+    std::uint64_t offset = 0;
+    bool is_open = false;
+};
+
+// Reads an iteration map. Once open() has succeeded, read_block() may be called from several
+// threads at once.
+class IterationMapReader {
+public:
+    IterationMapReader() = default;
+    ~IterationMapReader();
+    IterationMapReader(const IterationMapReader&) = delete;
+    IterationMapReader& operator=(const IterationMapReader&) = delete;
+
+    // Opens 'path', memory-mapped if 'map' is set and the platform supports it, otherwise read
+    // into memory whole. Prints an error and returns false if it isn't a valid iteration map.
+    bool open(const std::string& path, bool map = true);
+
+    int width() const { return map_width; }
+    int height() const { return map_height; }
+    int max_iterations() const { return map_max_iterations; }
+    int block_count() const { return (int)index.size(); }
+
+    // Block b holds rows [b * ITERATION_MAP_BLOCK_ROWS, block_end_row(b)).
+    int block_end_row(int block) const;
+
+    // Decodes one block into 'counts' (resized to its rows * width). Prints an error and
+    // returns false if the block is corrupt.
+    bool read_block(int block, std::vector<int>& counts) const;
+
+private:
+    struct BlockEntry {
+        std::uint64_t offset;
+        std::uint32_t compressed_size;
+        std::uint32_t raw_size;
+    };
+
+    void release();
+
+    std::string path;
+    const std::uint8_t* data = nullptr; // The whole file, mapped or in 'buffer'.
+    std::uint64_t size = 0;
+    void* mapping = nullptr; // Non-null if 'data' is a memory mapping.
+    std::vector<std::uint8_t> buffer;
+    std::vector<BlockEntry> index;
+    int map_width = 0;
+    int map_height = 0;
+    int map_max_iterations = 0;
+};
+
+// The LZ step on its own: appends the compressed form of in[0, size) to 'out'.
+void iteration_map_compress(const std::uint8_t* in, std::size_t size, std::vector<std::uint8_t>& out);
+
+// Decompresses in[0, size) into exactly 'out_size' bytes at 'out'. Returns false if the input is
+// corrupt or doesn't decompress to exactly that size.
+bool iteration_map_decompress(const std::uint8_t* in, std::size_t size, std::uint8_t* out, std::size_t out_size);
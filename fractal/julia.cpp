@@ -0,0 +1,344 @@
+#include "fractal/julia.h"
+
+#include <algorithm> // For std::max
+#include <cmath>     // For std::hypot
+#include <vector>    // For one row of starting points
+
+int julia_iterations(std::complex<double> c, std::complex<double> z0, int max_iterations) {
+    // c: The constant complex number defining the specific Julia set.
+    // z0: The initial complex number representing the pixel's position in the complex plane.
+    // max_iterations: The maximum number of iterations to perform before assuming the point is within the set.
+
+    std::complex<double> z = z0; // Initialize z with the starting point.
+
+    for (int i = 0; i < max_iterations; ++i) {
+        // The core Julia set iteration: z = z*z + c
+        // This is the complex function that generates the fractal pattern.
+        z = z * z + c;
+
+        // Check if the magnitude of z has exceeded a certain threshold (e.g., 2.0).
+        // If it exceeds the threshold, the point is considered to "escape" and is not part of the set.
+        if (std::norm(z) > 4.0) { // std::norm(z) calculates the squared magnitude of z.
+            return i; // Return the number of iterations it took to escape.
+        }
+    }
+    return max_iterations; // If the point didn't escape within max_iterations, it's considered inside the set.
+}
+
+int julia_iterations_blocked(std::complex<double> c, std::complex<double> z0, int max_iterations) {
+    if (std::norm(c) > 4.0) {
+        return julia_iterations(c, z0, max_iterations); // An escaped z could come back; see julia.h.
+    }
+
+    // Plain doubles instead of std::complex: the same arithmetic (z*z + c, and norm as
+    // re*re + im*im), minus the NaN/infinity fix-ups complex multiplication has to check for.
+    const double cr = c.real();
+    const double ci = c.imag();
+    double zr = z0.real();
+    double zi = z0.imag();
+
+    int i = 0;
+    for (; i + JULIA_CHECK_INTERVAL <= max_iterations; i += JULIA_CHECK_INTERVAL) {
+        const double savedR = zr;
+        const double savedI = zi;
+        for (int k = 0; k < JULIA_CHECK_INTERVAL; ++k) {
+            const double r = zr * zr - zi * zi + cr;
+            zi = zr * zi + zi * zr + ci;
+            zr = r;
+        }
+        // Written as !(<= 4) so that a z that grew to infinity or NaN also counts as escaped.
+        if (!(zr * zr + zi * zi <= 4.0)) {
+            // Escaped somewhere in this block: replay it with a check after every iteration.
+            zr = savedR;
+            zi = savedI;
+            for (int k = 0; k < JULIA_CHECK_INTERVAL; ++k) {
+                const double r = zr * zr - zi * zi + cr;
+                zi = zr * zi + zi * zr + ci;
+                zr = r;
+                if (zr * zr + zi * zi > 4.0) {
+                    return i + k;
+                }
+            }
+            // Only reached if z0 itself was NaN: julia_iterations() never sees that escape.
+        }
+    }
+
+    // The last few iterations that don't fill a whole block.
+    for (; i < max_iterations; ++i) {
+        const double r = zr * zr - zi * zi + cr;
+        zi = zr * zi + zi * zr + ci;
+        zr = r;
+        if (zr * zr + zi * zi > 4.0) {
+            return i;
+        }
+    }
+    return max_iterations;
+}
+
+// The rest of a point's iterations, one at a time, from z = (zr, zi) at iteration 'i'.
+static int finish_iterations(double cr, double ci, double zr, double zi, int i, int max_iterations) {
+    for (; i < max_iterations; ++i) {
+        const double r = zr * zr - zi * zi + cr;
+        zi = zr * zi + zi * zr + ci;
+        zr = r;
+        if (zr * zr + zi * zi > 4.0) {
+            return i;
+        }
+    }
+    return max_iterations;
+}
+
+void julia_iterations_batch(std::complex<double> c, const std::complex<double>* z0, int* iterations,
+                            int count, int max_iterations) {
+    if (std::norm(c) > 4.0) {
+        for (int p = 0; p < count; ++p) {
+            iterations[p] = julia_iterations(c, z0[p], max_iterations);
+        }
+        return;
+    }
+
+    const double cr = c.real();
+    const double ci = c.imag();
+    const int L = JULIA_BATCH_LANES;
+
+    // Per lane: current z, z saved at the start of the block, iterations done, and which point
+    // it is working on (-1: idle, once all points have been handed out).
+    double zr[L], zi[L], savedR[L], savedI[L];
+    int done[L], point[L];
+    int nextPoint = 0;
+    int busy = 0;
+
+    // Gives lane 'l' the next point that needs at least one full block; points with fewer
+    // iterations left than that are finished on the spot.
+    auto refill = [&](int l) {
+        while (nextPoint < count) {
+            int p = nextPoint++;
+            if (JULIA_CHECK_INTERVAL > max_iterations) {
+                iterations[p] = finish_iterations(cr, ci, z0[p].real(), z0[p].imag(), 0, max_iterations);
+                continue;
+            }
+            zr[l] = z0[p].real();
+            zi[l] = z0[p].imag();
+            done[l] = 0;
+            point[l] = p;
+            ++busy;
+            return;
+        }
+        zr[l] = 0.0; // Idle lanes keep computing (harmlessly) so the block loop stays uniform.
+        zi[l] = 0.0;
+        point[l] = -1;
+    };
+    for (int l = 0; l < L; ++l) {
+        refill(l);
+    }
+
+    while (busy > 0) {
+        // One block for every lane, with no branches: L independent chains to overlap.
+        for (int l = 0; l < L; ++l) {
+            savedR[l] = zr[l];
+            savedI[l] = zi[l];
+        }
+        for (int k = 0; k < JULIA_CHECK_INTERVAL; ++k) {
+            for (int l = 0; l < L; ++l) {
+                const double r = zr[l] * zr[l] - zi[l] * zi[l] + cr;
+                zi[l] = zr[l] * zi[l] + zi[l] * zr[l] + ci;
+                zr[l] = r;
+            }
+        }
+
+        // Check each lane once per block.
+        for (int l = 0; l < L; ++l) {
+            if (point[l] < 0) {
+                continue;
+            }
+            int result = -1;
+            if (!(zr[l] * zr[l] + zi[l] * zi[l] <= 4.0)) {
+                // Escaped inside the block: replay it from the saved z to find the exact iteration.
+                // (If nothing escapes in the replay, z0 was NaN; like julia_iterations(), keep going.)
+                result = finish_iterations(cr, ci, savedR[l], savedI[l], done[l],
+                                           done[l] + JULIA_CHECK_INTERVAL);
+                if (result == done[l] + JULIA_CHECK_INTERVAL) {
+                    result = -1;
+                }
+            }
+            if (result < 0) {
+                done[l] += JULIA_CHECK_INTERVAL;
+                if (done[l] + JULIA_CHECK_INTERVAL > max_iterations) {
+                    // Not enough iterations left for another block: finish one by one.
+                    result = finish_iterations(cr, ci, zr[l], zi[l], done[l], max_iterations);
+                }
+            }
+            if (result >= 0) {
+                iterations[point[l]] = result;
+                --busy;
+                refill(l);
+            }
+        }
+    }
+}
+
+// --- Deep zooms: double-double precision ---
+
+// One iteration z = z*z + c in double-double: (zr + zi i)^2 = zr^2 - zi^2 + 2 zr zi i.
+static inline void dd_iterate(DoubleDouble& zr, DoubleDouble& zi, DoubleDouble cr, DoubleDouble ci) {
+    DoubleDouble r = dd_sqr(zr) - dd_sqr(zi) + cr;
+    zi = dd_twice(zr * zi) + ci;
+    zr = r;
+}
+
+// Unlike julia_iterations(), a z that overflowed has turned into NaN here (inf - inf inside the
+// error terms), so "not provably inside |z| <= 2" is what counts as escaped.
+static inline bool dd_escaped(DoubleDouble zr, DoubleDouble zi) {
+    return !(zr.hi * zr.hi + zi.hi * zi.hi <= 4.0);
+}
+
+static int finish_iterations_dd(DoubleDouble cr, DoubleDouble ci, DoubleDouble zr, DoubleDouble zi, int i,
+                                int max_iterations) {
+    for (; i < max_iterations; ++i) {
+        dd_iterate(zr, zi, cr, ci);
+        if (dd_escaped(zr, zi)) {
+            return i;
+        }
+    }
+    return max_iterations;
+}
+
+int julia_iterations_dd(std::complex<double> c, DoubleDoubleComplex z0, int max_iterations) {
+    return finish_iterations_dd(dd_from(c.real()), dd_from(c.imag()), z0.re, z0.im, 0, max_iterations);
+}
+
+void julia_iterations_dd_batch(std::complex<double> c, const DoubleDoubleComplex* z0, int* iterations,
+                               int count, int max_iterations) {
+    const DoubleDouble cr = dd_from(c.real());
+    const DoubleDouble ci = dd_from(c.imag());
+    if (std::norm(c) > 4.0) {
+        // An escaped z could come back inside the block; see julia_iterations_blocked().
+        for (int p = 0; p < count; ++p) {
+            iterations[p] = finish_iterations_dd(cr, ci, z0[p].re, z0[p].im, 0, max_iterations);
+        }
+        return;
+    }
+
+    const int L = JULIA_BATCH_LANES;
+
+    // The same lane bookkeeping as julia_iterations_batch(), with z split into hi and lo arrays.
+    double rHi[L], rLo[L], iHi[L], iLo[L];
+    DoubleDouble savedR[L], savedI[L];
+    int done[L], point[L];
+    int nextPoint = 0;
+    int busy = 0;
+
+    auto refill = [&](int l) {
+        while (nextPoint < count) {
+            int p = nextPoint++;
+            if (JULIA_CHECK_INTERVAL > max_iterations) {
+                iterations[p] = finish_iterations_dd(cr, ci, z0[p].re, z0[p].im, 0, max_iterations);
+                continue;
+            }
+            rHi[l] = z0[p].re.hi;
+            rLo[l] = z0[p].re.lo;
+            iHi[l] = z0[p].im.hi;
+            iLo[l] = z0[p].im.lo;
+            done[l] = 0;
+            point[l] = p;
+            ++busy;
+            return;
+        }
+        rHi[l] = rLo[l] = iHi[l] = iLo[l] = 0.0;
+        point[l] = -1;
+    };
+    for (int l = 0; l < L; ++l) {
+        refill(l);
+    }
+
+    while (busy > 0) {
+        for (int l = 0; l < L; ++l) {
+            savedR[l] = DoubleDouble{rHi[l], rLo[l]};
+            savedI[l] = DoubleDouble{iHi[l], iLo[l]};
+        }
+        for (int k = 0; k < JULIA_CHECK_INTERVAL; ++k) {
+            for (int l = 0; l < L; ++l) {
+                DoubleDouble zr{rHi[l], rLo[l]};
+                DoubleDouble zi{iHi[l], iLo[l]};
+                dd_iterate(zr, zi, cr, ci);
+                rHi[l] = zr.hi;
+                rLo[l] = zr.lo;
+                iHi[l] = zi.hi;
+                iLo[l] = zi.lo;
+            }
+        }
+
+        for (int l = 0; l < L; ++l) {
+            if (point[l] < 0) {
+                continue;
+            }
+            int result = -1;
+            if (dd_escaped(DoubleDouble{rHi[l], rLo[l]}, DoubleDouble{iHi[l], iLo[l]})) {
+                // NaN stays NaN, so the replay always finds the escape.
+                result = finish_iterations_dd(cr, ci, savedR[l], savedI[l], done[l], done[l] + JULIA_CHECK_INTERVAL);
+            } else {
+                done[l] += JULIA_CHECK_INTERVAL;
+                if (done[l] + JULIA_CHECK_INTERVAL > max_iterations) {
+                    result = finish_iterations_dd(cr, ci, DoubleDouble{rHi[l], rLo[l]},
+                                                  DoubleDouble{iHi[l], iLo[l]}, done[l], max_iterations);
+                }
+            }
+            if (result >= 0) {
+                iterations[point[l]] = result;
+                --busy;
+                refill(l);
+            }
+        }
+    }
+}
+
+FractalPrecision choose_fractal_precision(double pixel_spacing, double center_magnitude) {
+    double scale = std::max(center_magnitude, 2.0);
+    if (pixel_spacing >= DOUBLE_MIN_PIXEL_SPACING * scale) {
+        return FractalPrecision::Double;
+    }
+    return FractalPrecision::DoubleDouble;
+}
+
+FractalPrecision julia_view_precision(const JuliaView& view) {
+    double magnitude = std::hypot(dd_to_double(view.center_real), dd_to_double(view.center_imag));
+    return choose_fractal_precision(view.pixel_spacing, magnitude);
+}
+
+void julia_render_rows(std::complex<double> c, const JuliaView& view, int row_begin, int row_end,
+                       int max_iterations, int* iterations) {
+    julia_render_band(c, view, row_begin, row_end, max_iterations, iterations + (long long)row_begin * view.width);
+}
+
+void julia_render_band(std::complex<double> c, const JuliaView& view, int row_begin, int row_end,
+                       int max_iterations, int* band) {
+    const double halfWidth = 0.5 * view.width;
+    const double halfHeight = 0.5 * view.height;
+
+    if (julia_view_precision(view) == FractalPrecision::Double) {
+        const double centerReal = dd_to_double(view.center_real);
+        const double centerImag = dd_to_double(view.center_imag);
+        std::vector<std::complex<double>> row(view.width);
+        for (int y = row_begin; y < row_end; ++y) {
+            const double imag = centerImag + (y - halfHeight) * view.pixel_spacing;
+            for (int x = 0; x < view.width; ++x) {
+                row[x] = std::complex<double>(centerReal + (x - halfWidth) * view.pixel_spacing, imag);
+            }
+            julia_iterations_batch(c, row.data(), band + (long long)(y - row_begin) * view.width, view.width,
+                                   max_iterations);
+        }
+        return;
+    }
+
+    // The offset from the centre, (x - width/2) * spacing, is computed exactly with two_prod(),
+    // so neighbouring pixels differ by exactly one spacing however deep the view is.
+    std::vector<DoubleDoubleComplex> row(view.width);
+    for (int y = row_begin; y < row_end; ++y) {
+        const DoubleDouble imag = view.center_imag + two_prod(y - halfHeight, view.pixel_spacing);
+        for (int x = 0; x < view.width; ++x) {
+            row[x] = DoubleDoubleComplex{view.center_real + two_prod(x - halfWidth, view.pixel_spacing), imag};
+        }
+        julia_iterations_dd_batch(c, row.data(), band + (long long)(y - row_begin) * view.width, view.width,
+                                  max_iterations);
+    }
+}
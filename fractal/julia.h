@@ -0,0 +1,94 @@
+// The escape-time core of the Julia set renderer (cpp_learning_274dfc.cpp).
+// It lives in its own library so benchmarks and other tools can render fractals
+// without pulling in SFML.
+
+#pragma once
+
+#include <complex> // Include the complex number library for easy handling of complex numbers.
+
+#include "fractal/double_double.h"
+
+// This function calculates the number of iterations it takes for a point
+// to escape a certain boundary when repeatedly applying the Julia set function.
+// This iteration count determines the color of the pixel.
+int julia_iterations(std::complex<double> c, std::complex<double> z0, int max_iterations);
+
+// How many iterations julia_iterations_blocked() runs between escape checks.
+const int JULIA_CHECK_INTERVAL = 8;
+
+// Same result as julia_iterations() for every input.
+// Instead of testing |z| > 2 after every iteration (a compare-and-branch in the middle of the
+// loop), it runs JULIA_CHECK_INTERVAL iterations back to back and checks once.
+// z is saved before each block; if the check finds that z escaped somewhere inside the block,
+// the block is replayed from the saved z one iteration at a time to find the exact iteration.
+// Once |z| > 2 it keeps growing (for |c| <= 2), so an escape inside a block is always still
+// visible at its end; for |c| > 2 this doesn't hold and it falls back to julia_iterations().
+int julia_iterations_blocked(std::complex<double> c, std::complex<double> z0, int max_iterations);
+
+// julia_iterations_blocked() for many points at once: iterations[i] receives the result for
+// z0[i], exactly as julia_iterations() would compute it.
+// One point's iterations form a single dependency chain (every step needs the previous z), so a
+// lone point keeps the CPU waiting on multiply/add latency. Here JULIA_BATCH_LANES points run
+// their branch-free blocks side by side, giving the CPU independent work to overlap (and the
+// compiler lanes to put into SIMD registers). A lane whose point has finished is refilled with
+// the next point right away, so fast and slow points don't hold each other up.
+const int JULIA_BATCH_LANES = 4;
+void julia_iterations_batch(std::complex<double> c, const std::complex<double>* z0, int* iterations,
+                            int count, int max_iterations);
+
+// --- Deep zooms: double-double precision ---
+
+// julia_iterations() with double-double arithmetic (see fractal/double_double.h), for views whose
+// pixels are too close together for double. The escape test uses only the high parts: whether
+// |z| crossed 2 a few ulps earlier or later doesn't matter, and it keeps the test cheap.
+int julia_iterations_dd(std::complex<double> c, DoubleDoubleComplex z0, int max_iterations);
+
+// julia_iterations_dd() for many points at once, exactly as it would compute each of them.
+// Works like julia_iterations_batch(): JULIA_BATCH_LANES points iterate side by side in
+// branch-free blocks of JULIA_CHECK_INTERVAL, with a replay to find the exact escape iteration.
+// The lanes are stored as separate hi/lo arrays so the compiler can put them into SIMD registers
+// (and the products into fused multiply-adds, when the CPU has them).
+void julia_iterations_dd_batch(std::complex<double> c, const DoubleDoubleComplex* z0, int* iterations,
+                               int count, int max_iterations);
+
+// Which arithmetic a view needs. Each tier is several times slower than the one before, so the
+// cheapest one that still resolves the pixels is picked.
+enum class FractalPrecision {
+    Double,       // Up to pixel spacings of about 1e-13.
+    DoubleDouble, // Down to about 1e-28; deeper zooms would need perturbation methods.
+};
+
+// The smallest pixel spacing (relative to the size of the coordinates) each tier still renders
+// cleanly. Double has ~16 digits, but the iteration amplifies rounding errors, so it gives up a
+// few digits early; the same margin is kept for double-double's ~32 digits.
+const double DOUBLE_MIN_PIXEL_SPACING = 1e-13;
+const double DOUBLE_DOUBLE_MIN_PIXEL_SPACING = 1e-28;
+
+// Picks the tier for pixels 'pixel_spacing' apart around a point of magnitude 'center_magnitude'.
+// Orbits wander over |z| <= 2 whatever the centre is, so magnitudes below 2 count as 2.
+FractalPrecision choose_fractal_precision(double pixel_spacing, double center_magnitude);
+
+// A window onto the complex plane, 'width' x 'height' pixels of 'pixel_spacing' each.
+// The centre is double-double so that deep views can be placed more precisely than a double can.
+// Pixel (x, y) is at center + ((x - width/2) + (y - height/2) i) * pixel_spacing.
+struct JuliaView {
+    DoubleDouble center_real;
+    DoubleDouble center_imag;
+    double pixel_spacing;
+    int width;
+    int height;
+};
+
+// The tier choose_fractal_precision() picks for this view.
+FractalPrecision julia_view_precision(const JuliaView& view);
+
+// Computes the iteration counts of rows [row_begin, row_end) of the view, in the precision
+// julia_view_precision() picks. 'iterations' holds the whole view (width * height counts, row by
+// row); only the given rows are written, so threads can render separate rows into one buffer.
+void julia_render_rows(std::complex<double> c, const JuliaView& view, int row_begin, int row_end,
+                       int max_iterations, int* iterations);
+
+// julia_render_rows() into a buffer holding just those rows: row y goes to
+// band + (y - row_begin) * width. For renders too large to keep whole, made a band at a time.
+void julia_render_band(std::complex<double> c, const JuliaView& view, int row_begin, int row_end,
+                       int max_iterations, int* band);
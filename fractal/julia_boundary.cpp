@@ -0,0 +1,59 @@
+#include "fractal/julia_boundary.h"
+
+#include <algorithm> // For std::min/std::max
+#include <cmath>     // For floor
+
+long long julia_boundary(std::complex<double> c, const JuliaView& view, int max_visits,
+                         std::vector<std::uint8_t>& visits) {
+    const int width = view.width;
+    const int height = view.height;
+    const std::uint8_t limit = (std::uint8_t)std::min(std::max(max_visits, 1), 255);
+    visits.assign((std::size_t)width * height, 0);
+
+    // Pixel (x, y) is at center + (x - width/2, y - height/2) * spacing; these undo that.
+    const double center_real = dd_to_double(view.center_real);
+    const double center_imag = dd_to_double(view.center_imag);
+    const double inverse_spacing = 1.0 / view.pixel_spacing;
+
+    // The whole set lies within |z| <= radius (further out, z^2 + c only moves outwards), and so
+    // does every preimage; the outside grid covers that square.
+    const double radius = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * std::abs(c)));
+    const double outside_scale = JULIA_BOUNDARY_OUTSIDE_GRID / (2.0 * radius);
+    std::vector<std::uint8_t> outside((std::size_t)JULIA_BOUNDARY_OUTSIDE_GRID * JULIA_BOUNDARY_OUTSIDE_GRID, 0);
+
+    // The fixed points solve z^2 + c = z: z = (1 +- sqrt(1 - 4c)) / 2. The one where the map
+    // stretches more (larger |2z|) is repelling and lies on the boundary.
+    const std::complex<double> root = std::sqrt(1.0 - 4.0 * c);
+    const std::complex<double> beta =
+        std::abs(1.0 + root) >= std::abs(1.0 - root) ? 0.5 * (1.0 + root) : 0.5 * (1.0 - root);
+
+    std::vector<std::complex<double>> stack = {beta};
+    long long visited = 0;
+    while (!stack.empty()) {
+        const std::complex<double> z = stack.back();
+        stack.pop_back();
+        ++visited;
+
+        // Count the visit in the view's pixel, or in the outside grid's cell.
+        std::uint8_t* count;
+        const double px = std::floor((z.real() - center_real) * inverse_spacing + 0.5 * width + 0.5);
+        const double py = std::floor((z.imag() - center_imag) * inverse_spacing + 0.5 * height + 0.5);
+        if (px >= 0.0 && px < width && py >= 0.0 && py < height) {
+            count = &visits[(std::size_t)py * width + (std::size_t)px];
+        } else {
+            const int last = JULIA_BOUNDARY_OUTSIDE_GRID - 1;
+            const int ox = std::min(std::max((int)((z.real() + radius) * outside_scale), 0), last);
+            const int oy = std::min(std::max((int)((z.imag() + radius) * outside_scale), 0), last);
+            count = &outside[(std::size_t)oy * JULIA_BOUNDARY_OUTSIDE_GRID + ox];
+        }
+        if (*count >= limit) {
+            continue; // Seen often enough: this branch would only add more hits to known pixels.
+        }
+        ++*count;
+
+        const std::complex<double> preimage = std::sqrt(z - c);
+        stack.push_back(preimage);
+        stack.push_back(-preimage);
+    }
+    return visited;
+}
@@ -0,0 +1,35 @@
+// The boundary of a Julia set by inverse iteration: line art without iterating every pixel.
+//
+// julia_iterations() finds the boundary (the Julia set proper) only indirectly: every pixel is
+// iterated, up to max_iterations for pixels inside, and the boundary is wherever the counts
+// change. But the boundary is also exactly where z -> z^2 + c repels, so running the map
+// *backwards*, z -> +-sqrt(z - c), attracts any starting point onto it. Each point has two
+// preimages, so walking backwards from a point of the set (its repelling fixed point) grows a
+// binary tree whose nodes all lie on the boundary.
+//
+// Plain inverse iteration follows random branches of that tree; it crowds some parts of the
+// boundary with millions of hits while others (deep in cusps) are reached almost never. The
+// modified method used here walks the whole tree depth first, but counts the visits to each
+// pixel and stops expanding a branch at a pixel that already has 'max_visits': the work is
+// then proportional to the number of boundary pixels (times max_visits), not to the image.
+
+#pragma once
+
+#include <complex> // For the constant
+#include <cstdint> // For visit counts
+#include <vector>  // For the visit bitmap
+
+#include "fractal/julia.h"
+
+// Points that fall outside the view are pruned on a coarser grid of this many cells per side,
+// spanning a square that holds the whole set, so views of part of the set still terminate.
+const int JULIA_BOUNDARY_OUTSIDE_GRID = 1024;
+
+// Walks the preimage tree of z -> z^2 + c from its repelling fixed point and counts the visits
+// to each pixel of 'view' in 'visits' (width * height, row by row, saturating at 255; 0: not on
+// the boundary). A branch stops at a pixel already visited 'max_visits' times (1..255): higher
+// values fill in faint parts of the boundary more densely. The centre is used as a double
+// (inverse iteration is for whole sets and moderate zooms, not deep zooms).
+// Returns the number of points visited.
+long long julia_boundary(std::complex<double> c, const JuliaView& view, int max_visits,
+                         std::vector<std::uint8_t>& visits);
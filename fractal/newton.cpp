@@ -0,0 +1,205 @@
+#include "fractal/newton.h"
+
+template <int Degree>
+NewtonPolynomial<Degree> newton_polynomial_from_roots(const std::complex<double>* roots) {
+    // Multiply out (z - r0)(z - r1)... one factor at a time, starting from the constant 1.
+    std::complex<double> coefficients[Degree + 1] = {1.0};
+    for (int k = 0; k < Degree; ++k) {
+        for (int j = k + 1; j > 0; --j) {
+            coefficients[j] = coefficients[j - 1] - roots[k] * coefficients[j];
+        }
+        coefficients[0] = -roots[k] * coefficients[0];
+    }
+
+    NewtonPolynomial<Degree> polynomial;
+    for (int j = 0; j <= Degree; ++j) {
+        polynomial.re[j] = coefficients[j].real();
+        polynomial.im[j] = coefficients[j].imag();
+    }
+    for (int k = 0; k < Degree; ++k) {
+        polynomial.roots[k] = roots[k];
+    }
+    return polynomial;
+}
+
+// One Newton step z -> z - p(z) / p'(z), in plain doubles. Horner's scheme evaluates p and p'
+// together: p = (...(a_n z + a_{n-1}) z + ...) + a_0, and p' picks up each partial p on the way.
+// With Degree known at compile time the loop unrolls completely.
+template <int Degree>
+static inline void newton_step(const NewtonPolynomial<Degree>& polynomial, double& zr, double& zi) {
+    double pr = polynomial.re[Degree];
+    double pi = polynomial.im[Degree];
+    double dr = 0.0;
+    double di = 0.0;
+    for (int k = Degree - 1; k >= 0; --k) {
+        const double ndr = dr * zr - di * zi + pr;
+        di = dr * zi + di * zr + pi;
+        dr = ndr;
+        const double npr = pr * zr - pi * zi + polynomial.re[k];
+        pi = pr * zi + pi * zr + polynomial.im[k];
+        pr = npr;
+    }
+    // p / p', with the division written out: (p * conj(p')) / |p'|^2.
+    const double scale = 1.0 / (dr * dr + di * di);
+    zr -= (pr * dr + pi * di) * scale;
+    zi -= (pi * dr - pr * di) * scale;
+}
+
+// Index of the root z is within NEWTON_TOLERANCE of, or -1.
+template <int Degree>
+static inline int converged_root(const NewtonPolynomial<Degree>& polynomial, double zr, double zi) {
+    int found = -1;
+    for (int k = Degree - 1; k >= 0; --k) {
+        const double dx = zr - polynomial.roots[k].real();
+        const double dy = zi - polynomial.roots[k].imag();
+        found = dx * dx + dy * dy < NEWTON_TOLERANCE * NEWTON_TOLERANCE ? k : found;
+    }
+    return found;
+}
+
+template <int Degree>
+NewtonResult newton_basin(const NewtonPolynomial<Degree>& polynomial, std::complex<double> z0, int max_iterations) {
+    double zr = z0.real();
+    double zi = z0.imag();
+    for (int i = 0; i < max_iterations; ++i) {
+        newton_step(polynomial, zr, zi);
+        int root = converged_root(polynomial, zr, zi);
+        if (root >= 0) {
+            return NewtonResult{i, root};
+        }
+    }
+    return NewtonResult{max_iterations, -1};
+}
+
+template <int Degree>
+void newton_basin_batch(const NewtonPolynomial<Degree>& polynomial, const std::complex<double>* z0,
+                        NewtonResult* results, int count, int max_iterations) {
+    const int L = NEWTON_BATCH_LANES;
+
+    // Per lane: current z, steps done before this block, the first step at which it converged
+    // (-1: not yet) and to which root, and which point it is working on (-1: idle).
+    double zr[L], zi[L];
+    int done[L], first[L], root[L], point[L];
+    int nextPoint = 0;
+    int busy = 0;
+
+    auto refill = [&](int l) {
+        while (nextPoint < count) {
+            int p = nextPoint++;
+            if (max_iterations <= 0) {
+                results[p] = NewtonResult{max_iterations, -1};
+                continue;
+            }
+            zr[l] = z0[p].real();
+            zi[l] = z0[p].imag();
+            done[l] = 0;
+            first[l] = -1;
+            root[l] = -1;
+            point[l] = p;
+            ++busy;
+            return;
+        }
+        zr[l] = 1.0; // Idle lanes keep stepping (harmlessly) so the block loop stays uniform.
+        zi[l] = 0.0;
+        first[l] = -1;
+        point[l] = -1;
+    };
+    for (int l = 0; l < L; ++l) {
+        refill(l);
+    }
+
+    while (busy > 0) {
+        int steps = 0;
+        while (steps < NEWTON_CHECK_INTERVAL) {
+            // newton_step() with the lane loop innermost, so each Horner step is one vector
+            // operation across the lanes.
+            double pr[L], pi[L], dr[L], di[L];
+            for (int l = 0; l < L; ++l) {
+                pr[l] = polynomial.re[Degree];
+                pi[l] = polynomial.im[Degree];
+                dr[l] = 0.0;
+                di[l] = 0.0;
+            }
+            for (int j = Degree - 1; j >= 0; --j) {
+                for (int l = 0; l < L; ++l) {
+                    const double ndr = dr[l] * zr[l] - di[l] * zi[l] + pr[l];
+                    di[l] = dr[l] * zi[l] + di[l] * zr[l] + pi[l];
+                    dr[l] = ndr;
+                    const double npr = pr[l] * zr[l] - pi[l] * zi[l] + polynomial.re[j];
+                    pi[l] = pr[l] * zi[l] + pi[l] * zr[l] + polynomial.im[j];
+                    pr[l] = npr;
+                }
+            }
+            for (int l = 0; l < L; ++l) {
+                const double scale = 1.0 / (dr[l] * dr[l] + di[l] * di[l]);
+                zr[l] -= (pr[l] * dr[l] + pi[l] * di[l]) * scale;
+                zi[l] -= (pi[l] * dr[l] - pr[l] * di[l]) * scale;
+            }
+
+            // Selects instead of branches: only the first convergence of a lane is kept. Newton's
+            // method converges in a handful of steps, so rather than run the whole block, stop
+            // (one branch for all lanes) as soon as any lane has something to hand in.
+            bool any = false;
+            for (int l = 0; l < L; ++l) {
+                const int r = converged_root(polynomial, zr[l], zi[l]);
+                const bool take = first[l] < 0 && r >= 0 && point[l] >= 0;
+                first[l] = take ? done[l] + steps : first[l];
+                root[l] = take ? r : root[l];
+                any |= take;
+            }
+            ++steps;
+            if (any) {
+                break;
+            }
+        }
+
+        for (int l = 0; l < L; ++l) {
+            if (point[l] < 0) {
+                continue;
+            }
+            done[l] += steps;
+            bool converged = first[l] >= 0 && first[l] < max_iterations;
+            if (converged || done[l] >= max_iterations) {
+                results[point[l]] = converged ? NewtonResult{first[l], root[l]} : NewtonResult{max_iterations, -1};
+                --busy;
+                refill(l);
+            }
+        }
+    }
+}
+
+template <int Degree>
+static void newton_basins_for_degree(const std::vector<std::complex<double>>& roots, const std::complex<double>* z0,
+                                     NewtonResult* results, int count, int max_iterations) {
+    NewtonPolynomial<Degree> polynomial = newton_polynomial_from_roots<Degree>(roots.data());
+    newton_basin_batch(polynomial, z0, results, count, max_iterations);
+}
+
+bool newton_basins(const std::vector<std::complex<double>>& roots, const std::complex<double>* z0,
+                   NewtonResult* results, int count, int max_iterations) {
+    switch (roots.size()) {
+    case 2: newton_basins_for_degree<2>(roots, z0, results, count, max_iterations); return true;
+    case 3: newton_basins_for_degree<3>(roots, z0, results, count, max_iterations); return true;
+    case 4: newton_basins_for_degree<4>(roots, z0, results, count, max_iterations); return true;
+    case 5: newton_basins_for_degree<5>(roots, z0, results, count, max_iterations); return true;
+    case 6: newton_basins_for_degree<6>(roots, z0, results, count, max_iterations); return true;
+    case 7: newton_basins_for_degree<7>(roots, z0, results, count, max_iterations); return true;
+    case 8: newton_basins_for_degree<8>(roots, z0, results, count, max_iterations); return true;
+    default: return false;
+    }
+}
+
+// The specializations callers can use directly (the definitions above stay in this file, which
+// is built with the same floating-point settings as the rest of the escape-time core).
+#define DP_NEWTON_INSTANTIATE(Degree)                                                                         \
+    template NewtonPolynomial<Degree> newton_polynomial_from_roots<Degree>(const std::complex<double>*);      \
+    template NewtonResult newton_basin<Degree>(const NewtonPolynomial<Degree>&, std::complex<double>, int);   \
+    template void newton_basin_batch<Degree>(const NewtonPolynomial<Degree>&, const std::complex<double>*,    \
+                                             NewtonResult*, int, int);
+DP_NEWTON_INSTANTIATE(2)
+DP_NEWTON_INSTANTIATE(3)
+DP_NEWTON_INSTANTIATE(4)
+DP_NEWTON_INSTANTIATE(5)
+DP_NEWTON_INSTANTIATE(6)
+DP_NEWTON_INSTANTIATE(7)
+DP_NEWTON_INSTANTIATE(8)
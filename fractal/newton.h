@@ -0,0 +1,59 @@
+// Newton fractals: the basins of attraction of Newton's root-finding method for a polynomial.
+//
+// Where julia_iterations() counts how long a point takes to *escape*, Newton's method
+// z -> z - p(z) / p'(z) makes almost every starting point *converge* to one of the roots of p.
+// Coloring each pixel by the root it reaches (shaded by how many steps it took) shows the
+// basins: large calm regions around each root, separated by an intricate fractal boundary.
+//
+// The polynomial's degree is a template parameter, so p(z) and p'(z) are evaluated by a
+// Horner loop the compiler fully unrolls, with the coefficients in registers. The functions
+// are instantiated for degrees 2..NEWTON_MAX_DEGREE; newton_basins() picks the right one at
+// run time.
+
+#pragma once
+
+#include <complex> // For roots and starting points
+#include <vector>  // For the roots in newton_basins()
+
+const int NEWTON_MAX_DEGREE = 8;
+
+// A point counts as converged once it is this close to a root.
+const double NEWTON_TOLERANCE = 1e-6;
+
+// How many points newton_basin_batch() iterates side by side, and the most steps it takes
+// before handing in finished lanes and refilling them.
+const int NEWTON_BATCH_LANES = 4;
+const int NEWTON_CHECK_INTERVAL = 8;
+
+// The monic polynomial (z - roots[0]) * ... * (z - roots[Degree - 1]).
+template <int Degree>
+struct NewtonPolynomial {
+    double re[Degree + 1]; // Coefficients of z^0 .. z^Degree, split into real and imaginary parts
+    double im[Degree + 1]; // so the batched loop can keep each in its own register.
+    std::complex<double> roots[Degree];
+};
+
+template <int Degree>
+NewtonPolynomial<Degree> newton_polynomial_from_roots(const std::complex<double>* roots);
+
+struct NewtonResult {
+    int iterations; // Steps taken until converged (max_iterations if it never did).
+    int root;       // Index of the root it converged to, or -1.
+};
+
+// Runs Newton's method from z0 for up to max_iterations steps.
+template <int Degree>
+NewtonResult newton_basin(const NewtonPolynomial<Degree>& polynomial, std::complex<double> z0, int max_iterations);
+
+// newton_basin() for many points, with exactly the same results. NEWTON_BATCH_LANES points step
+// together (independent work for the CPU to overlap, and lanes for the compiler to vectorize);
+// each lane notes the first step at which it converged without branching, and as soon as any
+// lane has converged the finished lanes are refilled with the next points.
+template <int Degree>
+void newton_basin_batch(const NewtonPolynomial<Degree>& polynomial, const std::complex<double>* z0,
+                        NewtonResult* results, int count, int max_iterations);
+
+// newton_basin_batch() for the polynomial with the given roots, dispatched to the specialization
+// for its degree. Returns false (leaving 'results' alone) if the degree isn't 2..NEWTON_MAX_DEGREE.
+bool newton_basins(const std::vector<std::complex<double>>& roots, const std::complex<double>* z0,
+                   NewtonResult* results, int count, int max_iterations);
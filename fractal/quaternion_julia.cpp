@@ -0,0 +1,207 @@
+#include "fractal/quaternion_julia.h"
+
+#include <algorithm> // For std::max
+#include <cmath>     // For sqrt and log
+
+// Where finished rays of a packet are parked: so far out that their orbit has escaped before
+// the first iteration, which makes their distance estimate cost next to nothing.
+static const double PARKED_COORDINATE = 1e6;
+
+double quaternion_julia_distance(const QuaternionJulia& fractal, Vec3 point) {
+    const Quaternion c = fractal.c;
+    double qr = point.x;
+    double qi = point.y;
+    double qj = point.z;
+    double qk = fractal.slice;
+    double md = 1.0; // |q'|: the derivative of q -> q^2 + c is 2q, so |q'| grows by 2|q| per step.
+    double r2 = qr * qr + qi * qi + qj * qj + qk * qk;
+    for (int n = 0; n < fractal.max_iterations && r2 <= QJULIA_BAILOUT * QJULIA_BAILOUT; ++n) {
+        md *= 2.0 * std::sqrt(r2);
+        // (r + v)^2 = r^2 - |v|^2 + 2rv for a quaternion with real part r and vector part v.
+        const double two_r = 2.0 * qr;
+        qr = qr * qr - qi * qi - qj * qj - qk * qk + c.r;
+        qi = two_r * qi + c.i;
+        qj = two_r * qj + c.j;
+        qk = two_r * qk + c.k;
+        r2 = qr * qr + qi * qi + qj * qj + qk * qk;
+    }
+    if (!(r2 > QJULIA_BAILOUT * QJULIA_BAILOUT)) {
+        return 0.0; // Never escaped: the point is (as far as we can tell) in the set.
+    }
+    const double r = std::sqrt(r2);
+    return 0.5 * r * std::log(r) / md;
+}
+
+void quaternion_julia_distance_packet(const QuaternionJulia& fractal, const double* x, const double* y,
+                                      const double* z, double* distance) {
+    const int L = QJULIA_PACKET_LANES;
+    const Quaternion c = fractal.c;
+
+    // One array per quaternion component (structure of arrays), so each line of the loop below
+    // is the same operation on every lane.
+    double qr[L], qi[L], qj[L], qk[L], md[L], r2[L];
+    for (int l = 0; l < L; ++l) {
+        qr[l] = x[l];
+        qi[l] = y[l];
+        qj[l] = z[l];
+        qk[l] = fractal.slice;
+        md[l] = 1.0;
+        r2[l] = qr[l] * qr[l] + qi[l] * qi[l] + qj[l] * qj[l] + qk[l] * qk[l];
+    }
+
+    for (int n = 0; n < fractal.max_iterations; ++n) {
+        bool any = false;
+        for (int l = 0; l < L; ++l) {
+            const bool live = r2[l] <= QJULIA_BAILOUT * QJULIA_BAILOUT;
+            any |= live;
+            const double nmd = md[l] * (2.0 * std::sqrt(r2[l]));
+            const double two_r = 2.0 * qr[l];
+            const double nqr = qr[l] * qr[l] - qi[l] * qi[l] - qj[l] * qj[l] - qk[l] * qk[l] + c.r;
+            const double nqi = two_r * qi[l] + c.i;
+            const double nqj = two_r * qj[l] + c.j;
+            const double nqk = two_r * qk[l] + c.k;
+            const double nr2 = nqr * nqr + nqi * nqi + nqj * nqj + nqk * nqk;
+            // Lanes that have escaped keep their values; the others take the new ones.
+            md[l] = live ? nmd : md[l];
+            qr[l] = live ? nqr : qr[l];
+            qi[l] = live ? nqi : qi[l];
+            qj[l] = live ? nqj : qj[l];
+            qk[l] = live ? nqk : qk[l];
+            r2[l] = live ? nr2 : r2[l];
+        }
+        if (!any) {
+            break;
+        }
+    }
+
+    for (int l = 0; l < L; ++l) {
+        if (!(r2[l] > QJULIA_BAILOUT * QJULIA_BAILOUT)) {
+            distance[l] = 0.0;
+        } else {
+            const double r = std::sqrt(r2[l]);
+            distance[l] = 0.5 * r * std::log(r) / md[l];
+        }
+    }
+}
+
+double quaternion_julia_bound(const QuaternionJulia& fractal) {
+    // For |q| > R = (1 + sqrt(1 + 4|c|)) / 2 we have |q^2 + c| >= |q|^2 - |c| > |q|, so such
+    // points only move outwards and escape. The slice cuts that 4D ball in a 3D ball.
+    const Quaternion c = fractal.c;
+    const double c_magnitude = std::sqrt(c.r * c.r + c.i * c.i + c.j * c.j + c.k * c.k);
+    const double radius = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * c_magnitude));
+    const double squared = radius * radius - fractal.slice * fractal.slice;
+    return squared > 0.0 ? std::sqrt(squared) : 0.0;
+}
+
+// Where the ray origin + t * direction is inside the ball of 'radius' around the origin:
+// between t_enter and t_exit. Returns false if it never is.
+static bool bound_interval(double radius, Vec3 origin, Vec3 direction, double& t_enter, double& t_exit) {
+    const double b = origin.x * direction.x + origin.y * direction.y + origin.z * direction.z;
+    const double c = origin.x * origin.x + origin.y * origin.y + origin.z * origin.z - radius * radius;
+    const double discriminant = b * b - c;
+    if (radius <= 0.0 || discriminant < 0.0) {
+        return false;
+    }
+    const double root = std::sqrt(discriminant);
+    t_exit = -b + root;
+    t_enter = std::max(0.0, -b - root);
+    return t_exit >= t_enter;
+}
+
+QuaternionJuliaHit quaternion_julia_march(const QuaternionJulia& fractal, const QuaternionJuliaMarch& march,
+                                          Vec3 origin, Vec3 direction) {
+    QuaternionJuliaHit hit = {false, 0.0, 0};
+    double t, t_exit;
+    if (!bound_interval(quaternion_julia_bound(fractal), origin, direction, t, t_exit)) {
+        return hit;
+    }
+    while (hit.steps < march.max_steps && t <= t_exit) {
+        Vec3 point = {origin.x + t * direction.x, origin.y + t * direction.y, origin.z + t * direction.z};
+        const double distance = quaternion_julia_distance(fractal, point);
+        ++hit.steps;
+        if (distance < t * march.hit_scale) {
+            hit.hit = true;
+            break;
+        }
+        t += distance * march.step_scale;
+    }
+    hit.t = t;
+    return hit;
+}
+
+void quaternion_julia_march_packet(const QuaternionJulia& fractal, const QuaternionJuliaMarch& march, Vec3 origin,
+                                   const Vec3* directions, QuaternionJuliaHit* hits) {
+    const int L = QJULIA_PACKET_LANES;
+    const double radius = quaternion_julia_bound(fractal);
+
+    double t[L], t_exit[L];
+    bool active[L];
+    int remaining = 0;
+    for (int l = 0; l < L; ++l) {
+        hits[l] = QuaternionJuliaHit{false, 0.0, 0};
+        if (!bound_interval(radius, origin, directions[l], t[l], t_exit[l])) {
+            active[l] = false; // Misses the set entirely (hits[l].t stays 0, as in the scalar march).
+            continue;
+        }
+        active[l] = march.max_steps > 0 && t[l] <= t_exit[l];
+        hits[l].t = t[l];
+        remaining += active[l];
+    }
+
+    double x[L], y[L], z[L], distance[L];
+    while (remaining > 0) {
+        for (int l = 0; l < L; ++l) {
+            x[l] = active[l] ? origin.x + t[l] * directions[l].x : PARKED_COORDINATE;
+            y[l] = active[l] ? origin.y + t[l] * directions[l].y : PARKED_COORDINATE;
+            z[l] = active[l] ? origin.z + t[l] * directions[l].z : PARKED_COORDINATE;
+        }
+        quaternion_julia_distance_packet(fractal, x, y, z, distance);
+
+        for (int l = 0; l < L; ++l) {
+            if (!active[l]) {
+                continue;
+            }
+            ++hits[l].steps;
+            if (distance[l] < t[l] * march.hit_scale) {
+                hits[l].hit = true;
+            } else {
+                t[l] += distance[l] * march.step_scale;
+            }
+            if (hits[l].hit || hits[l].steps >= march.max_steps || t[l] > t_exit[l]) {
+                hits[l].t = t[l];
+                active[l] = false;
+                --remaining;
+            }
+        }
+    }
+}
+
+Vec3 quaternion_julia_normal(const QuaternionJulia& fractal, Vec3 point, double epsilon) {
+    // The corners (1,-1,-1), (-1,-1,1), (-1,1,-1), (1,1,1): summing each corner weighted by the
+    // estimate there approximates the gradient with four estimates instead of six.
+    const double kx[QJULIA_PACKET_LANES] = {1.0, -1.0, -1.0, 1.0};
+    const double ky[QJULIA_PACKET_LANES] = {-1.0, -1.0, 1.0, 1.0};
+    const double kz[QJULIA_PACKET_LANES] = {-1.0, 1.0, -1.0, 1.0};
+    double x[QJULIA_PACKET_LANES], y[QJULIA_PACKET_LANES], z[QJULIA_PACKET_LANES], distance[QJULIA_PACKET_LANES];
+    for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+        x[l] = point.x + epsilon * kx[l];
+        y[l] = point.y + epsilon * ky[l];
+        z[l] = point.z + epsilon * kz[l];
+    }
+    quaternion_julia_distance_packet(fractal, x, y, z, distance);
+
+    Vec3 normal = {0.0, 0.0, 0.0};
+    for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+        normal.x += kx[l] * distance[l];
+        normal.y += ky[l] * distance[l];
+        normal.z += kz[l] * distance[l];
+    }
+    const double length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    if (length > 0.0) {
+        normal.x /= length;
+        normal.y /= length;
+        normal.z /= length;
+    }
+    return normal;
+}
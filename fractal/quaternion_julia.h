@@ -0,0 +1,88 @@
+// 3D quaternion Julia sets, rendered by ray marching a distance estimator.
+//
+// julia_iterations() iterates z -> z^2 + c over complex numbers. The same iteration works over
+// quaternions q = a + bi + cj + dk, which have four coordinates instead of two; the points whose
+// orbit stays bounded form a 4D set. A 3D slice of it (the fourth coordinate held fixed) is a
+// solid object that can be rendered like any other.
+//
+// Its surface has no formula to intersect rays with, but the iteration gives an estimate of
+// how far a point is from the set at most: 0.5 |q| log|q| / |q'| once the orbit has escaped
+// (q' is the derivative of the orbit, tracked alongside it). A ray can safely advance by that
+// distance, so it "marches" along in large steps far from the set and ever smaller ones as it
+// closes in, and stops once the distance is smaller than the pixel it belongs to.
+//
+// Rays are marched in packets of QJULIA_PACKET_LANES neighbouring pixels (2x2 on screen). Their
+// distance estimates are computed together with the lane loop innermost, so the quaternion
+// arithmetic is one vector operation across the packet; see quaternion_julia_distance_packet().
+
+#pragma once
+
+// The number of rays (and points) processed together, and the bailout radius: an orbit that
+// gets further than this from the origin counts as escaped. A larger radius than the usual 2
+// makes the distance estimate more accurate, which lets rays take longer steps.
+const int QJULIA_PACKET_LANES = 4;
+const double QJULIA_BAILOUT = 4.0;
+
+// The quaternion r + i*i + j*j + k*k.
+struct Quaternion {
+    double r, i, j, k;
+};
+
+struct Vec3 {
+    double x, y, z;
+};
+
+// The set to render: iterate q -> q^2 + c, and show the 3D slice where the k coordinate is
+// 'slice' (point (x, y, z) is q = x + y*i + z*j + slice*k).
+struct QuaternionJulia {
+    Quaternion c;
+    double slice;
+    int max_iterations;
+};
+
+// How rays are marched.
+struct QuaternionJuliaMarch {
+    // Each step advances by the distance estimate times this. The estimate is only
+    // approximately a bound, so values a little below 1 keep rays from stepping into the set.
+    double step_scale;
+    // Adaptive precision: a ray hits the surface once the estimate drops below t * hit_scale,
+    // where t is how far it has travelled. With hit_scale about the angle one pixel covers, far
+    // surfaces are found as precisely as they can be seen, and not more (which would cost
+    // many tiny steps for nothing).
+    double hit_scale;
+    int max_steps;
+};
+
+struct QuaternionJuliaHit {
+    bool hit;
+    double t;  // Distance along the ray to the hit (or to where marching stopped).
+    int steps; // Distance estimates it took; useful for shading (more steps: a crevice).
+};
+
+// The distance estimate at (x, y, z): no point of the set is closer. 0 for points in the set.
+double quaternion_julia_distance(const QuaternionJulia& fractal, Vec3 point);
+
+// quaternion_julia_distance() for QJULIA_PACKET_LANES points, with exactly the same results.
+// Lanes whose orbit has escaped keep their values (selects, not branches) until every lane has
+// escaped or max_iterations is reached.
+void quaternion_julia_distance_packet(const QuaternionJulia& fractal, const double* x, const double* y,
+                                      const double* z, double* distance);
+
+// The radius of a ball around the origin containing the whole slice: points further out escape
+// under q -> q^2 + c. Rays start marching where they enter it. 0 if the slice is empty.
+double quaternion_julia_bound(const QuaternionJulia& fractal);
+
+// Marches one ray from 'origin' along 'direction' (unit length).
+QuaternionJuliaHit quaternion_julia_march(const QuaternionJulia& fractal, const QuaternionJuliaMarch& march,
+                                          Vec3 origin, Vec3 direction);
+
+// quaternion_julia_march() for QJULIA_PACKET_LANES rays from the same origin, with exactly the
+// same results. The packet keeps stepping until its last ray is done; finished rays are parked
+// far outside the set, where their distance estimate escapes at once.
+void quaternion_julia_march_packet(const QuaternionJulia& fractal, const QuaternionJuliaMarch& march, Vec3 origin,
+                                   const Vec3* directions, QuaternionJuliaHit* hits);
+
+// The surface normal at 'point' (unit length), from the distance estimate's change over
+// 'epsilon' in four directions (the corners of a tetrahedron: one packet of estimates).
+// All zeros where the estimate doesn't change, e.g. deep inside the set.
+Vec3 quaternion_julia_normal(const QuaternionJulia& fractal, Vec3 point, double epsilon);
@@ -0,0 +1,78 @@
+#include "fractal/tiles.h"
+
+#include <cmath> // For std::ldexp and std::hypot
+
+double julia_tile_pixel_spacing(int level) {
+    return std::ldexp(4.0, -(JULIA_TILE_SIZE_LOG2 + level));
+}
+
+FractalPrecision julia_tile_precision(const JuliaTileMap& map, int level) {
+    return choose_fractal_precision(julia_tile_pixel_spacing(level), std::hypot(map.center_real, map.center_imag));
+}
+
+// Counts of a size x size block whose pixel (0, 0) is pixel (first_x, first_y) of a grid with the
+// given spacing, with the pixels in 'todo' (indices into the block) still to be iterated.
+static void iterate_pixels(const JuliaTileMap& map, FractalPrecision precision, double spacing, long long first_x,
+                           long long first_y, int size, const std::vector<int>& todo, std::vector<int>& counts) {
+    const double left = map.center_real - 2.0;
+    const double top = map.center_imag - 2.0;
+    std::vector<int> results(todo.size());
+
+    // (first + k) * spacing is exact, so a parent and a child compute the very same sum for the
+    // pixels they share.
+    if (precision == FractalPrecision::Double) {
+        std::vector<std::complex<double>> points(todo.size());
+        for (std::size_t i = 0; i < todo.size(); ++i) {
+            points[i] = std::complex<double>(left + (first_x + todo[i] % size) * spacing,
+                                             top + (first_y + todo[i] / size) * spacing);
+        }
+        julia_iterations_batch(map.c, points.data(), results.data(), (int)points.size(), map.max_iterations);
+    } else {
+        // two_sum() keeps the whole sum, so pixels stay distinct far below 1e-13.
+        std::vector<DoubleDoubleComplex> points(todo.size());
+        for (std::size_t i = 0; i < todo.size(); ++i) {
+            points[i] = DoubleDoubleComplex{two_sum(left, (first_x + todo[i] % size) * spacing),
+                                            two_sum(top, (first_y + todo[i] / size) * spacing)};
+        }
+        julia_iterations_dd_batch(map.c, points.data(), results.data(), (int)points.size(), map.max_iterations);
+    }
+    for (std::size_t i = 0; i < todo.size(); ++i) {
+        counts[todo[i]] = results[i];
+    }
+}
+
+std::vector<int> julia_tile_counts(const JuliaTileMap& map, int level, long long x, long long y,
+                                   const std::vector<int>* parent) {
+    const int size = JULIA_TILE_SIZE;
+    FractalPrecision precision = julia_tile_precision(map, level);
+    if (level == 0 || julia_tile_precision(map, level - 1) != precision) {
+        parent = nullptr;
+    }
+
+    std::vector<int> counts(size * size);
+    std::vector<int> todo; // Indices into 'counts' that still need iterating.
+    todo.reserve(size * size);
+    const int quadrant_x = (int)(x % 2) * (size / 2);
+    const int quadrant_y = (int)(y % 2) * (size / 2);
+    for (int py = 0; py < size; ++py) {
+        for (int px = 0; px < size; ++px) {
+            if (parent && px % 2 == 0 && py % 2 == 0) {
+                counts[py * size + px] = (*parent)[(quadrant_y + py / 2) * size + quadrant_x + px / 2];
+            } else {
+                todo.push_back(py * size + px);
+            }
+        }
+    }
+    iterate_pixels(map, precision, julia_tile_pixel_spacing(level), x * size, y * size, size, todo, counts);
+    return counts;
+}
+
+std::vector<int> julia_map_overview(const JuliaTileMap& map, int size) {
+    std::vector<int> counts(size * size);
+    std::vector<int> todo(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        todo[i] = i;
+    }
+    iterate_pixels(map, FractalPrecision::Double, 4.0 / size, 0, 0, size, todo, counts);
+    return counts;
+}
@@ -0,0 +1,41 @@
+// The tiles of a zoomable Julia set map, shared by the tile pyramid generator (tools/julia_tiles.cpp)
+// and the render service (tools/julia_server.cpp).
+//
+// Level 0 is one JULIA_TILE_SIZE x JULIA_TILE_SIZE tile covering a 4x4 square of the complex
+// plane around the map's centre; every level doubles the tiles per side and halves the distance
+// between pixels. Pixel k (counted across the whole level) is at corner + k * spacing, and the
+// spacing is a power of two, so a pixel at even (x, y) of a tile lands bit-exactly on a pixel of
+// its parent tile one level up: those counts can be copied instead of iterated.
+
+#pragma once
+
+#include <complex> // For the Julia constant
+#include <vector>  // For iteration counts
+
+#include "fractal/julia.h"
+
+const int JULIA_TILE_SIZE = 256;
+const int JULIA_TILE_SIZE_LOG2 = 8;
+
+struct JuliaTileMap {
+    std::complex<double> c;
+    double center_real = 0.0;
+    double center_imag = 0.0;
+    int max_iterations = 100;
+};
+
+// Distance between neighbouring pixels at a level (exact: a power of two).
+double julia_tile_pixel_spacing(int level);
+
+// The arithmetic a level is rendered in: double, or double-double once the pixels get too close.
+FractalPrecision julia_tile_precision(const JuliaTileMap& map, int level);
+
+// Iteration counts (row by row) of tile (x, y) of a level. If 'parent' holds the counts of the
+// tile one level up (x/2, y/2), a quarter of the pixels are copied from it; pass nullptr when it
+// isn't available. Parents in a different precision than the tile are ignored.
+std::vector<int> julia_tile_counts(const JuliaTileMap& map, int level, long long x, long long y,
+                                   const std::vector<int>* parent = nullptr);
+
+// The whole map as one size x size image (size <= JULIA_TILE_SIZE), e.g. for the levels of a
+// Deep Zoom image below one tile.
+std::vector<int> julia_map_overview(const JuliaTileMap& map, int size);
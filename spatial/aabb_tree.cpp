@@ -0,0 +1,315 @@
+#include "spatial/aabb_tree.h"
+
+int AabbTree::allocateNode() {
+    int index;
+    if (freeList == NULL_NODE) {
+        index = static_cast<int>(nodes.size());
+        nodes.push_back(Node{});
+    } else {
+        index = freeList;
+        freeList = nodes[index].parent;
+    }
+    Node& node = nodes[index];
+    node.box = Rect{0, 0, 0, 0};
+    node.object = nullptr;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 1;
+    return index;
+}
+
+void AabbTree::freeNode(int index) {
+    nodes[index].parent = freeList;
+    nodes[index].height = 0;
+    freeList = index;
+}
+
+int AabbTree::insert(GameObject* obj) {
+    int leaf = allocateNode();
+    nodes[leaf].box = obj->bounds.expanded(margin);
+    nodes[leaf].object = obj;
+    insertLeaf(leaf);
+    ++objectCount;
+    return leaf;
+}
+
+void AabbTree::remove(int proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --objectCount;
+}
+
+bool AabbTree::update(int proxy, float dx, float dy) {
+    const Rect& bounds = nodes[proxy].object->bounds;
+    if (nodes[proxy].box.contains(bounds)) {
+        return false; // Still inside its fat box: the tree doesn't need to know.
+    }
+
+    removeLeaf(proxy);
+
+    // Give the new fat box some room ahead of the object, in the direction it is moving.
+    Rect fat = bounds.expanded(margin);
+    if (dx < 0) {
+        fat.x += dx;
+        fat.width -= dx;
+    } else {
+        fat.width += dx;
+    }
+    if (dy < 0) {
+        fat.y += dy;
+        fat.height -= dy;
+    } else {
+        fat.height += dy;
+    }
+    nodes[proxy].box = fat;
+
+    insertLeaf(proxy);
+    ++reinsertCount;
+    return true;
+}
+
+void AabbTree::insertLeaf(int leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // 1. Find the best sibling: walk down, and at each node compare the cost of pairing the
+    //    leaf with this node against the cheapest cost of going further down either child.
+    //    Cost is the total perimeter added to the tree; boxes above the pairing point grow by
+    //    the same amount whichever child we pick ('inheritance').
+    Rect leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        float combined = node.box.merged(leafBox).perimeter();
+        float cost = 2 * combined;
+        float inheritance = 2 * (combined - node.box.perimeter());
+
+        auto descendCost = [&](int child) {
+            const Node& c = nodes[child];
+            float grown = c.box.merged(leafBox).perimeter();
+            return c.isLeaf() ? grown + inheritance : grown - c.box.perimeter() + inheritance;
+        };
+        float cost1 = descendCost(node.child1);
+        float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+    int sibling = index;
+
+    // 2. Create a new parent for the sibling and the leaf.
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode(); // May grow 'nodes'; don't hold references across this.
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = leafBox.merged(nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+
+    if (oldParent != NULL_NODE) {
+        if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        } else {
+            nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        root = newParent;
+    }
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    // 3. Walk back up, growing the ancestors' boxes and rotating where it helps.
+    refitUpwards(newParent);
+}
+
+void AabbTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    // The leaf's sibling takes the place of their parent.
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NULL_NODE) {
+        if (nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        } else {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        // Only shrink the ancestors here: the reinsertion that usually follows rotates anyway.
+        refitUpwards(grandParent, false);
+    } else {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+}
+
+void AabbTree::refit(int index) {
+    Node& node = nodes[index];
+    const Node& child1 = nodes[node.child1];
+    const Node& child2 = nodes[node.child2];
+    node.box = child1.box.merged(child2.box);
+    node.height = 1 + std::max(child1.height, child2.height);
+}
+
+void AabbTree::refitUpwards(int index, bool rotateNodes) {
+    while (index != NULL_NODE) {
+        refit(index);
+        if (rotateNodes) {
+            rotate(index);
+        }
+        index = nodes[index].parent;
+    }
+}
+
+// Tree rotation at node A with children B and C (and grandchildren D, E under B and F, G
+// under C). Swapping a child of A with a grandchild on the other side keeps A's box as it
+// is but changes the boxes of B and/or C. We try every such swap and apply the one that
+// shrinks the summed perimeter of B and C the most, if any does.
+void AabbTree::rotate(int indexA) {
+    Node& A = nodes[indexA];
+    if (A.height < 3) {
+        return; // With only leaves below B and C there is nothing to swap.
+    }
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    enum Rotation { NONE, B_F, B_G, C_D, C_E, D_F, D_G };
+    Rotation best = NONE;
+    float bestCost = 0.0f; // Only rotations that make things strictly better.
+
+    auto consider = [&](Rotation rotation, float cost) {
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = rotation;
+        }
+    };
+
+    if (!C.isLeaf()) {
+        // Swap B with one of C's children: C's box becomes B + the other child.
+        const Node& F = nodes[C.child1];
+        const Node& G = nodes[C.child2];
+        float perimeterC = C.box.perimeter();
+        consider(B_F, B.box.merged(G.box).perimeter() - perimeterC);
+        consider(B_G, B.box.merged(F.box).perimeter() - perimeterC);
+    }
+    if (!B.isLeaf()) {
+        // Swap C with one of B's children: B's box becomes C + the other child.
+        const Node& D = nodes[B.child1];
+        const Node& E = nodes[B.child2];
+        float perimeterB = B.box.perimeter();
+        consider(C_D, C.box.merged(E.box).perimeter() - perimeterB);
+        consider(C_E, C.box.merged(D.box).perimeter() - perimeterB);
+    }
+    if (!B.isLeaf() && !C.isLeaf()) {
+        // Swap two grandchildren across: both B's and C's boxes change.
+        const Node& D = nodes[B.child1];
+        const Node& E = nodes[B.child2];
+        const Node& F = nodes[C.child1];
+        const Node& G = nodes[C.child2];
+        float before = B.box.perimeter() + C.box.perimeter();
+        consider(D_F, F.box.merged(E.box).perimeter() + D.box.merged(G.box).perimeter() - before);
+        consider(D_G, G.box.merged(E.box).perimeter() + F.box.merged(D.box).perimeter() - before);
+    }
+
+    // Swaps child 'slot' of node 'target' with node 'incoming'.
+    auto place = [&](int target, int& slot, int incoming) {
+        slot = incoming;
+        nodes[incoming].parent = target;
+    };
+
+    switch (best) {
+    case NONE:
+        return;
+    case B_F: {
+        int iF = C.child1;
+        place(indexA, A.child1, iF);
+        place(iC, C.child1, iB);
+        refit(iC);
+        break;
+    }
+    case B_G: {
+        int iG = C.child2;
+        place(indexA, A.child1, iG);
+        place(iC, C.child2, iB);
+        refit(iC);
+        break;
+    }
+    case C_D: {
+        int iD = B.child1;
+        place(indexA, A.child2, iD);
+        place(iB, B.child1, iC);
+        refit(iB);
+        break;
+    }
+    case C_E: {
+        int iE = B.child2;
+        place(indexA, A.child2, iE);
+        place(iB, B.child2, iC);
+        refit(iB);
+        break;
+    }
+    case D_F: {
+        int iD = B.child1;
+        int iF = C.child1;
+        place(iB, B.child1, iF);
+        place(iC, C.child1, iD);
+        refit(iB);
+        refit(iC);
+        break;
+    }
+    case D_G: {
+        int iD = B.child1;
+        int iG = C.child2;
+        place(iB, B.child1, iG);
+        place(iC, C.child2, iD);
+        refit(iB);
+        refit(iC);
+        break;
+    }
+    }
+    refit(indexA);
+    ++rotationCount;
+}
+
+void AabbTree::query(const Rect& range, std::vector<GameObject*>& found) const {
+    if (root == NULL_NODE) {
+        return;
+    }
+    // An explicit stack instead of recursion; kept per thread so queries don't allocate.
+    thread_local std::vector<int> stack;
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!node.box.intersects(range)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            // The fat box only says "maybe"; the object's real bounds decide.
+            if (range.intersects(node.object->bounds)) {
+                found.push_back(node.object);
+            }
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+// A dynamic bounding volume hierarchy (BVH) of axis-aligned boxes: an alternative to the
+// Quadtree for worlds where objects keep moving.
+//
+// The Quadtree carves space into fixed quadrants, so an object that moves a little can end up
+// in another node (or stuck in a parent because it straddles a border). The AabbTree instead
+// groups *objects*: every leaf holds one object, and every inner node holds the box around
+// its two children. Nothing is tied to fixed coordinates, so:
+//
+//   - Each leaf stores a "fat" box: the object's bounds grown by a margin (and stretched in
+//     the direction of motion). As long as the object stays inside its fat box, moving it
+//     costs nothing. Only when it leaves is it removed and reinserted, in O(log n).
+//   - Inserts pick the sibling that grows the tree's total perimeter least, and every insert
+//     (including the reinsertions done by update()) is followed by tree rotations on the way
+//     back up, which swap subtrees whenever that shrinks the boxes. That keeps the tree
+//     shallow and its boxes tight without ever rebuilding it. A removal only shrinks the
+//     boxes above the removed leaf; it doesn't rotate.
+//
+// query() has the same interface and results as Quadtree::query.
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <vector>  // For the node pool and query results
+
+#include "spatial/geometry.h"
+
+class AabbTree {
+public:
+    // 'margin' is how far the fat boxes extend past each object's bounds.
+    explicit AabbTree(float margin = 2.0f) : margin(margin) {}
+
+    // Adds an object (which must stay alive while it is in the tree). Returns its proxy id,
+    // the handle used to update or remove it.
+    int insert(GameObject* obj);
+
+    // Removes an object from the tree.
+    void remove(int proxy);
+
+    // Call after the object's bounds changed. (dx, dy) is its expected displacement per update;
+    // if the object has to be reinserted its fat box is stretched that far ahead, so steady
+    // movement doesn't cause a reinsertion every frame.
+    // Returns true if the object left its fat box and was reinserted.
+    bool update(int proxy, float dx = 0.0f, float dy = 0.0f);
+
+    // Finds all objects whose bounds intersect 'range' (same contract as Quadtree::query).
+    void query(const Rect& range, std::vector<GameObject*>& found) const;
+
+    std::size_t size() const { return objectCount; }
+
+    // Height of the tree (0 when empty, 1 for a single leaf). Stays around log2(size()).
+    int height() const { return root < 0 ? 0 : nodes[root].height; }
+
+    // How many updates led to a reinsertion, and how many rotations were applied so far.
+    long long reinsertions() const { return reinsertCount; }
+    long long rotations() const { return rotationCount; }
+
+private:
+    static const int NULL_NODE = -1;
+
+    struct Node {
+        Rect box;                  // Fat box for leaves, union of the children for inner nodes.
+        GameObject* object;        // Leaves only.
+        int parent;                // Also the next free node while the node is on the free list.
+        int child1;
+        int child2;
+        int height;                // 1 for leaves, 0 for free nodes.
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    int allocateNode();
+    void freeNode(int index);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    // Walks from 'index' to the root, recomputing boxes and heights (and rotating if asked).
+    void refitUpwards(int index, bool rotateNodes = true);
+    void rotate(int index);
+    void refit(int index);
+
+    float margin;
+    std::vector<Node> nodes;
+    int root = NULL_NODE;
+    int freeList = NULL_NODE;
+    std::size_t objectCount = 0;
+    long long reinsertCount = 0;
+    long long rotationCount = 0;
+};
@@ -0,0 +1,196 @@
+#include "spatial/compact_quadtree.h"
+
+#include <algorithm> // For std::partition, std::min and std::max
+#include <cmath>     // For std::floor and std::ceil
+#include <numeric>   // For std::iota
+
+// Grid position of 'value' in a node starting at 'origin', with 'scale' = 255 / node size,
+// rounded down (for minimum edges) or up (for maximum edges), one cell extra for float error.
+// Positions far outside the node are clamped first (just past the grid), so they fit an int.
+static float gridPosition(float value, float origin, float scale) {
+    return std::min(std::max((value - origin) * scale, -2.0f), 257.0f);
+}
+static int gridFloor(float value, float origin, float scale) {
+    return static_cast<int>(std::floor(gridPosition(value, origin, scale))) - 1;
+}
+static int gridCeil(float value, float origin, float scale) {
+    return static_cast<int>(std::ceil(gridPosition(value, origin, scale))) + 1;
+}
+static std::uint8_t clampToGrid(int q) {
+    return static_cast<std::uint8_t>(std::min(std::max(q, 0), 255));
+}
+
+Rect CompactQuadtree::childBox(const Rect& box, int i) {
+    float halfWidth = box.width / 2;
+    float halfHeight = box.height / 2;
+    float x = (i == 0 || i == 2) ? box.x + halfWidth : box.x;
+    float y = (i >= 2) ? box.y + halfHeight : box.y;
+    return Rect{x, y, halfWidth, halfHeight};
+}
+
+Rect CompactQuadtree::looseBox(const Rect& box) {
+    return Rect{box.x - box.width / 2, box.y - box.height / 2, box.width * 2, box.height * 2};
+}
+
+void CompactQuadtree::build(std::vector<GameObject>& objectArray) {
+    objects = objectArray.data();
+    nodes.clear();
+    items.clear();
+    items.reserve(objectArray.size());
+
+    if (objectArray.empty()) {
+        rootBox = Rect{0, 0, 0, 0};
+        return;
+    }
+    rootBox = objectArray[0].bounds;
+    for (const GameObject& obj : objectArray) {
+        rootBox = rootBox.merged(obj.bounds);
+    }
+
+    std::vector<std::uint32_t> order(objectArray.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<BuildRange> ranges;
+    nodes.push_back(Node{NO_CHILDREN, 0});
+    ranges.push_back(BuildRange{});
+    buildNode(0, rootBox, 0, order.data(), order.data(), order.data() + order.size(), ranges);
+
+    // Items go in node order (not in the order nodes were visited), so that each node's items
+    // end where the next node's begin and nodes don't need to store a count.
+    for (std::size_t node = 0; node < ranges.size(); ++node) {
+        const BuildRange& range = ranges[node];
+        const Rect loose = looseBox(range.box);
+        const float scaleX = loose.width > 0 ? 255.0f / loose.width : 0.0f;
+        const float scaleY = loose.height > 0 ? 255.0f / loose.height : 0.0f;
+        nodes[node].firstItem = static_cast<std::uint32_t>(items.size());
+        for (std::uint32_t i = range.begin; i != range.begin + range.count; ++i) {
+            const Rect& b = objects[order[i]].bounds;
+            items.push_back(Item{order[i],
+                                 clampToGrid(gridFloor(b.x, loose.x, scaleX)),
+                                 clampToGrid(gridFloor(b.y, loose.y, scaleY)),
+                                 clampToGrid(gridCeil(b.x + b.width, loose.x, scaleX)),
+                                 clampToGrid(gridCeil(b.y + b.height, loose.y, scaleY))});
+        }
+    }
+    nodes.push_back(Node{NO_CHILDREN, static_cast<std::uint32_t>(items.size())}); // The sentinel.
+    nodes.shrink_to_fit(); // The node count isn't known up front; drop the growth slack.
+}
+
+// Top-down build over the objects in [begin, end), whose centers all lie in 'box' and whose
+// bounds all lie in its loose box. Each object goes down to the quarter holding its center if
+// it fits that quarter's loose box; larger objects stay in this node. The objects that stay end
+// up at the front of the range; where they are is recorded in 'ranges' (indexed like 'nodes')
+// and build() turns them into items afterwards.
+void CompactQuadtree::buildNode(std::uint32_t node, const Rect& box, int depth, std::uint32_t* order,
+                                std::uint32_t* begin, std::uint32_t* end, std::vector<BuildRange>& ranges) {
+    std::uint32_t* stay = end;
+    std::uint32_t* childEnd[4] = {end, end, end, end};
+    bool split = end - begin > leafCapacity && depth < MAX_DEPTH && box.width > 0 && box.height > 0;
+    if (split) {
+        Rect quarters[4];
+        Rect looseQuarters[4];
+        for (int i = 0; i < 4; ++i) {
+            quarters[i] = childBox(box, i);
+            looseQuarters[i] = looseBox(quarters[i]);
+        }
+        const float midX = quarters[0].x;
+        const float midY = quarters[2].y;
+        auto quarterOf = [&](std::uint32_t index) {
+            const Rect& b = objects[index].bounds;
+            bool east = b.x + b.width / 2 >= midX;
+            bool south = b.y + b.height / 2 >= midY;
+            int i = south ? (east ? 2 : 3) : (east ? 0 : 1);
+            return looseQuarters[i].contains(b) ? i : -1;
+        };
+
+        // Partition into [too large to go down | quarter 0 | quarter 1 | quarter 2 | quarter 3].
+        stay = std::partition(begin, end, [&](std::uint32_t index) { return quarterOf(index) < 0; });
+        std::uint32_t* from = stay;
+        for (int i = 0; i < 3; ++i) {
+            from = std::partition(from, end, [&](std::uint32_t index) { return quarterOf(index) == i; });
+            childEnd[i] = from;
+        }
+    }
+
+    ranges[node] = BuildRange{box, static_cast<std::uint32_t>(begin - order),
+                              static_cast<std::uint32_t>(stay - begin)};
+
+    if (!split || stay == end) {
+        return; // A leaf, or every object straddles: no children needed.
+    }
+
+    std::uint32_t firstChild = static_cast<std::uint32_t>(nodes.size());
+    nodes[node].firstChild = firstChild;
+    for (int i = 0; i < 4; ++i) {
+        nodes.push_back(Node{NO_CHILDREN, 0});
+        ranges.push_back(BuildRange{});
+    }
+    std::uint32_t* from = stay;
+    for (int i = 0; i < 4; ++i) {
+        buildNode(firstChild + i, childBox(box, i), depth + 1, order, from, childEnd[i], ranges);
+        from = childEnd[i];
+    }
+}
+
+void CompactQuadtree::query(const Rect& range, std::vector<GameObject*>& found) const {
+    if (nodes.empty()) {
+        return;
+    }
+
+    // Node boxes are not stored; they travel down the stack with the node index.
+    struct Entry {
+        std::uint32_t node;
+        Rect box;
+    };
+    Entry stack[4 * MAX_DEPTH + 4];
+    int top = 0;
+    stack[top++] = Entry{0, rootBox};
+
+    while (top > 0) {
+        const Entry entry = stack[--top];
+        // Every object in a node lies inside its loose box, so a loose box the range misses can
+        // be skipped, children and all.
+        const Rect loose = looseBox(entry.box);
+        if (!loose.intersects(range)) {
+            continue;
+        }
+        const Node& node = nodes[entry.node];
+        const Item* first = items.data() + node.firstItem;
+        const Item* last = items.data() + nodes[entry.node + 1].firstItem;
+
+        if (range.contains(loose)) {
+            // The whole node is inside the range: all of its objects match, no tests needed.
+            for (const Item* item = first; item != last; ++item) {
+                found.push_back(objects + item->object);
+            }
+        } else if (first != last) {
+            // The range in this node's 8-bit grid (rounded outward), to test items against.
+            const float scaleX = loose.width > 0 ? 255.0f / loose.width : 0.0f;
+            const float scaleY = loose.height > 0 ? 255.0f / loose.height : 0.0f;
+            const int rangeMinX = gridFloor(range.x, loose.x, scaleX);
+            const int rangeMinY = gridFloor(range.y, loose.y, scaleY);
+            const int rangeMaxX = gridCeil(range.x + range.width, loose.x, scaleX);
+            const int rangeMaxY = gridCeil(range.y + range.height, loose.y, scaleY);
+            for (const Item* item = first; item != last; ++item) {
+                if (item->minX > rangeMaxX || item->maxX < rangeMinX ||
+                    item->minY > rangeMaxY || item->maxY < rangeMinY) {
+                    continue; // Rejected without touching the object.
+                }
+                GameObject* obj = objects + item->object;
+                if (range.intersects(obj->bounds)) {
+                    found.push_back(obj);
+                }
+            }
+        }
+
+        if (node.firstChild != NO_CHILDREN) {
+            // Pushed in reverse so children are visited in order (NE, NW, SE, SW).
+            for (int i = 3; i >= 0; --i) {
+                stack[top++] = Entry{node.firstChild + i, childBox(entry.box, i)};
+            }
+        }
+    }
+}
+
+std::size_t CompactQuadtree::memoryBytes() const {
+    return nodes.capacity() * sizeof(Node) + items.capacity() * sizeof(Item);
+}
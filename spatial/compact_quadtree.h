@@ -0,0 +1,90 @@
+// A memory-lean, static Quadtree for very large worlds (millions of objects).
+//
+// Each Quadtree node is a separate heap object holding its full boundary, its capacity, its own
+// std::vector of object pointers, flags, four unique_ptrs and the subtree aggregates: more than
+// 100 bytes per node before any objects. CompactQuadtree stores the same kind of tree in three
+// flat arrays instead:
+//
+//   - Nodes are 8 bytes: where their four children start (the children of a node are stored
+//     next to each other), and where their objects start in the item array. Items are stored
+//     in node order, so a node's objects end where the next node's start. Node bounds are not
+//     stored at all: they follow from the path taken from the root (each child is one quarter
+//     of its parent), so traversal computes them on the fly.
+//   - It is a "loose" quadtree: an object goes to the quarter holding its center, and may stick
+//     out of it by up to half the quarter's size (the node's "loose box"). So small objects on a
+//     split line still go down the tree, instead of piling up in the nodes near the root.
+//   - Items are 8 bytes, no more than the GameObject pointer a Quadtree stores: the object's
+//     index, and its bounds quantized to 8 bits per coordinate relative to the node it is stored
+//     in (a 256 x 256 grid over the node's loose box). All of a node's items sit together in
+//     one pooled array (no per-node vector).
+//   - Objects themselves are not copied; the tree refers to them by index into the caller's array.
+//
+// Most objects a query's range doesn't touch are rejected with the 8-bit bounds, without
+// loading the object at all; only objects that pass that test are checked against their real
+// bounds, so results are exactly those of Quadtree::query.
+//
+// The tree is built once over an array of objects (build() again after they moved) and has
+// the same query() interface as Quadtree.
+
+#pragma once
+
+#include <cstddef>  // For std::size_t
+#include <cstdint>  // For the fixed-size node and item fields
+#include <vector>   // For the node, item and result arrays
+
+#include "spatial/geometry.h"
+
+class CompactQuadtree {
+public:
+    // 'leafCapacity' is how many objects a node holds before it is split.
+    explicit CompactQuadtree(int leafCapacity = 8) : leafCapacity(leafCapacity) {}
+
+    // Builds the tree over 'objects', which must stay alive (and must not be reallocated) while
+    // the tree is used. The root covers the union of all object bounds (so build() again when
+    // objects moved).
+    void build(std::vector<GameObject>& objects);
+
+    // Finds all objects whose bounds intersect 'range' (same contract as Quadtree::query).
+    void query(const Rect& range, std::vector<GameObject*>& found) const;
+
+    std::size_t nodeCount() const { return nodes.empty() ? 0 : nodes.size() - 1; }
+    // Bytes used by the tree itself (not counting the objects).
+    std::size_t memoryBytes() const;
+
+private:
+    static const std::uint32_t NO_CHILDREN = 0; // The root (node 0) is never anyone's child.
+    static const int MAX_DEPTH = 24;            // Stop splitting where quarters get absurdly small.
+
+    // The nodes array ends with a sentinel node whose firstItem is the number of items.
+    struct Node {
+        std::uint32_t firstChild;  // Index of child 0 (children 1-3 follow), or NO_CHILDREN.
+        std::uint32_t firstItem;   // This node's items are items[firstItem, next node's firstItem).
+    };
+
+    // Object bounds in the node's own 8-bit grid: 0 is the left/top edge of the node's loose box
+    // and 255 its right/bottom edge. Rounded outward, so the quantized box covers the real one.
+    struct Item {
+        std::uint32_t object;
+        std::uint8_t minX, minY, maxX, maxY;
+    };
+
+    // Where a node's objects are while building: their box and their run of the index array.
+    struct BuildRange {
+        Rect box;
+        std::uint32_t begin;
+        std::uint32_t count;
+    };
+
+    // Child 'i' of a node with box 'box' (same order as Quadtree: NE, NW, SE, SW).
+    static Rect childBox(const Rect& box, int i);
+    // The box grown by half its size on every side: where a node's objects may extend to.
+    static Rect looseBox(const Rect& box);
+    void buildNode(std::uint32_t node, const Rect& box, int depth, std::uint32_t* order,
+                   std::uint32_t* begin, std::uint32_t* end, std::vector<BuildRange>& ranges);
+
+    int leafCapacity;
+    GameObject* objects = nullptr;
+    Rect rootBox{0, 0, 0, 0};
+    std::vector<Node> nodes;
+    std::vector<Item> items;
+};
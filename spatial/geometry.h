@@ -0,0 +1,64 @@
+// Basic geometric types shared by every spatial index in this directory.
+// They started life inside the Quadtree tutorial (cpp_learning_1db0cc.cpp) and were
+// moved here so other programs and benchmarks can reuse them.
+
+#pragma once
+
+#include <algorithm> // For std::min/std::max in the Rect helpers
+
+// Represents an axis-aligned bounding box (AABB).
+// Used for game object bounds and Quadtree node boundaries.
+struct Rect {
+    float x, y, width, height;
+
+    // Checks if this rectangle contains a point (px, py).
+    // Not directly used in this tutorial's core logic but useful for general Rect utility.
+    bool contains(float px, float py) const {
+        return px >= x && px <= x + width &&
+               py >= y && py <= y + height;
+    }
+
+    // Checks if this rectangle intersects with another rectangle.
+    // This is crucial for both object insertion and querying in the Quadtree.
+    bool intersects(const Rect& other) const {
+        return !(x + width < other.x ||
+                 y + height < other.y ||
+                 x > other.x + other.width ||
+                 y > other.y + other.height);
+    }
+
+    // Checks if 'other' lies completely inside this rectangle (touching edges count as inside).
+    bool contains(const Rect& other) const {
+        return other.x >= x && other.y >= y &&
+               other.x + other.width <= x + width &&
+               other.y + other.height <= y + height;
+    }
+
+    // The smallest rectangle covering both this one and 'other'.
+    Rect merged(const Rect& other) const {
+        float minX = std::min(x, other.x);
+        float minY = std::min(y, other.y);
+        float maxX = std::max(x + width, other.x + other.width);
+        float maxY = std::max(y + height, other.y + other.height);
+        return Rect{minX, minY, maxX - minX, maxY - minY};
+    }
+
+    // This rectangle grown by 'margin' on every side.
+    Rect expanded(float margin) const {
+        return Rect{x - margin, y - margin, width + 2 * margin, height + 2 * margin};
+    }
+
+    // The perimeter is the 2D "surface area" used to judge how good a bounding volume is:
+    // the chance that a random query line or box hits a rectangle grows with its perimeter.
+    float perimeter() const { return 2 * (width + height); }
+};
+
+// Represents a simple game object with an ID and a bounding box.
+// In a real game, this would be a more complex class with rendering, physics, etc.
+struct GameObject {
+    int id;       // A unique identifier for the object
+    Rect bounds;  // The bounding box of the object
+
+    // Constructor to easily create GameObjects.
+    GameObject(int id, Rect bounds) : id(id), bounds(bounds) {}
+};
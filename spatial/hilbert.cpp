@@ -0,0 +1,62 @@
+#include "spatial/hilbert.h"
+
+#include <algorithm> // For std::stable_sort and std::clamp
+#include <numeric>   // For std::iota
+#include <utility>   // For std::swap
+
+std::uint32_t hilbertIndex(std::uint32_t x, std::uint32_t y) {
+    const std::uint32_t n = 1u << 16;
+    std::uint32_t d = 0;
+    // Walk from the largest quadrant size down. At each level, (rx, ry) picks one of the four
+    // quadrants, which the curve visits in the order (0,0), (0,1), (1,1), (1,0); then the
+    // coordinates are rotated/flipped into that quadrant's own orientation for the next level.
+    for (std::uint32_t s = n / 2; s > 0; s /= 2) {
+        std::uint32_t rx = (x & s) ? 1 : 0;
+        std::uint32_t ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+std::vector<int> reorderAlongHilbert(std::vector<GameObject>& objects, const Rect& world) {
+    const int count = static_cast<int>(objects.size());
+
+    // 1. The curve position of every object's center, on a 65536 x 65536 grid over the world.
+    std::vector<std::uint32_t> keys(count);
+    const float scaleX = world.width > 0 ? 65535.0f / world.width : 0.0f;
+    const float scaleY = world.height > 0 ? 65535.0f / world.height : 0.0f;
+    for (int i = 0; i < count; ++i) {
+        const Rect& b = objects[i].bounds;
+        float cx = std::clamp((b.x + b.width / 2 - world.x) * scaleX, 0.0f, 65535.0f);
+        float cy = std::clamp((b.y + b.height / 2 - world.y) * scaleY, 0.0f, 65535.0f);
+        keys[i] = hilbertIndex(static_cast<std::uint32_t>(cx), static_cast<std::uint32_t>(cy));
+    }
+
+    // 2. Sort the indices by curve position (stable, so ties keep their old order).
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+
+    // 3. Record where each object goes, then move them there in place (following each cycle of
+    //    the permutation), so pointers into the array stay valid and can be remapped.
+    std::vector<int> oldToNew(count);
+    for (int i = 0; i < count; ++i) {
+        oldToNew[order[i]] = i;
+    }
+    std::vector<int> target = oldToNew;
+    for (int i = 0; i < count; ++i) {
+        while (target[i] != i) {
+            int j = target[i];
+            std::swap(objects[i], objects[j]);
+            std::swap(target[i], target[j]);
+        }
+    }
+    return oldToNew;
+}
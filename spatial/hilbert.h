@@ -0,0 +1,28 @@
+// Hilbert-curve ordering for GameObject storage.
+//
+// A Quadtree query returns objects that are close together in the *world*, but if the objects
+// were created in arbitrary order they are scattered all over *memory*, and the loop that
+// processes the results (the narrow phase: exact collision tests, rendering, ...) jumps from
+// cache miss to cache miss.
+//
+// The Hilbert curve is a path that visits every cell of a 2^k x 2^k grid once and never jumps:
+// consecutive cells along it are always neighbours, and any small square region is covered by
+// a few long runs of the curve. Sorting objects by the position of their center along the
+// curve therefore puts objects that are near each other in the world near each other in memory,
+// and a query's results come out as a few mostly contiguous stretches of the array.
+
+#pragma once
+
+#include <cstdint> // For std::uint32_t curve positions
+#include <vector>  // For the object storage and index tables
+
+#include "spatial/geometry.h"
+
+// Position of grid cell (x, y) along a Hilbert curve over a 65536 x 65536 grid.
+std::uint32_t hilbertIndex(std::uint32_t x, std::uint32_t y);
+
+// Reorders 'objects' along a Hilbert curve laid over 'world' (objects are placed by the center
+// of their bounds; centers outside 'world' are clamped to its edge).
+// Returns the old-to-new index table: the object that was at objects[i] is now at
+// objects[result[i]]. Pass it to Quadtree::remap() to update a tree built over the old order.
+std::vector<int> reorderAlongHilbert(std::vector<GameObject>& objects, const Rect& world);
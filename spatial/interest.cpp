@@ -0,0 +1,213 @@
+#include "spatial/interest.h"
+
+#include <algorithm> // For std::sort, std::unique and std::find
+#include <cmath>     // For std::floor
+
+void InterestManager::cellRange(const Rect& box, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = static_cast<int>(std::floor(box.x / cellSize));
+    y0 = static_cast<int>(std::floor(box.y / cellSize));
+    x1 = static_cast<int>(std::floor((box.x + box.width) / cellSize));
+    y1 = static_cast<int>(std::floor((box.y + box.height) / cellSize));
+}
+
+std::int64_t InterestManager::cellKey(int cx, int cy) {
+    return static_cast<std::int64_t>((static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+                                     static_cast<std::uint32_t>(cy));
+}
+
+void InterestManager::addToGrid(int subscription, const Rect& region) {
+    int x0, y0, x1, y1;
+    cellRange(region, x0, y0, x1, y1);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            grid[cellKey(cx, cy)].push_back(subscription);
+        }
+    }
+}
+
+void InterestManager::removeFromGrid(int subscription, const Rect& region) {
+    int x0, y0, x1, y1;
+    cellRange(region, x0, y0, x1, y1);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            auto cell = grid.find(cellKey(cx, cy));
+            if (cell == grid.end()) {
+                continue;
+            }
+            std::vector<int>& list = cell->second;
+            auto it = std::find(list.begin(), list.end(), subscription);
+            if (it != list.end()) {
+                *it = list.back(); // Order within a cell doesn't matter.
+                list.pop_back();
+            }
+            if (list.empty()) {
+                grid.erase(cell);
+            }
+        }
+    }
+}
+
+void InterestManager::collectNearby(const Rect& box) {
+    nearby.clear();
+    ++stamp;
+    int x0, y0, x1, y1;
+    cellRange(box, x0, y0, x1, y1);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            auto cell = grid.find(cellKey(cx, cy));
+            if (cell == grid.end()) {
+                continue;
+            }
+            for (int id : cell->second) {
+                // A region spanning several cells is listed in each; only check it once.
+                if (subscriptions[id].visitStamp != stamp) {
+                    subscriptions[id].visitStamp = stamp;
+                    nearby.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+// --- Objects ---
+
+int InterestManager::addObject(GameObject* obj) {
+    int handle = objects.insert(obj);
+    if (handle >= static_cast<int>(records.size())) {
+        records.resize(handle + 1);
+    }
+    records[handle] = ObjectRecord{obj, obj->bounds};
+
+    collectNearby(obj->bounds);
+    for (int id : nearby) {
+        if (subscriptions[id].region.intersects(obj->bounds)) {
+            pendingEvents.push_back(InterestEvent{id, obj, true});
+        }
+    }
+    return handle;
+}
+
+void InterestManager::removeObject(int handle) {
+    ObjectRecord& record = records[handle];
+    collectNearby(record.lastBounds);
+    for (int id : nearby) {
+        if (subscriptions[id].region.intersects(record.lastBounds)) {
+            pendingEvents.push_back(InterestEvent{id, record.object, false});
+        }
+    }
+    objects.remove(handle);
+    record.object = nullptr;
+}
+
+void InterestManager::moveObject(int handle, float dx, float dy) {
+    ObjectRecord& record = records[handle];
+    const Rect before = record.lastBounds;
+    const Rect after = record.object->bounds;
+    objects.update(handle, dx, dy);
+    record.lastBounds = after;
+
+    // Only regions near the old or new position can see the object cross their border.
+    collectNearby(before.merged(after));
+    for (int id : nearby) {
+        const Rect& region = subscriptions[id].region;
+        bool wasIn = region.intersects(before);
+        bool isIn = region.intersects(after);
+        if (wasIn != isIn) {
+            pendingEvents.push_back(InterestEvent{id, record.object, isIn});
+        }
+    }
+}
+
+// --- Subscriptions ---
+
+int InterestManager::subscribe(const Rect& region) {
+    int id;
+    if (freeSubscriptions.empty()) {
+        id = static_cast<int>(subscriptions.size());
+        subscriptions.push_back(Subscription{region, 0});
+    } else {
+        id = freeSubscriptions.back();
+        freeSubscriptions.pop_back();
+        subscriptions[id] = Subscription{region, 0};
+    }
+    addToGrid(id, region);
+
+    scratch.clear();
+    objects.query(region, scratch);
+    for (GameObject* obj : scratch) {
+        pendingEvents.push_back(InterestEvent{id, obj, true});
+    }
+    return id;
+}
+
+void InterestManager::unsubscribe(int subscription) {
+    removeFromGrid(subscription, subscriptions[subscription].region);
+    freeSubscriptions.push_back(subscription);
+}
+
+void InterestManager::moveSubscription(int subscription, const Rect& region) {
+    Rect before = subscriptions[subscription].region;
+
+    // Keep the grid in step, if the region now covers different cells.
+    int ox0, oy0, ox1, oy1, nx0, ny0, nx1, ny1;
+    cellRange(before, ox0, oy0, ox1, oy1);
+    cellRange(region, nx0, ny0, nx1, ny1);
+    if (ox0 != nx0 || oy0 != ny0 || ox1 != nx1 || oy1 != ny1) {
+        removeFromGrid(subscription, before);
+        addToGrid(subscription, region);
+    }
+    subscriptions[subscription].region = region;
+
+    diffRegions(subscription, before, region);
+}
+
+// The part of 'a' outside 'b', as up to four rectangles (closed, so objects that only touch
+// the border of the difference are found too).
+static int subtractRect(const Rect& a, const Rect& b, Rect out[4]) {
+    if (!a.intersects(b)) {
+        out[0] = a;
+        return 1;
+    }
+    int n = 0;
+    float aRight = a.x + a.width, aBottom = a.y + a.height;
+    float bRight = b.x + b.width, bBottom = b.y + b.height;
+    if (b.y > a.y) {
+        out[n++] = Rect{a.x, a.y, a.width, b.y - a.y};                    // Above b.
+    }
+    if (bBottom < aBottom) {
+        out[n++] = Rect{a.x, bBottom, a.width, aBottom - bBottom};        // Below b.
+    }
+    float bandTop = std::max(a.y, b.y);
+    float bandHeight = std::min(aBottom, bBottom) - bandTop;
+    if (b.x > a.x) {
+        out[n++] = Rect{a.x, bandTop, b.x - a.x, bandHeight};             // Left of b.
+    }
+    if (bRight < aRight) {
+        out[n++] = Rect{bRight, bandTop, aRight - bRight, bandHeight};    // Right of b.
+    }
+    return n;
+}
+
+void InterestManager::diffRegions(int subscription, const Rect& before, const Rect& after) {
+    // Objects can only change state inside before \ after (may leave) or after \ before
+    // (may enter): the strips the region swept over, not the whole region.
+    Rect strips[8];
+    int count = subtractRect(before, after, strips);
+    count += subtractRect(after, before, strips + count);
+
+    scratch.clear();
+    for (int i = 0; i < count; ++i) {
+        objects.query(strips[i], scratch);
+    }
+    // An object overlapping several strips is found once per strip.
+    std::sort(scratch.begin(), scratch.end());
+    scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+
+    for (GameObject* obj : scratch) {
+        bool wasIn = before.intersects(obj->bounds);
+        bool isIn = after.intersects(obj->bounds);
+        if (wasIn != isIn) {
+            pendingEvents.push_back(InterestEvent{subscription, obj, isIn});
+        }
+    }
+}
@@ -0,0 +1,93 @@
+// Interest management: region subscriptions that are told when objects enter or leave them.
+//
+// A game server has to tell every player which objects appeared in or disappeared from their
+// view. The straightforward way is to query each view rectangle every tick and diff the result
+// with last tick's, which costs O(visible objects) per player per tick, even when nothing moved.
+//
+// The InterestManager turns this around and works from the *changes*:
+//
+//   - When an object moves, only the subscriptions near its old and new position can be
+//     affected. Subscriptions are kept in a uniform grid of cells, so those few are found
+//     directly, and each is told "entered" or "left" if the object crossed its border.
+//     Objects that don't move cost nothing.
+//   - When a subscription's region moves, only objects in the strips between the old and new
+//     rectangle can change state. Those strips are queried from an AabbTree of the objects.
+//
+// So the cost per tick follows how much actually moved, not how much is visible.
+// An object is "in" a region when its bounds intersect it, as for Quadtree::query.
+
+#pragma once
+
+#include <cstdint>        // For std::int64_t grid cell keys
+#include <unordered_map>  // For the subscription grid
+#include <vector>         // For object records, subscriptions and events
+
+#include "spatial/aabb_tree.h"
+#include "spatial/geometry.h"
+
+// One notification: 'object' entered (or left) the region of subscription 'subscription'.
+struct InterestEvent {
+    int subscription;
+    GameObject* object;
+    bool entered;
+};
+
+class InterestManager {
+public:
+    // 'cellSize' is the grid cell size used to find the subscriptions near a moving object;
+    // about the size of a typical subscription region works well.
+    explicit InterestManager(float cellSize = 256.0f) : cellSize(cellSize) {}
+
+    // Objects (which must stay alive while tracked). addObject() returns a handle for
+    // moveObject()/removeObject(), and reports 'entered' for every region it starts in;
+    // removeObject() reports 'left' for every region it was in.
+    int addObject(GameObject* obj);
+    void removeObject(int handle);
+
+    // Call after changing the object's bounds (before any other call, so regions see the
+    // change). (dx, dy) is its expected movement per tick, passed on to AabbTree::update.
+    void moveObject(int handle, float dx = 0.0f, float dy = 0.0f);
+
+    // Region subscriptions. subscribe() reports 'entered' for every object already inside;
+    // unsubscribe() reports nothing (the subscriber is going away).
+    int subscribe(const Rect& region);
+    void moveSubscription(int subscription, const Rect& region);
+    void unsubscribe(int subscription);
+
+    // Events reported since the last clearEvents(), in the order they happened.
+    const std::vector<InterestEvent>& events() const { return pendingEvents; }
+    void clearEvents() { pendingEvents.clear(); }
+
+private:
+    struct ObjectRecord {
+        GameObject* object;
+        Rect lastBounds;      // Bounds at the last add/move: where subscriptions last saw it.
+    };
+
+    struct Subscription {
+        Rect region;
+        unsigned visitStamp;  // Marks subscriptions already checked for the current move.
+    };
+
+    // Grid cells covered by 'box', as inclusive cell coordinate ranges.
+    void cellRange(const Rect& box, int& x0, int& y0, int& x1, int& y1) const;
+    static std::int64_t cellKey(int cx, int cy);
+    void addToGrid(int subscription, const Rect& region);
+    void removeFromGrid(int subscription, const Rect& region);
+    // Fills 'nearby' with the active subscriptions in the grid cells covered by 'box', each once.
+    void collectNearby(const Rect& box);
+    // Reports enter/leave for the objects whose state changed when a subscription's region
+    // moved from 'before' to 'after'.
+    void diffRegions(int subscription, const Rect& before, const Rect& after);
+
+    float cellSize;
+    AabbTree objects;
+    std::vector<ObjectRecord> records;     // Indexed by object handle (the AabbTree proxy).
+    std::vector<Subscription> subscriptions;
+    std::vector<int> freeSubscriptions;
+    std::unordered_map<std::int64_t, std::vector<int>> grid;  // Cell -> subscriptions touching it.
+    std::vector<InterestEvent> pendingEvents;
+    std::vector<int> nearby;
+    std::vector<GameObject*> scratch;
+    unsigned stamp = 0;
+};
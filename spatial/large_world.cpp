@@ -0,0 +1,84 @@
+#include "spatial/large_world.h"
+
+#include <algorithm> // For std::min and std::max
+#include <cmath>     // For std::floor
+
+std::int64_t LargeWorldIndex::cellOf(double coordinate) const {
+    return static_cast<std::int64_t>(std::floor(coordinate / regionSize));
+}
+
+std::uint64_t LargeWorldIndex::regionKey(std::int64_t cellX, std::int64_t cellY) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cellX)) << 32) |
+           static_cast<std::uint32_t>(cellY);
+}
+
+void LargeWorldIndex::insert(int id, const WorldRect& bounds) {
+    std::int64_t cellX = cellOf(bounds.x + bounds.width / 2);
+    std::int64_t cellY = cellOf(bounds.y + bounds.height / 2);
+    std::unique_ptr<Region>& region = regions[regionKey(cellX, cellY)];
+    if (!region) {
+        region = std::make_unique<Region>(static_cast<double>(cellX) * regionSize,
+                                          static_cast<double>(cellY) * regionSize,
+                                          static_cast<float>(regionSize), capacity);
+    }
+
+    // The offset from the anchor is computed in double and only then rounded to float, so it
+    // keeps full float precision relative to the region, not to the world origin.
+    Rect local = {static_cast<float>(bounds.x - region->anchorX),
+                  static_cast<float>(bounds.y - region->anchorY),
+                  static_cast<float>(bounds.width),
+                  static_cast<float>(bounds.height)};
+    region->objects.emplace_back(id, local);
+    region->tree.insert(&region->objects.back());
+
+    maxHalfExtent = std::max(maxHalfExtent, std::max(bounds.width, bounds.height) / 2);
+    ++objectCount;
+}
+
+void LargeWorldIndex::query(const WorldRect& range, std::vector<int>& ids) {
+    // Objects are filed under the region of their center, but can reach up to maxHalfExtent
+    // past it, so look at the regions whose cells come within that distance of the range.
+    std::int64_t x0 = cellOf(range.x - maxHalfExtent);
+    std::int64_t y0 = cellOf(range.y - maxHalfExtent);
+    std::int64_t x1 = cellOf(range.x + range.width + maxHalfExtent);
+    std::int64_t y1 = cellOf(range.y + range.height + maxHalfExtent);
+
+    double cellsCovered = static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1);
+    if (cellsCovered > static_cast<double>(regions.size())) {
+        // A huge range: cheaper to go through the regions that exist.
+        for (auto& entry : regions) {
+            queryRegion(*entry.second, range, ids);
+        }
+        return;
+    }
+    for (std::int64_t cy = y0; cy <= y1; ++cy) {
+        for (std::int64_t cx = x0; cx <= x1; ++cx) {
+            auto it = regions.find(regionKey(cx, cy));
+            if (it != regions.end()) {
+                queryRegion(*it->second, range, ids);
+            }
+        }
+    }
+}
+
+void LargeWorldIndex::queryRegion(Region& region, const WorldRect& range, std::vector<int>& ids) {
+    // The one double-precision step per region: move the range into the region's frame.
+    // Objects here lie within maxHalfExtent of the region, so the range is first clipped to
+    // that neighbourhood. That doesn't change which objects it hits, and keeps a range that
+    // starts far away from turning into huge (and so imprecise) float offsets.
+    const double reach = maxHalfExtent + 1.0;
+    double left = std::max(range.x - region.anchorX, -reach);
+    double top = std::max(range.y - region.anchorY, -reach);
+    double right = std::min(range.x + range.width - region.anchorX, regionSize + reach);
+    double bottom = std::min(range.y + range.height - region.anchorY, regionSize + reach);
+    if (right < left || bottom < top) {
+        return;
+    }
+    Rect local = {static_cast<float>(left), static_cast<float>(top),
+                  static_cast<float>(right - left), static_cast<float>(bottom - top)};
+    scratch.clear();
+    region.tree.query(local, scratch);
+    for (const GameObject* obj : scratch) {
+        ids.push_back(obj->id);
+    }
+}
@@ -0,0 +1,78 @@
+// Large-world mode for the spatial index: uniform precision in worlds far bigger than a float
+// can describe.
+//
+// Rect stores float coordinates. A float has 24 bits of mantissa, so at 100 km from the origin
+// neighbouring values are almost 1 cm apart. There, bounds get rounded by up to half a centimetre
+// and intersects() gives wrong answers for objects that are close but not touching. Switching
+// everything to double would fix that but make every test in the tree more expensive.
+//
+// LargeWorldIndex keeps float math in the trees and moves the origin instead. The world is
+// divided into square regions. Each region has an anchor: its corner, stored exactly as an
+// integer cell number times the region size. It also has its own Quadtree, which holds object
+// bounds as float offsets from that anchor. The offsets stay below about one region size, so
+// they keep the same sub-millimetre precision (for 1 km regions) wherever the region is.
+// Doubles are only used at the borders of the index: converting an object's bounds on insert,
+// and a query range once per region visited.
+
+#pragma once
+
+#include <cstddef>        // For std::size_t
+#include <cstdint>        // For std::int64_t region cells
+#include <deque>          // For the per-region object storage (stable addresses for the tree)
+#include <memory>         // For std::unique_ptr regions
+#include <unordered_map>  // For the regions that have objects
+#include <vector>         // For query results
+
+#include "spatial/quadtree.h"
+
+// An axis-aligned box in world coordinates (metres, say), in double precision.
+struct WorldRect {
+    double x, y;
+    double width, height;
+
+    // Same rule as Rect::intersects: touching edges count as intersecting.
+    bool intersects(const WorldRect& other) const {
+        return !(other.x > x + width ||
+                 other.x + other.width < x ||
+                 other.y > y + height ||
+                 other.y + other.height < y);
+    }
+};
+
+class LargeWorldIndex {
+public:
+    // 'regionSize' is the side of each region in world units; 'capacity' is passed on to the
+    // regions' Quadtrees.
+    explicit LargeWorldIndex(double regionSize = 1024.0, int capacity = 8)
+        : regionSize(regionSize), capacity(capacity) {}
+
+    // Adds an object by its id and world bounds. It is stored in the region holding its center.
+    void insert(int id, const WorldRect& bounds);
+
+    // Appends the ids of all objects whose bounds intersect 'range'.
+    void query(const WorldRect& range, std::vector<int>& ids);
+
+    std::size_t size() const { return objectCount; }
+    std::size_t regionCount() const { return regions.size(); }
+
+private:
+    struct Region {
+        double anchorX, anchorY;            // Exact: cell number times regionSize.
+        std::deque<GameObject> objects;     // Bounds relative to the anchor, as floats.
+        Quadtree tree;
+
+        Region(double anchorX, double anchorY, float size, int capacity)
+            : anchorX(anchorX), anchorY(anchorY), tree(Rect{0, 0, size, size}, capacity) {}
+    };
+
+    std::int64_t cellOf(double coordinate) const;
+    static std::uint64_t regionKey(std::int64_t cellX, std::int64_t cellY);
+    void queryRegion(Region& region, const WorldRect& range, std::vector<int>& ids);
+
+    double regionSize;
+    int capacity;
+    std::unordered_map<std::uint64_t, std::unique_ptr<Region>> regions;
+    double maxHalfExtent = 0;  // Largest half width/height seen: how far objects reach out of their region.
+    std::size_t objectCount = 0;
+    std::vector<GameObject*> scratch;
+};
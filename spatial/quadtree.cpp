@@ -0,0 +1,293 @@
+#include "spatial/quadtree.h"
+
+#include <algorithm> // For std::min/std::max
+#include <cmath>     // For std::isfinite
+
+void Quadtree::subdivide() {
+    float subWidth = boundary.width / 2;
+    float subHeight = boundary.height / 2;
+    float x = boundary.x;
+    float y = boundary.y;
+
+    // Create and store the four new child Quadtree nodes using make_unique.
+    children[0] = std::make_unique<Quadtree>(Rect{x + subWidth, y, subWidth, subHeight}, capacity, false);      // North-East
+    children[1] = std::make_unique<Quadtree>(Rect{x, y, subWidth, subHeight}, capacity, false);                  // North-West
+    children[2] = std::make_unique<Quadtree>(Rect{x + subWidth, y + subHeight, subWidth, subHeight}, capacity, false); // South-East
+    children[3] = std::make_unique<Quadtree>(Rect{x, y + subHeight, subWidth, subHeight}, capacity, false);      // South-West
+
+    divided = true; // Mark this node as having children.
+}
+
+void Quadtree::grow(const Rect& target) {
+    // Grow toward the side(s) where the target's center lies outside the current boundary.
+    bool growLeft = target.x + target.width / 2 < boundary.x;
+    bool growUp = target.y + target.height / 2 < boundary.y;
+    Rect larger = {growLeft ? boundary.x - boundary.width : boundary.x,
+                   growUp ? boundary.y - boundary.height : boundary.y,
+                   boundary.width * 2, boundary.height * 2};
+
+    // Move this root's contents (objects, children, aggregates) into a new node that becomes a child.
+    std::unique_ptr<Quadtree> oldRoot = std::make_unique<Quadtree>(std::move(*this));
+    oldRoot->autoGrow = false;
+
+    // Turn this node into the new, empty root around it. The subtree aggregates stay as they are:
+    // the new root holds exactly the objects the old one did.
+    boundary = larger;
+    objects.clear();
+    autoGrow = true;
+    subdivide();
+
+    // The old root is the quadrant on the opposite side of the growth direction
+    // (children order: NE, NW, SE, SW).
+    int quadrant = growUp ? (growLeft ? 2 : 3) : (growLeft ? 0 : 1);
+    children[quadrant] = std::move(oldRoot);
+}
+
+bool Quadtree::insert(GameObject* obj) {
+    // 1. If the object's bounding box doesn't intersect this node's boundary, it cannot be stored here.
+    //    The root can grow to reach it instead. (It rejects NaN or infinite bounds, which no amount of
+    //    growing reaches and which would poison the subtree bounds.)
+    if (autoGrow) {
+        const Rect& b = obj->bounds;
+        if (!std::isfinite(b.x) || !std::isfinite(b.y) || !std::isfinite(b.width) || !std::isfinite(b.height)) {
+            return false;
+        }
+        while (boundary.width > 0 && boundary.height > 0 && !boundary.intersects(b)) {
+            grow(b);
+        }
+    }
+    if (!boundary.intersects(obj->bounds)) {
+        return false;
+    }
+
+    // From here on the object always ends up in this subtree, so update the subtree aggregates now.
+    subtreeBounds = subtreeCount == 0 ? obj->bounds : subtreeBounds.merged(obj->bounds);
+    ++subtreeCount;
+
+    // 2. If this node has space (below capacity) AND hasn't subdivided yet, add the object directly.
+    if (objects.size() < static_cast<size_t>(capacity) && !divided) {
+        objects.push_back(obj);
+        return true;
+    }
+
+    // 3. If at capacity or already divided:
+    //    If not divided yet, subdivide this node first.
+    if (!divided) {
+        subdivide();
+    }
+
+    // 4. Try to insert the object into one of the child nodes.
+    //    We iterate through children and try to insert. If any child successfully takes the object, we're done.
+    for (int i = 0; i < 4; ++i) {
+        if (children[i]->insert(obj)) {
+            return true; // Object was fully contained and inserted into a child.
+        }
+    }
+
+    // 5. If the object's bounds intersect this node's boundary but do not fit *entirely* within any single child
+    //    (e.g., the object spans across multiple quadrants), it stays in this (parent) node's object list.
+    //    This is crucial for objects that cannot be fully contained by a single child node after subdivision.
+    objects.push_back(obj);
+    return true;
+}
+
+void Quadtree::query(const Rect& range, std::vector<GameObject*>& found) {
+    // 1. If the query range does not intersect the bounds of everything in this subtree, no objects here can match.
+    //    (Testing 'boundary' instead would miss objects that were stored in a child they only partly overlap.)
+    if (subtreeCount == 0 || !subtreeBounds.intersects(range)) {
+        return;
+    }
+
+    // 2. Add objects directly stored in *this* node that intersect the query range.
+    for (GameObject* obj : objects) {
+        if (range.intersects(obj->bounds)) {
+            found.push_back(obj);
+        }
+    }
+
+    // 3. If this node has children, recursively query them as well.
+    if (divided) {
+        for (int i = 0; i < 4; ++i) {
+            children[i]->query(range, found);
+        }
+    }
+}
+
+int Quadtree::count(const Rect& range) const {
+    // 1. Nothing in this subtree can touch the range.
+    if (subtreeCount == 0 || !subtreeBounds.intersects(range)) {
+        return 0;
+    }
+
+    // 2. Every object in this subtree lies inside the range, so all of them intersect it.
+    if (range.contains(subtreeBounds)) {
+        return subtreeCount;
+    }
+
+    // 3. Partial overlap: test this node's own objects and ask the children.
+    int total = 0;
+    for (const GameObject* obj : objects) {
+        if (range.intersects(obj->bounds)) {
+            ++total;
+        }
+    }
+    if (divided) {
+        for (int i = 0; i < 4; ++i) {
+            total += children[i]->count(range);
+        }
+    }
+    return total;
+}
+
+void Quadtree::remap(GameObject* base, const std::vector<int>& oldToNew) {
+    const GameObject* end = base + oldToNew.size();
+    for (GameObject*& obj : objects) {
+        if (obj >= base && obj < end) {
+            obj = base + oldToNew[obj - base];
+        }
+    }
+    if (divided) {
+        for (int i = 0; i < 4; ++i) {
+            children[i]->remap(base, oldToNew);
+        }
+    }
+}
+
+void Quadtree::releaseChildren(std::vector<std::unique_ptr<Quadtree>>& out) {
+    if (divided) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(std::move(children[i]));
+        }
+        divided = false;
+    }
+}
+
+std::size_t Quadtree::memoryBytes() const {
+    std::size_t bytes = sizeof(Quadtree) + objects.capacity() * sizeof(GameObject*);
+    if (divided) {
+        for (int i = 0; i < 4; ++i) {
+            bytes += children[i]->memoryBytes();
+        }
+    }
+    return bytes;
+}
+
+void Quadtree::RangePacket::reserve(std::size_t count) {
+    if (index.size() < count) {
+        minX.resize(count);
+        minY.resize(count);
+        maxX.resize(count);
+        maxY.resize(count);
+        index.resize(count);
+        hit.resize(count);
+    }
+}
+
+void Quadtree::queryPacket(const std::vector<Rect>& ranges, std::vector<std::vector<GameObject*>>& found) const {
+    found.resize(ranges.size());
+
+    // One packet per tree depth, reused across calls. A deque, because growing it during the
+    // recursion must not move the packets that shallower calls are still reading.
+    thread_local std::deque<RangePacket> levels;
+    if (levels.empty()) {
+        levels.emplace_back();
+    }
+    RangePacket& packet = levels[0];
+    packet.reserve(ranges.size());
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        packet.minX[i] = ranges[i].x;
+        packet.minY[i] = ranges[i].y;
+        packet.maxX[i] = ranges[i].x + ranges[i].width;
+        packet.maxY[i] = ranges[i].y + ranges[i].height;
+        packet.index[i] = static_cast<int>(i);
+    }
+    queryPacketNode(levels, 0, static_cast<int>(ranges.size()), found);
+}
+
+// levels[depth] holds the 'count' ranges that reached this node. The ranges that actually
+// intersect this subtree are packed into levels[depth + 1] for this node's objects and children.
+void Quadtree::queryPacketNode(std::deque<RangePacket>& levels, std::size_t depth, int count,
+                               std::vector<std::vector<GameObject*>>& found) const {
+    if (subtreeCount == 0) {
+        return;
+    }
+    if (levels.size() <= depth + 1) {
+        levels.emplace_back();
+    }
+    const RangePacket& in = levels[depth];
+    RangePacket& out = levels[depth + 1];
+    out.reserve(count);
+
+    // 1. Test the subtree bounds against every range at once (same test as Rect::intersects,
+    //    written without branches so the loop vectorizes).
+    const float boxMinX = subtreeBounds.x;
+    const float boxMinY = subtreeBounds.y;
+    const float boxMaxX = subtreeBounds.x + subtreeBounds.width;
+    const float boxMaxY = subtreeBounds.y + subtreeBounds.height;
+    // (Plain local pointers, so the compiler knows the arrays don't change behind its back.)
+    const float* inMinX = in.minX.data();
+    const float* inMinY = in.minY.data();
+    const float* inMaxX = in.maxX.data();
+    const float* inMaxY = in.maxY.data();
+    unsigned char* hit = out.hit.data();
+    for (int k = 0; k < count; ++k) {
+        hit[k] = !((inMinX[k] > boxMaxX) | (inMaxX[k] < boxMinX) |
+                   (inMinY[k] > boxMaxY) | (inMaxY[k] < boxMinY));
+    }
+
+    // 2. Pack the surviving ranges together; if none is left, the whole subtree is skipped.
+    float* minX = out.minX.data();
+    float* minY = out.minY.data();
+    float* maxX = out.maxX.data();
+    float* maxY = out.maxY.data();
+    int* index = out.index.data();
+    //    Also track the box around the surviving ranges, the packet's own bounds.
+    int active = 0;
+    float packetMinX = boxMaxX, packetMinY = boxMaxY, packetMaxX = boxMinX, packetMaxY = boxMinY;
+    for (int k = 0; k < count; ++k) {
+        if (hit[k]) {
+            minX[active] = inMinX[k];
+            minY[active] = inMinY[k];
+            maxX[active] = inMaxX[k];
+            maxY[active] = inMaxY[k];
+            index[active] = in.index[k];
+            packetMinX = std::min(packetMinX, inMinX[k]);
+            packetMinY = std::min(packetMinY, inMinY[k]);
+            packetMaxX = std::max(packetMaxX, inMaxX[k]);
+            packetMaxY = std::max(packetMaxY, inMaxY[k]);
+            ++active;
+        }
+    }
+    if (active == 0) {
+        return;
+    }
+
+    // 3. Test this node's own objects against all surviving ranges. One test against the packet
+    //    bounds first rejects the objects that are far from every range in the packet.
+    for (GameObject* obj : objects) {
+        const Rect& b = obj->bounds;
+        const float objMinX = b.x;
+        const float objMinY = b.y;
+        const float objMaxX = b.x + b.width;
+        const float objMaxY = b.y + b.height;
+        if (objMinX > packetMaxX || objMaxX < packetMinX || objMinY > packetMaxY || objMaxY < packetMinY) {
+            continue;
+        }
+        for (int k = 0; k < active; ++k) {
+            hit[k] = !((objMinX > maxX[k]) | (objMaxX < minX[k]) |
+                       (objMinY > maxY[k]) | (objMaxY < minY[k]));
+        }
+        for (int k = 0; k < active; ++k) {
+            if (hit[k]) {
+                found[index[k]].push_back(obj);
+            }
+        }
+    }
+
+    // 4. Hand the packet down to the children.
+    if (divided) {
+        for (int i = 0; i < 4; ++i) {
+            children[i]->queryPacketNode(levels, depth + 1, active, found);
+        }
+    }
+}
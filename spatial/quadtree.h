@@ -0,0 +1,107 @@
+// The Quadtree: a spatial partitioning structure that divides the world into quadrants,
+// so that collision and proximity queries only look at objects near the query area
+// instead of checking every object against every other object (O(n^2)).
+// See cpp_learning_1db0cc.cpp for a walkthrough of how it is used.
+
+#pragma once
+
+#include <array>    // For fixed-size array of child Quadtree nodes
+#include <deque>    // For the per-depth range packets of queryPacket()
+#include <memory>   // For std::unique_ptr to manage memory of child nodes
+#include <vector>   // For storing collections of objects
+
+#include "spatial/geometry.h"
+
+class Quadtree {
+private:
+    Rect boundary;                       // The area this Quadtree node covers.
+    int capacity;                        // Max objects this node can hold before subdividing.
+    std::vector<GameObject*> objects;    // Objects stored directly in this node.
+
+    bool divided = false;                // True if this node has subdivided into children.
+    // An array of unique_pointers to child Quadtree nodes.
+    // std::unique_ptr ensures automatic memory management (children are deleted when parent is).
+    // children[0]: North-East, children[1]: North-West, children[2]: South-East, children[3]: South-West
+    std::array<std::unique_ptr<Quadtree>, 4> children;
+
+    bool autoGrow;                       // Only the root grows; see grow().
+
+    // Aggregates over this node's whole subtree, kept up to date by insert():
+    int subtreeCount = 0;                // How many objects this node and its descendants hold.
+    Rect subtreeBounds{0, 0, 0, 0};      // Union of all of their bounds (valid when subtreeCount > 0).
+                                         // Objects may stick out past 'boundary', so queries
+                                         // prune with this box rather than with 'boundary'.
+
+    // A batch of query ranges stored as "structure of arrays": one array per coordinate, so the
+    // test of a node's box against every range in the batch is one simple loop over contiguous
+    // floats that the compiler turns into SIMD instructions (several ranges per instruction).
+    struct RangePacket {
+        std::vector<float> minX, minY, maxX, maxY;
+        std::vector<int> index;           // Which of the caller's ranges each entry is.
+        std::vector<unsigned char> hit;   // Scratch: per-entry test results.
+
+        void reserve(std::size_t count);
+    };
+    void queryPacketNode(std::deque<RangePacket>& levels, std::size_t depth, int count,
+                         std::vector<std::vector<GameObject*>>& found) const;
+
+public:
+    // Constructor: Initializes a Quadtree node with its boundary and object capacity.
+    // With 'autoGrow' (the default for trees you create), inserting an object outside the boundary
+    // grows the tree instead of failing; see grow(). Child nodes are created with autoGrow off.
+    Quadtree(Rect boundary, int capacity, bool autoGrow = true)
+        : boundary(boundary), capacity(capacity), autoGrow(autoGrow) {}
+
+    // subdivide(): Splits this Quadtree node into four equal-sized children.
+    void subdivide();
+
+    // insert(): Adds a GameObject to the Quadtree.
+    // Returns true if the object was successfully inserted into this branch, false otherwise.
+    // A root with autoGrow on grows toward objects outside its boundary, so it only returns false
+    // for objects with NaN or infinite bounds (or when its own boundary has no area).
+    bool insert(GameObject* obj);
+
+    // grow(): Doubles the root's boundary toward 'target' by adding a new level above it: the current
+    // root (with its whole subtree, untouched) becomes one of the four children of a new, larger root.
+    // Each call is O(1), and an object at distance d needs only about log2(d / size) calls, so inserts
+    // stay amortized O(log n) no matter how far objects wander.
+    void grow(const Rect& target);
+
+    // The area the tree currently covers (larger than the initial boundary after growing).
+    const Rect& bounds() const { return boundary; }
+
+    // query(): Finds all objects in the Quadtree that intersect with a given 'range' (Rect).
+    // Stores the found objects in the 'found' vector.
+    void query(const Rect& range, std::vector<GameObject*>& found);
+
+    // queryPacket(): Runs query() for a whole batch of ranges in one traversal; found[i] receives the
+    // results for ranges[i] (found is resized to match). Meant for groups of small ranges close to
+    // each other, such as the neighbourhoods of nearby agents: instead of walking the same nodes
+    // once per range, each node is visited once and tested against all ranges of the packet together.
+    // Ranges that miss a subtree drop out of the packet for that subtree, so the packet only splits
+    // where the ranges actually diverge.
+    void queryPacket(const std::vector<Rect>& ranges, std::vector<std::vector<GameObject*>>& found) const;
+
+    // count(): The number of objects that query() would find for 'range', without building the
+    // list. Subtrees whose objects all lie inside 'range' are counted whole, without visiting
+    // their objects, so counting large areas (heat-maps, LOD decisions) stays cheap.
+    int count(const Rect& range) const;
+
+    // remap(): Rewrites the object pointers after the objects were moved within one array, e.g. by
+    // reorderAlongHilbert() (see spatial/hilbert.h). Every pointer into [base, base + oldToNew.size())
+    // is replaced by base + oldToNew[old index]; the tree's shape and aggregates stay as they are,
+    // since it still holds the same objects.
+    void remap(GameObject* base, const std::vector<int>& oldToNew);
+
+    // releaseChildren(): Moves this node's children (if any) into 'out', leaving it a leaf. Used to
+    // free a large tree a few nodes at a time (see TimeSlicedQuadtree) instead of in one long
+    // recursive destructor call.
+    void releaseChildren(std::vector<std::unique_ptr<Quadtree>>& out);
+
+    // Bytes used by this node and its subtree (not counting the objects themselves).
+    std::size_t memoryBytes() const;
+
+    // Total number of objects in the tree, and the union of their bounds (only meaningful when size() > 0).
+    int size() const { return subtreeCount; }
+    const Rect& contentBounds() const { return subtreeBounds; }
+};
@@ -0,0 +1,196 @@
+#include "spatial/sweep_and_prune.h"
+
+#include <algorithm> // For std::remove_if and std::sort
+#include <limits>    // For the "not inserted yet" endpoint value
+
+int SweepAndPrune::add(GameObject* obj) {
+    int proxy;
+    if (freeProxies.empty()) {
+        proxy = static_cast<int>(proxies.size());
+        proxies.push_back(Proxy{obj, obj->bounds});
+    } else {
+        proxy = freeProxies.back();
+        freeProxies.pop_back();
+        proxies[proxy] = Proxy{obj, obj->bounds};
+    }
+
+    // New endpoints go at the far end of each axis, where they overlap nothing. The next
+    // update() reads the real bounds and insertion sort moves them into place, reporting the
+    // new object's pairs through the same swaps as for any other movement.
+    const float far = std::numeric_limits<float>::max();
+    xAxis.push_back(Endpoint{far, proxy, true});
+    xAxis.push_back(Endpoint{far, proxy, false});
+    yAxis.push_back(Endpoint{far, proxy, true});
+    yAxis.push_back(Endpoint{far, proxy, false});
+    ++addedSinceUpdate;
+    return proxy;
+}
+
+void SweepAndPrune::remove(int proxy) {
+    // Removal is deferred to update(): erasing endpoints one object at a time would shift the
+    // arrays over and over, while one pass in update() handles any number of removals.
+    pendingRemovals.push_back(proxy);
+}
+
+std::uint64_t SweepAndPrune::pairKey(int p, int q) {
+    if (p > q) {
+        std::swap(p, q);
+    }
+    return (static_cast<std::uint64_t>(p) << 32) | static_cast<std::uint32_t>(q);
+}
+
+void SweepAndPrune::addPair(int p, int q) {
+    if (overlapping.insert(pairKey(p, q)).second) {
+        addedPairs.push_back(OverlapPair{proxies[p].object, proxies[q].object});
+    }
+}
+
+void SweepAndPrune::removePair(int p, int q) {
+    if (overlapping.erase(pairKey(p, q)) > 0) {
+        removedPairs.push_back(OverlapPair{proxies[p].object, proxies[q].object});
+    }
+}
+
+void SweepAndPrune::update() {
+    addedPairs.clear();
+    removedPairs.clear();
+
+    // 1. Drop removed objects: their endpoints, and their pairs (reported as removed).
+    if (!pendingRemovals.empty()) {
+        // A proxy removed twice (before this update, or again after an earlier one) must only
+        // be freed once, or two later add() calls would share it.
+        std::vector<char> dead(proxies.size(), 0);
+        std::vector<int> removedProxies;
+        for (int proxy : pendingRemovals) {
+            if (!dead[proxy] && proxies[proxy].object != nullptr) {
+                dead[proxy] = 1;
+                removedProxies.push_back(proxy);
+            }
+        }
+        for (auto it = overlapping.begin(); it != overlapping.end();) {
+            int p = static_cast<int>(*it >> 32);
+            int q = static_cast<int>(*it & 0xffffffffu);
+            if (dead[p] || dead[q]) {
+                removedPairs.push_back(OverlapPair{proxies[p].object, proxies[q].object});
+                it = overlapping.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        auto isDead = [&](const Endpoint& e) { return dead[e.proxy] != 0; };
+        xAxis.erase(std::remove_if(xAxis.begin(), xAxis.end(), isDead), xAxis.end());
+        yAxis.erase(std::remove_if(yAxis.begin(), yAxis.end(), isDead), yAxis.end());
+        for (int proxy : removedProxies) {
+            proxies[proxy].object = nullptr;
+            freeProxies.push_back(proxy);
+        }
+        pendingRemovals.clear();
+    }
+
+    // 2. Take this frame's bounds and write them into the endpoints (in their old order).
+    for (Proxy& proxy : proxies) {
+        if (proxy.object) {
+            proxy.box = proxy.object->bounds;
+        }
+    }
+    for (Endpoint& e : xAxis) {
+        const Rect& box = proxies[e.proxy].box;
+        e.value = e.isMin ? box.x : box.x + box.width;
+    }
+    for (Endpoint& e : yAxis) {
+        const Rect& box = proxies[e.proxy].box;
+        e.value = e.isMin ? box.y : box.y + box.height;
+    }
+
+    // 3. Restore the order, turning every swap into a pair update. New objects start at the
+    //    far end and have to travel the whole array, so after adding a large batch (such as
+    //    the first update) a full sort and sweep is much cheaper than insertion sort.
+    if (addedSinceUpdate * 4 > xAxis.size()) {
+        rebuild();
+    } else {
+        sortAxis(xAxis);
+        sortAxis(yAxis);
+    }
+    addedSinceUpdate = 0;
+}
+
+// Sorts both axes from scratch and finds all pairs with one sweep along x: walking the
+// endpoints in order, every min endpoint is checked against the objects whose x interval is
+// still open. The result is then diffed against the old pair set to report the changes.
+void SweepAndPrune::rebuild() {
+    auto before = [](const Endpoint& a, const Endpoint& b) { return a.before(b); };
+    std::sort(xAxis.begin(), xAxis.end(), before);
+    std::sort(yAxis.begin(), yAxis.end(), before);
+
+    std::unordered_set<std::uint64_t> found;
+    found.reserve(overlapping.size());
+    std::vector<int> open;
+    std::vector<int> openIndex(proxies.size(), -1);
+    for (const Endpoint& e : xAxis) {
+        if (e.isMin) {
+            for (int other : open) {
+                if (overlapsNow(e.proxy, other)) {
+                    found.insert(pairKey(e.proxy, other));
+                }
+            }
+            openIndex[e.proxy] = static_cast<int>(open.size());
+            open.push_back(e.proxy);
+        } else {
+            // Swap-remove from the open list.
+            int index = openIndex[e.proxy];
+            open[index] = open.back();
+            openIndex[open[index]] = index;
+            open.pop_back();
+        }
+    }
+
+    for (std::uint64_t key : overlapping) {
+        if (found.count(key) == 0) {
+            removedPairs.push_back(OverlapPair{proxies[key >> 32].object,
+                                               proxies[key & 0xffffffffu].object});
+        }
+    }
+    for (std::uint64_t key : found) {
+        if (overlapping.count(key) == 0) {
+            addedPairs.push_back(OverlapPair{proxies[key >> 32].object,
+                                             proxies[key & 0xffffffffu].object});
+        }
+    }
+    overlapping.swap(found);
+}
+
+// Insertion sort over an almost-sorted endpoint array. Each endpoint moves left past the
+// endpoints that should come after it; every one of those swaps is an event for the pair.
+// (Only leftward moves are needed: an endpoint that should move right is passed by the
+// others moving left, which produces the same events.)
+void SweepAndPrune::sortAxis(std::vector<Endpoint>& axis) {
+    for (std::size_t i = 1; i < axis.size(); ++i) {
+        Endpoint moving = axis[i];
+        std::size_t j = i;
+        while (j > 0 && moving.before(axis[j - 1])) {
+            const Endpoint& passed = axis[j - 1];
+            if (moving.isMin && !passed.isMin) {
+                // Our min is now before their max: the intervals start to overlap on this
+                // axis. Whether the boxes overlap depends on the other axis, so test the boxes.
+                if (overlapsNow(moving.proxy, passed.proxy)) {
+                    addPair(moving.proxy, passed.proxy);
+                }
+            } else if (!moving.isMin && passed.isMin) {
+                // Our max is now before their min: the intervals separate.
+                removePair(moving.proxy, passed.proxy);
+            }
+            axis[j] = passed;
+            --j;
+            ++swapCount;
+        }
+        axis[j] = moving;
+    }
+}
+
+void SweepAndPrune::pairs(std::vector<OverlapPair>& out) const {
+    for (std::uint64_t key : overlapping) {
+        int p = static_cast<int>(key >> 32);
+        int q = static_cast<int>(key & 0xffffffffu);
+        out.push_back(OverlapPair{proxies[p].object, proxies[q].object});
+    }
+}
@@ -0,0 +1,99 @@
+// Sweep-and-prune (SAP): a broad phase that finds every pair of overlapping objects, and keeps
+// that set up to date from frame to frame as objects move.
+//
+// Two boxes overlap exactly when their intervals overlap on both the x and the y axis. For
+// each axis we keep one sorted array holding the min and max endpoint of every object. Two
+// intervals start (or stop) overlapping on an axis only at the moment one object's min
+// endpoint passes the other's max endpoint in that order.
+//
+// Objects only move a little per frame, so last frame's arrays are still almost sorted.
+// Insertion sort restores the order in close to O(n), and every swap it does is exactly one
+// of those "passes" events, so each swap tells us that a pair may have started or stopped
+// overlapping:
+//
+//   - min passes a max going left (or max passes a min going right): the intervals begin to
+//     overlap on this axis. If the boxes now overlap on the other axis too, the pair is added.
+//   - max passes a min going left (or min passes a max going right): the intervals separate,
+//     so the pair (if it was overlapping) is removed.
+//
+// The work per frame therefore grows with how much the order changed, not with how many
+// pairs there are, and the caller gets the *changes* (added/removed pairs) directly.
+// SAP does badly when many objects line up along an axis (long runs of endpoints to pass),
+// where the Quadtree or AabbTree do better.
+
+#pragma once
+
+#include <cstddef>        // For std::size_t
+#include <cstdint>        // For std::uint64_t pair keys
+#include <unordered_set>  // For the set of overlapping pairs
+#include <vector>         // For endpoint arrays and reported pairs
+
+#include "spatial/geometry.h"
+
+// A pair of objects whose bounds overlap (a->id and b->id in no particular order).
+struct OverlapPair {
+    GameObject* a;
+    GameObject* b;
+};
+
+class SweepAndPrune {
+public:
+    // Adds an object (which must stay alive while it is tracked). Returns its proxy id, the
+    // handle used to remove it. The object's pairs are reported by the next update().
+    int add(GameObject* obj);
+
+    // Stops tracking an object. Its pairs are reported as removed by the next update(), so
+    // the object must stay alive until then. Removing it again does nothing (but once a later
+    // add() has reused the proxy id, the id refers to the new object).
+    void remove(int proxy);
+
+    // Re-reads every object's bounds, re-sorts the endpoint arrays and updates the pair set.
+    // Afterwards added() and removed() hold the pairs that changed since the previous update.
+    void update();
+
+    const std::vector<OverlapPair>& added() const { return addedPairs; }
+    const std::vector<OverlapPair>& removed() const { return removedPairs; }
+
+    // All pairs overlapping as of the last update().
+    void pairs(std::vector<OverlapPair>& out) const;
+    std::size_t pairCount() const { return overlapping.size(); }
+
+    // Total endpoint swaps done by update() so far: a measure of how much the order changed.
+    long long swaps() const { return swapCount; }
+
+private:
+    struct Proxy {
+        GameObject* object;  // nullptr once removed (and free for reuse after the next update()).
+        Rect box;            // The bounds as of the last update().
+    };
+
+    // One end of an object's interval on one axis. Ties sort mins before maxes, so touching
+    // boxes count as overlapping, just like Rect::intersects.
+    struct Endpoint {
+        float value;
+        int proxy;
+        bool isMin;
+
+        bool before(const Endpoint& other) const {
+            return value < other.value || (value == other.value && isMin && !other.isMin);
+        }
+    };
+
+    void sortAxis(std::vector<Endpoint>& axis);
+    void rebuild();
+    void addPair(int p, int q);
+    void removePair(int p, int q);
+    bool overlapsNow(int p, int q) const { return proxies[p].box.intersects(proxies[q].box); }
+    static std::uint64_t pairKey(int p, int q);
+
+    std::vector<Proxy> proxies;
+    std::vector<int> freeProxies;
+    std::vector<int> pendingRemovals;
+    std::vector<Endpoint> xAxis;
+    std::vector<Endpoint> yAxis;
+    std::unordered_set<std::uint64_t> overlapping;  // Keys from pairKey().
+    std::vector<OverlapPair> addedPairs;
+    std::vector<OverlapPair> removedPairs;
+    std::size_t addedSinceUpdate = 0;
+    long long swapCount = 0;
+};
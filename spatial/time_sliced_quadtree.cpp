@@ -0,0 +1,77 @@
+#include "spatial/time_sliced_quadtree.h"
+
+#include <algorithm> // For std::min
+
+TimeSlicedQuadtree::TimeSlicedQuadtree(Rect boundary, int capacity)
+    : boundary(boundary), capacity(capacity), active(std::make_unique<Quadtree>(boundary, capacity)) {}
+
+void TimeSlicedQuadtree::beginRebuild(const std::vector<GameObject*>& objects) {
+    if (pending) {
+        retired.push_back(std::move(pending)); // Abandoned half-built tree.
+    }
+    pending = std::make_unique<Quadtree>(boundary, capacity);
+    queue = objects;
+    next = 0;
+}
+
+bool TimeSlicedQuadtree::advance(std::chrono::microseconds budget) {
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    // Finish freeing the previous tree first, so old trees don't pile up.
+    if (!freeRetired(deadline) || !pending) {
+        return false;
+    }
+    while (next < queue.size()) {
+        std::size_t batchEnd = std::min(next + INSERTS_PER_CLOCK_CHECK, queue.size());
+        for (; next < batchEnd; ++next) {
+            pending->insert(queue[next]);
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+    if (next < queue.size()) {
+        return false; // Out of time for this frame; carry on next frame.
+    }
+    switchOver();
+    return true;
+}
+
+void TimeSlicedQuadtree::finishRebuild() {
+    if (!pending) {
+        return;
+    }
+    for (; next < queue.size(); ++next) {
+        pending->insert(queue[next]);
+    }
+    switchOver();
+}
+
+void TimeSlicedQuadtree::switchOver() {
+    retired.push_back(std::move(active)); // Freed by later advance() calls.
+    active = std::move(pending);
+    queue.clear();
+    queue.shrink_to_fit();
+    next = 0;
+}
+
+bool TimeSlicedQuadtree::freeRetired(std::chrono::steady_clock::time_point deadline) {
+    std::size_t freed = 0;
+    while (!retired.empty()) {
+        // Detach the node's children (queued for later), then free the node on its own.
+        std::unique_ptr<Quadtree> node = std::move(retired.back());
+        retired.pop_back();
+        node->releaseChildren(retired);
+        node.reset();
+        if (++freed % INSERTS_PER_CLOCK_CHECK == 0 && std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+    return retired.empty();
+}
+
+double TimeSlicedQuadtree::progress() const {
+    if (!pending || queue.empty()) {
+        return 1.0;
+    }
+    return static_cast<double>(next) / static_cast<double>(queue.size());
+}
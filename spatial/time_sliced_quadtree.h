@@ -0,0 +1,70 @@
+// A Quadtree that can be rebuilt a little at a time, spread over many frames.
+//
+// Rebuilding a large Quadtree from scratch (after a level load, say) takes long enough to
+// cause a visible hitch if it happens inside one frame. TimeSlicedQuadtree keeps two trees:
+// queries keep using the current one, while the replacement is built in the background of the
+// frame loop, a few thousand inserts per frame, each frame stopping when its time budget is
+// used up. When the new tree is complete it replaces the old one in one step. Freeing the old
+// tree's thousands of nodes would be a hitch of its own, so that is time-sliced too.
+//
+//     TimeSlicedQuadtree index(world, 8);
+//     index.beginRebuild(levelObjects);
+//     // every frame:
+//     index.advance(std::chrono::microseconds(1000));   // at most ~1 ms of building
+//     index.query(view, visible);                        // old tree until the switch
+//
+// Objects must not move while they are being rebuilt into the new tree (as with any Quadtree,
+// an object that moves after insertion needs to be inserted again).
+
+#pragma once
+
+#include <chrono>   // For the per-frame time budget
+#include <cstddef>  // For std::size_t
+#include <memory>   // For the current and pending trees
+#include <vector>   // For the list of objects to rebuild from
+
+#include "spatial/quadtree.h"
+
+class TimeSlicedQuadtree {
+public:
+    TimeSlicedQuadtree(Rect boundary, int capacity);
+
+    // The tree to query: the old one until a rebuild completes.
+    Quadtree& current() { return *active; }
+    void query(const Rect& range, std::vector<GameObject*>& found) { active->query(range, found); }
+
+    // Starts building a new tree over 'objects' (which must stay alive). Any rebuild still in
+    // progress is abandoned.
+    void beginRebuild(const std::vector<GameObject*>& objects);
+    bool rebuilding() const { return pending != nullptr; }
+    // True while a replaced tree is still being freed.
+    bool retiring() const { return !retired.empty(); }
+
+    // Continues the rebuild for about 'budget' of wall-clock time, and switches over to the new
+    // tree when it is complete. Returns true on the call that switched. The old tree is then freed
+    // over the following calls, within the same budget.
+    bool advance(std::chrono::microseconds budget);
+
+    // Completes the rebuild right now, however long it takes (e.g. behind a loading screen).
+    void finishRebuild();
+
+    // Fraction of the objects already inserted into the new tree (1 when not rebuilding).
+    double progress() const;
+
+private:
+    // The clock is read once per batch of inserts, not after every one: a single insert takes
+    // only a few hundred nanoseconds, so checking every time would cost noticeably.
+    static const std::size_t INSERTS_PER_CLOCK_CHECK = 64;
+
+    void switchOver();
+    // Frees retired nodes until 'deadline'. Returns false if some are left.
+    bool freeRetired(std::chrono::steady_clock::time_point deadline);
+
+    Rect boundary;
+    int capacity;
+    std::unique_ptr<Quadtree> active;
+    std::unique_ptr<Quadtree> pending;
+    std::vector<GameObject*> queue;  // Objects for the pending tree; queue[next...] still to go.
+    std::size_t next = 0;
+    std::vector<std::unique_ptr<Quadtree>> retired;  // Nodes of old trees still to be freed.
+};
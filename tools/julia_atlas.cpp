@@ -0,0 +1,103 @@
+// Renders a contact sheet of Julia sets: a grid of small thumbnails, one per constant c, with c
+// stepping evenly over a rectangle of the parameter plane (so the sheet as a whole also traces
+// out the Mandelbrot set: connected Julia sets where c is inside it, dust where it isn't).
+//
+// All thumbnails are rendered in one process straight into one atlas image, which is encoded
+// once at the end: no per-image process start, option parsing, allocation or file write.
+// Thumbnails are tasks on the shared work-stealing scheduler. Their cost varies a lot (c inside
+// the Mandelbrot set means many pixels run to max_iterations), so they are handed out one at a
+// time and idle threads steal whatever is left.
+//
+//   ./julia_atlas --columns=40 --rows=30 --size=64 --output=atlas.png
+
+#include <complex>  // For the constants
+#include <iostream> // For status messages
+#include <string>   // For options
+#include <vector>   // For per-thread iteration counts
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/julia.h"
+#include "tools/julia_palette.h"
+
+int main(int argc, char** argv) {
+    int columns = 16;
+    int rows = 12;
+    int size = 96; // Thumbnail width and height in pixels.
+    int gap = 2;   // Background pixels between thumbnails.
+    double c_real_min = -2.0;
+    double c_real_max = 0.6;
+    double c_imag_min = -1.2;
+    double c_imag_max = 1.2;
+    int max_iterations = 100;
+    std::string output = "julia_atlas.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_atlas", "Renders a grid of Julia set thumbnails, one per constant c, into one image.");
+    options.add("columns", columns, "Thumbnails per row (c-real steps)", 1, 4096);
+    options.add("rows", rows, "Thumbnail rows (c-imag steps)", 1, 4096);
+    options.add("size", size, "Thumbnail width and height in pixels", 4, 4096);
+    options.add("gap", gap, "Pixels between thumbnails", 0, 64);
+    options.add("c-real-min", c_real_min, "Real part of c in the first column");
+    options.add("c-real-max", c_real_max, "Real part of c in the last column");
+    options.add("c-imag-min", c_imag_min, "Imaginary part of c in the first row");
+    options.add("c-imag-max", c_imag_max, "Imaginary part of c in the last row");
+    options.add("max-iterations", max_iterations, "Iterations before a point counts as inside the set", 1);
+    options.add("output", output, "Output image, .png/.qoi/.ppm");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
+    const int atlas_width = columns * size + (columns + 1) * gap;
+    const int atlas_height = rows * size + (rows + 1) * gap;
+    Image atlas(atlas_width, atlas_height, 3);
+    ImageView atlas_pixels = atlas.view();
+    for (int y = 0; y < atlas_height; ++y) {
+        for (int x = 0; x < atlas_width; ++x) {
+            atlas_pixels.set(x, y, Color{40, 40, 48});
+        }
+    }
+
+    // Every thumbnail shows the same window, [-1.6, 1.6] on both axes, which holds any connected
+    // Julia set whole; only c changes.
+    JuliaView view;
+    view.center_real = dd_from(0.0);
+    view.center_imag = dd_from(0.0);
+    view.pixel_spacing = 3.2 / size;
+    view.width = size;
+    view.height = size;
+
+    {
+        DP_TRACE_SCOPE("julia atlas");
+        parallel_for(0, columns * rows, 1, [&](int begin, int end) {
+            std::vector<int> counts((std::size_t)size * size);
+            for (int index = begin; index < end; ++index) {
+                DP_TRACE_SCOPE("julia thumbnail");
+                const int column = index % columns;
+                const int row = index / columns;
+                const double tx = columns > 1 ? (double)column / (columns - 1) : 0.5;
+                const double ty = rows > 1 ? (double)row / (rows - 1) : 0.5;
+                // Rows go up the image, so positive imaginary parts are at the top as in a plot.
+                std::complex<double> c(c_real_min + tx * (c_real_max - c_real_min),
+                                       c_imag_max - ty * (c_imag_max - c_imag_min));
+
+                julia_render_rows(c, view, 0, size, max_iterations, counts.data());
+                // Each thumbnail is written through a subview, straight into its cell of the atlas.
+                ImageView cell = atlas_pixels.subview(gap + column * (size + gap), gap + row * (size + gap), size, size);
+                color_julia_counts(counts, max_iterations, cell);
+            }
+        });
+    }
+
+    if (!writeImage(atlas_pixels, output)) {
+        return 1;
+    }
+    std::cout << columns * rows << " Julia sets (" << atlas_width << "x" << atlas_height << ") saved to " << output
+              << std::endl;
+    return 0;
+}
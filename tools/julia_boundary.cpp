@@ -0,0 +1,89 @@
+// Draws the boundary of a Julia set as line art, by inverse iteration (fractal/julia_boundary.h):
+// dark lines on a light background, in time proportional to the length of the boundary rather
+// than to the size of the image.
+//
+//   ./julia_boundary --c-real=-0.123 --c-imag=0.745 --output=rabbit.png
+//   ./julia_boundary --c-real=0 --c-imag=1 --max-visits=8 --output=dendrite.png
+//
+// Works for any c, including the dendrites and dust clouds (c outside the Mandelbrot set) that
+// have no interior for escape-time rendering to fill.
+
+#include <algorithm> // For std::min
+#include <complex>   // For the constant
+#include <cstdint>   // For visit counts
+#include <iostream>  // For status messages
+#include <string>    // For options
+#include <vector>    // For the visit bitmap
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/trace.h"
+#include "fractal/julia_boundary.h"
+
+int main(int argc, char** argv) {
+    int width = 800;
+    int height = 600;
+    double c_real = -0.7;
+    double c_imag = 0.27015;
+    int max_visits = 4;
+    double center_real = 0.0;
+    double center_imag = 0.0;
+    double zoom = 1.0;
+    bool shade = false;
+    std::string output = "julia_boundary.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_boundary", "Draws the boundary of a Julia set by inverse iteration.");
+    options.add("width", width, "Image width in pixels", 1, 65536);
+    options.add("height", height, "Image height in pixels", 1, 65536);
+    options.add("c-real", c_real, "Real part of the Julia constant c");
+    options.add("c-imag", c_imag, "Imaginary part of the Julia constant c");
+    options.add("max-visits", max_visits, "Visits per pixel before a branch stops (more: denser lines)", 1, 255);
+    options.add("center-real", center_real, "Real part of the point at the centre of the image");
+    options.add("center-imag", center_imag, "Imaginary part of the point at the centre of the image");
+    options.add("zoom", zoom, "Magnification around the centre (1: the image spans -2..2 horizontally)", 1e-3);
+    options.add("shade", shade, "Darker lines where the walk visited a pixel more often");
+    options.add("output", output, "Output image, .png/.qoi/.ppm");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
+    JuliaView view;
+    view.center_real = dd_from(center_real);
+    view.center_imag = dd_from(center_imag);
+    view.pixel_spacing = 4.0 / (width * zoom);
+    view.width = width;
+    view.height = height;
+
+    std::vector<std::uint8_t> visits;
+    long long points;
+    {
+        DP_TRACE_SCOPE("julia boundary");
+        points = julia_boundary(std::complex<double>(c_real, c_imag), view, max_visits, visits);
+    }
+
+    // One channel is enough for line art.
+    Image image(width, height, 1);
+    ImageView pixels = image.view();
+    long long boundary_pixels = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int count = visits[(std::size_t)y * width + x];
+            boundary_pixels += count > 0;
+            std::uint8_t value = 255;
+            if (count > 0) {
+                value = shade ? (std::uint8_t)(200 - 200 * std::min(count, max_visits) / max_visits) : 0;
+            }
+            pixels.set(x, y, Color{value, value, value});
+        }
+    }
+
+    if (!writeImage(pixels, output)) {
+        return 1;
+    }
+    std::cout << boundary_pixels << " boundary pixels from " << points << " points saved to " << output << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Renders a Julia set's iteration counts into an iteration map (fractal/iteration_map.h), to be
+// colored later by julia_recolor without iterating again.
+//
+//   ./julia_counts --width=16384 --height=16384 --output=julia.dpim
+//   ./julia_recolor --input=julia.dpim --palette=fire --output=julia.png
+//
+// Rows are rendered one block of the map at a time (in parallel on the shared scheduler) and
+// written straight away, so even a 16k x 16k map never has more than one block of counts in
+// memory.
+
+#include <algorithm> // For std::min
+#include <complex>   // For the constant
+#include <iostream>  // For status messages
+#include <string>    // For options
+#include <vector>    // For one block of counts
+
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/iteration_map.h"
+#include "fractal/julia.h"
+
+int main(int argc, char** argv) {
+    int width = 4096;
+    int height = 3072;
+    double c_real = -0.7;
+    double c_imag = 0.27015;
+    int max_iterations = 100;
+    double center_real = 0.0;
+    double center_imag = 0.0;
+    double zoom = 1.0;
+    std::string output = "julia.dpim";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_counts", "Renders a Julia set's iteration counts into a compact iteration map file.");
+    options.add("width", width, "Map width in pixels", 1, 1 << 22);
+    options.add("height", height, "Map height in pixels", 1, 1 << 30);
+    options.add("c-real", c_real, "Real part of the Julia constant c");
+    options.add("c-imag", c_imag, "Imaginary part of the Julia constant c");
+    options.add("max-iterations", max_iterations, "Iterations before a point counts as inside the set", 1);
+    options.add("center-real", center_real, "Real part of the point at the centre of the map");
+    options.add("center-imag", center_imag, "Imaginary part of the point at the centre of the map");
+    options.add("zoom", zoom, "Magnification around the centre (1: the map spans -2..2 horizontally)", 1e-3);
+    options.add("output", output, "Output iteration map");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
+    JuliaView view;
+    view.center_real = dd_from(center_real);
+    view.center_imag = dd_from(center_imag);
+    view.pixel_spacing = 4.0 / (width * zoom);
+    view.width = width;
+    view.height = height;
+    const std::complex<double> c(c_real, c_imag);
+
+    IterationMapWriter writer;
+    if (!writer.open(output, width, height, max_iterations)) {
+        return 1;
+    }
+    std::vector<int> counts((std::size_t)ITERATION_MAP_BLOCK_ROWS * width);
+    for (int block_begin = 0; block_begin < height; block_begin += ITERATION_MAP_BLOCK_ROWS) {
+        const int block_end = std::min(block_begin + ITERATION_MAP_BLOCK_ROWS, height);
+        {
+            DP_TRACE_SCOPE("julia counts block");
+            parallel_for(block_begin, block_end, 1, [&](int row_begin, int row_end) {
+                julia_render_band(c, view, row_begin, row_end, max_iterations,
+                                  counts.data() + (std::size_t)(row_begin - block_begin) * width);
+            });
+        }
+        DP_TRACE_SCOPE("julia counts write");
+        if (!writer.write_rows(counts.data(), block_end - block_begin)) {
+            return 1;
+        }
+    }
+    if (!writer.close()) {
+        return 1;
+    }
+
+    const double raw_bytes = (double)width * height * sizeof(int);
+    std::cout << width << "x" << height << " iteration map saved to " << output << " (" << writer.bytes_written()
+              << " bytes, " << raw_bytes / writer.bytes_written() << "x smaller than ints)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,25 @@
+// Turns iteration counts into pixels, with the same coloring as the Julia program
+// (cpp_learning_274dfc.cpp): black inside the set, a brown gradient outside.
+
+#pragma once
+
+#include <vector> // For iteration counts
+
+#include "common/image.h"
+
+inline Color julia_color(int iterations, int max_iterations) {
+    if (iterations == max_iterations) {
+        return Color{0, 0, 0};
+    }
+    unsigned char value = static_cast<unsigned char>((iterations * 255) / max_iterations);
+    return Color{value, static_cast<unsigned char>(value / 2), static_cast<unsigned char>(value / 4)};
+}
+
+// Colors 'counts' (width x height, row by row) into 'pixels', which must be that size.
+inline void color_julia_counts(const std::vector<int>& counts, int max_iterations, const ImageView& pixels) {
+    for (int y = 0; y < pixels.height; ++y) {
+        for (int x = 0; x < pixels.width; ++x) {
+            pixels.set(x, y, julia_color(counts[(std::size_t)y * pixels.width + x], max_iterations));
+        }
+    }
+}
@@ -0,0 +1,166 @@
+// Colors an iteration map written by julia_counts (fractal/iteration_map.h) into an image,
+// without iterating again: trying another palette on a large render takes seconds.
+//
+//   ./julia_recolor --input=julia.dpim --palette=bands --band-length=12 --output=julia.png
+//
+// The map is memory-mapped and its blocks are decoded in parallel, each straight into its rows
+// of the image, so the counts are never all in memory at once. A .ppm output is also written
+// band by band (BAND_BLOCKS blocks of rows at a time), so coloring a map into PPM needs memory
+// for one band only, whatever the size of the map. PNG and QOI are encoded from the whole
+// image, which is then held in memory (3 bytes per pixel).
+
+#include <algorithm> // For std::min/std::max
+#include <atomic>    // For the error flag shared by the threads
+#include <cmath>     // For the palettes' sin/sqrt
+#include <cstdint>   // For color channels
+#include <fstream>   // For writing PPM band by band
+#include <iostream>  // For status messages
+#include <string>    // For options
+#include <vector>    // For one block of counts
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/iteration_map.h"
+#include "tools/julia_palette.h"
+
+enum class Palette {
+    Brown, // The Julia program's own coloring (tools/julia_palette.h).
+    Gray,
+    Fire,
+    Bands, // Repeating color bands every 'band_length' iterations, for detail far from the set.
+};
+
+// Blocks of the map colored (in parallel) per band of a streamed PPM: 1024 rows.
+const int BAND_BLOCKS = 16;
+
+static Color palette_color(Palette palette, int iterations, int max_iterations, int band_length) {
+    if (iterations >= max_iterations) {
+        return Color{0, 0, 0};
+    }
+    const double t = (double)iterations / max_iterations;
+    switch (palette) {
+    case Palette::Brown:
+        return julia_color(iterations, max_iterations);
+    case Palette::Gray: {
+        std::uint8_t v = (std::uint8_t)(255.0 * std::sqrt(t));
+        return Color{v, v, v};
+    }
+    case Palette::Fire:
+        // Black to red to yellow to white, one third of the range each.
+        return Color{(std::uint8_t)(255.0 * std::min(1.0, 3.0 * t)),
+                     (std::uint8_t)(255.0 * std::min(1.0, std::max(0.0, 3.0 * t - 1.0))),
+                     (std::uint8_t)(255.0 * std::max(0.0, 3.0 * t - 2.0))};
+    case Palette::Bands:
+    default: {
+        const double phase = 6.283185307179586 * iterations / band_length;
+        return Color{(std::uint8_t)(127.5 + 127.5 * std::sin(phase)),
+                     (std::uint8_t)(127.5 + 127.5 * std::sin(phase + 2.1)),
+                     (std::uint8_t)(127.5 + 127.5 * std::sin(phase + 4.2))};
+    }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string input = "julia.dpim";
+    std::string palette_name = "brown";
+    int band_length = 16;
+    bool map = true;
+    std::string output = "julia_recolored.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_recolor", "Colors a stored iteration map (from julia_counts) into an image.");
+    options.add("input", input, "Iteration map to read");
+    options.add("palette", palette_name, "brown, gray, fire or bands");
+    options.add("band-length", band_length, "Iterations per color band (bands palette)", 1);
+    options.add("mmap", map, "Memory-map the input instead of reading it into memory");
+    options.add("output", output, "Output image, .png/.qoi/.ppm");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+
+    Palette palette;
+    if (palette_name == "brown") {
+        palette = Palette::Brown;
+    } else if (palette_name == "gray") {
+        palette = Palette::Gray;
+    } else if (palette_name == "fire") {
+        palette = Palette::Fire;
+    } else if (palette_name == "bands") {
+        palette = Palette::Bands;
+    } else {
+        std::cerr << "Error: unknown palette '" << palette_name << "' (use brown, gray, fire or bands)" << std::endl;
+        return 1;
+    }
+    ImageFormat format;
+    if (!imageFormatFromFilename(output, format)) {
+        std::cerr << "Error: Unknown image format for " << output << " (use .png, .qoi or .ppm)" << std::endl;
+        return 1;
+    }
+    trace::Session traceSession(trace_file);
+
+    IterationMapReader reader;
+    if (!reader.open(input, map)) {
+        return 1;
+    }
+    const int width = reader.width();
+    const int height = reader.height();
+    const int max_iterations = reader.max_iterations();
+
+    // Colors blocks [first_block, last_block) in parallel into 'pixels', which starts at the
+    // first row of 'first_block'.
+    std::atomic<bool> ok{true};
+    auto color_blocks = [&](int first_block, int last_block, const ImageView& pixels) {
+        DP_TRACE_SCOPE("recolor");
+        const int first_row = first_block * ITERATION_MAP_BLOCK_ROWS;
+        parallel_for(first_block, last_block, 1, [&](int block_begin, int block_end) {
+            std::vector<int> counts;
+            for (int block = block_begin; block < block_end; ++block) {
+                DP_TRACE_SCOPE("recolor block");
+                if (!reader.read_block(block, counts)) {
+                    ok = false;
+                    return;
+                }
+                const int row_begin = block * ITERATION_MAP_BLOCK_ROWS;
+                for (int y = row_begin; y < reader.block_end_row(block); ++y) {
+                    const int* row = counts.data() + (std::size_t)(y - row_begin) * width;
+                    for (int x = 0; x < width; ++x) {
+                        pixels.set(x, y - first_row, palette_color(palette, row[x], max_iterations, band_length));
+                    }
+                }
+            }
+        });
+    };
+
+    if (format == ImageFormat::Ppm) {
+        std::ofstream file(output, std::ios::binary);
+        file << "P6\n" << width << " " << height << "\n255\n";
+        Image band(width, std::min(height, BAND_BLOCKS * ITERATION_MAP_BLOCK_ROWS), 3);
+        for (int first = 0; first < reader.block_count() && ok && file; first += BAND_BLOCKS) {
+            const int last = std::min(first + BAND_BLOCKS, reader.block_count());
+            const int rows = reader.block_end_row(last - 1) - first * ITERATION_MAP_BLOCK_ROWS;
+            color_blocks(first, last, band.view());
+            DP_TRACE_SCOPE("write band");
+            file.write(reinterpret_cast<const char*>(band.data()), (std::streamsize)((std::size_t)rows * width * 3));
+        }
+        file.close();
+        if (!ok) {
+            return 1;
+        }
+        if (!file) {
+            std::cerr << "Error: could not write " << output << std::endl;
+            return 1;
+        }
+    } else {
+        Image image(width, height, 3);
+        color_blocks(0, reader.block_count(), image.view());
+        if (!ok || !writeImage(image.view(), output)) {
+            return 1;
+        }
+    }
+    std::cout << "Iteration map " << input << " colored into " << output << std::endl;
+    return 0;
+}
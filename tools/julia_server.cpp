@@ -0,0 +1,486 @@
+// A small render service for Julia set map tiles, so that several tools (tile viewers, the atlas
+// and pyramid generators, scripts) share one renderer instead of each computing the same tiles.
+//
+// It speaks just enough HTTP on 127.0.0.1 for curl, browsers and map viewers:
+//
+//   GET /tile/{level}/{x}/{y}.png?c=-0.7,0.27015&iterations=200&center=0,0&priority=visible
+//   GET /stats
+//
+// Tiles are the ones of fractal/tiles.h (the same as tools/julia_tiles.cpp writes). Every
+// parameter except the tile address is optional; priority is "visible" (default: someone is
+// looking at it now) or "prefetch" (may be needed soon).
+//
+// How requests share work:
+//   - Disk cache: every finished tile is stored under a name derived from all its parameters, so
+//     the same request later (or after a restart) is just a file read.
+//   - Coalescing: a request for a tile that is already queued or rendering waits for that render
+//     instead of starting another one.
+//   - Priorities: renders are tasks on a work-stealing scheduler, visible tiles at
+//     TaskPriority::High and prefetches at TaskPriority::Low, so a viewer's screen fills first.
+//     A visible request for a tile only queued for prefetch queues it again at high priority;
+//     whichever copy runs first renders it, the other finds it claimed and returns.
+//
+// Each connection gets its own thread (the threads mostly wait), up to --max-connections at once;
+// further clients wait in the listen backlog. A client that doesn't send its request within
+// CONNECTION_TIMEOUT_MS is dropped. The rendering happens on the scheduler's workers.
+// Ctrl-C (SIGINT) or SIGTERM stops accepting connections, drops the ones still waiting for a
+// request, lets the others be answered and exits normally, so a --trace file is written.
+// Only POSIX sockets are supported.
+
+#include <arpa/inet.h>  // For inet_pton/htons
+#include <netinet/in.h> // For sockaddr_in
+#include <poll.h>       // For waiting on the listening socket with a timeout
+#include <sys/socket.h> // For socket/bind/listen/accept
+#include <sys/time.h>   // For the send timeout
+#include <unistd.h>     // For close
+
+#include <algorithm>          // For std::min
+#include <atomic>             // For the job's claim flag and the statistics
+#include <complex>            // For the Julia constant
+#include <cerrno>             // For accept errors
+#include <chrono>             // For backing off after accept errors and connection deadlines
+#include <condition_variable> // For waiting on a render someone else started
+#include <csignal>            // For stopping on SIGINT/SIGTERM
+#include <cstdint>            // For std::uint8_t bytes and the cache key hash
+#include <cstdio>             // For std::snprintf and std::rename
+#include <cstring>            // For std::strerror
+#include <filesystem>         // For the cache directory
+#include <fstream>            // For reading and writing cached tiles
+#include <iostream>           // For status messages
+#include <memory>             // For sharing jobs between the requests waiting on them
+#include <mutex>              // For the table of jobs in flight
+#include <sstream>            // For the /stats page
+#include <string>             // For requests and paths
+#include <thread>             // For one thread per connection
+#include <unordered_map>      // For the jobs in flight, by cache key
+#include <vector>             // For encoded tiles
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/tiles.h"
+#include "tools/julia_palette.h"
+
+namespace fs = std::filesystem;
+
+// One tile of one map: everything that determines its pixels.
+struct TileRequest {
+    JuliaTileMap map;
+    int level = 0;
+    long long x = 0;
+    long long y = 0;
+    bool visible = true;
+};
+
+// A render that one or more requests are waiting for.
+struct RenderJob {
+    std::atomic<bool> claimed{false}; // Set by the task that renders it (there may be two copies queued).
+    bool visible = false;             // Whether a high-priority copy has been queued.
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    std::vector<std::uint8_t> png; // Empty if rendering failed.
+};
+
+// The cache key: every parameter, written exactly (hex floats), so different requests never share
+// a file and equal requests always do.
+static std::string cache_key(const TileRequest& request) {
+    char key[256];
+    std::snprintf(key, sizeof(key), "julia c=%a,%a center=%a,%a iterations=%d tile=%d/%lld/%lld",
+                  request.map.c.real(), request.map.c.imag(), request.map.center_real, request.map.center_imag,
+                  request.map.max_iterations, request.level, request.x, request.y);
+    return key;
+}
+
+// The key is too long (and full of characters) for a file name, so files are named by its
+// 64-bit FNV-1a hash, which stays the same across runs and builds.
+static std::string cache_file_name(const std::string& key) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char ch : key) {
+        hash = (hash ^ ch) * 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.png", (unsigned long long)hash);
+    return name;
+}
+
+static bool read_file(const std::string& path, std::vector<std::uint8_t>& bytes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+class RenderService {
+public:
+    RenderService(const std::string& cache_directory, unsigned threads)
+        : cache_directory(cache_directory), scheduler(threads + 1) {} // +1: slot 0 is for waiters.
+
+    // Returns the encoded tile, from the cache, a render already in flight, or a new render.
+    // An empty result means rendering failed.
+    std::vector<std::uint8_t> get_tile(const TileRequest& request) {
+        ++requests;
+        const std::string key = cache_key(request);
+        const std::string path = cache_directory + "/" + cache_file_name(key);
+
+        std::vector<std::uint8_t> cached;
+        if (read_file(path, cached)) {
+            ++cache_hits;
+            return cached;
+        }
+
+        std::shared_ptr<RenderJob> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = in_flight.find(key);
+            if (found != in_flight.end()) {
+                ++coalesced;
+                job = found->second;
+                if (request.visible && !job->visible) {
+                    job->visible = true; // Someone is looking at it now: queue it again, at high priority.
+                    queue(job, request, key, path);
+                }
+            } else if (!fs::exists(path)) {
+                job = std::make_shared<RenderJob>();
+                job->visible = request.visible;
+                in_flight[key] = job;
+                queue(job, request, key, path);
+            }
+            // Otherwise a render finished between the read above and taking the lock (a job leaves
+            // the table only after its file is in place), so the file is there now.
+        }
+        if (!job) {
+            ++cache_hits;
+            read_file(path, cached);
+            return cached;
+        }
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&] { return job->done; });
+        return job->png;
+    }
+
+    std::string stats() const {
+        std::ostringstream out;
+        out << "requests " << requests << "\n"
+            << "cache_hits " << cache_hits << "\n"
+            << "coalesced " << coalesced << "\n"
+            << "rendered " << rendered << "\n";
+        return out.str();
+    }
+
+private:
+    void queue(const std::shared_ptr<RenderJob>& job, const TileRequest& request, const std::string& key,
+               const std::string& path) {
+        TaskPriority priority = request.visible ? TaskPriority::High : TaskPriority::Low;
+        scheduler.spawn([this, job, request, key, path] { render(*job, request, key, path); }, priority);
+    }
+
+    void render(RenderJob& job, const TileRequest& request, const std::string& key, const std::string& path) {
+        if (job.claimed.exchange(true)) {
+            return; // The other copy of this job got here first.
+        }
+        std::vector<std::uint8_t> png;
+        try {
+            DP_TRACE_SCOPE("render tile");
+            std::vector<int> counts = julia_tile_counts(request.map, request.level, request.x, request.y);
+            Image image(JULIA_TILE_SIZE, JULIA_TILE_SIZE, 3);
+            color_julia_counts(counts, request.map.max_iterations, image.view());
+            if (encodePng(image.view(), png)) {
+                store(path, png);
+                ++rendered;
+            } else {
+                std::cerr << "Error: encoding " << key << " failed" << std::endl;
+                png.clear(); // Whoever waits on this job answers 500.
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: rendering " << key << " failed: " << e.what() << std::endl;
+            png.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight.erase(key);
+        }
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.png = std::move(png);
+        job.done = true;
+        job.finished.notify_all();
+    }
+
+    // Writes a tile to the cache under a temporary name first, so readers never see half a file.
+    void store(const std::string& path, const std::vector<std::uint8_t>& png) {
+        std::string partial = path + ".part";
+        std::ofstream out(partial, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(png.data()), (std::streamsize)png.size());
+        out.close();
+        if (!out || std::rename(partial.c_str(), path.c_str()) != 0) {
+            std::cerr << "Error: could not write " << path << " (the tile is served, but not cached)" << std::endl;
+        }
+    }
+
+    std::string cache_directory;
+    Scheduler scheduler;
+
+    std::mutex mutex; // Guards in_flight.
+    std::unordered_map<std::string, std::shared_ptr<RenderJob>> in_flight;
+
+    std::atomic<long long> requests{0};
+    std::atomic<long long> cache_hits{0};
+    std::atomic<long long> coalesced{0};
+    std::atomic<long long> rendered{0};
+};
+
+// --- HTTP ---
+
+// Parses "/tile/{level}/{x}/{y}.png?name=value&..." into 'request'. Returns false if it isn't one.
+static bool parse_tile_target(const std::string& target, TileRequest& request) {
+    std::string path = target.substr(0, target.find('?'));
+    std::string query = target.size() > path.size() ? target.substr(path.size() + 1) : "";
+
+    char extension[8] = {};
+    if (std::sscanf(path.c_str(), "/tile/%d/%lld/%lld.%4s", &request.level, &request.x, &request.y, extension) != 4 ||
+        std::string(extension) != "png") {
+        return false;
+    }
+    long long tiles_per_side = request.level >= 0 && request.level <= 40 ? 1ll << request.level : 0;
+    if (tiles_per_side == 0 || request.x < 0 || request.y < 0 || request.x >= tiles_per_side ||
+        request.y >= tiles_per_side) {
+        return false;
+    }
+
+    request.map.c = std::complex<double>(-0.7, 0.27015);
+    request.map.max_iterations = 200;
+    std::size_t start = 0;
+    while (start < query.size()) {
+        std::size_t end = query.find('&', start);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        std::string item = query.substr(start, end - start);
+        std::string name = item.substr(0, item.find('='));
+        std::string value = item.size() > name.size() ? item.substr(name.size() + 1) : "";
+        double a = 0.0;
+        double b = 0.0;
+        if (name == "c" && std::sscanf(value.c_str(), "%lf,%lf", &a, &b) == 2) {
+            request.map.c = std::complex<double>(a, b);
+        } else if (name == "center" && std::sscanf(value.c_str(), "%lf,%lf", &a, &b) == 2) {
+            request.map.center_real = a;
+            request.map.center_imag = b;
+        } else if (name == "iterations" && std::sscanf(value.c_str(), "%lf", &a) == 1 && a >= 1 && a <= 1e9) {
+            request.map.max_iterations = (int)a;
+        } else if (name == "priority" && (value == "visible" || value == "prefetch")) {
+            request.visible = value == "visible";
+        } else {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+static void send_all(int connection, const std::string& head, const std::vector<std::uint8_t>& body) {
+    std::string bytes = head;
+    bytes.append(body.begin(), body.end());
+    std::size_t sent = 0;
+    while (sent < bytes.size()) {
+        ssize_t n = send(connection, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return; // The client went away.
+        }
+        sent += (std::size_t)n;
+    }
+}
+
+static void respond(int connection, int status, const char* reason, const char* type,
+                    const std::vector<std::uint8_t>& body) {
+    std::string head = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n" +
+                       "Content-Type: " + type + "\r\n" +
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                       "Connection: close\r\n\r\n";
+    send_all(connection, head, body);
+}
+
+static void respond_text(int connection, int status, const char* reason, const std::string& text) {
+    respond(connection, status, reason, "text/plain", std::vector<std::uint8_t>(text.begin(), text.end()));
+}
+
+// The connection threads still running, so main can wait for them before the service they use
+// goes away.
+struct ConnectionThreads {
+    std::mutex mutex;
+    std::condition_variable changed;
+    int active = 0;
+};
+
+// Set by SIGINT/SIGTERM; the accept loop checks it at least every STOP_POLL_MS milliseconds.
+static volatile std::sig_atomic_t stop_requested = 0;
+const int STOP_POLL_MS = 250;
+
+// How long the accept loop pauses after accept() fails for lack of resources.
+const int ACCEPT_RETRY_MS = 100;
+
+// A client gets this long to send its whole request, and each send of the answer may block this
+// long; a connection that stalls longer is dropped, so idle clients can't hold connection
+// threads (and with them the --max-connections slots, and a clean stop) forever.
+const int CONNECTION_TIMEOUT_MS = 5000;
+
+static void request_stop(int) {
+    stop_requested = 1;
+}
+
+// Reads one request, answers it and closes the connection. Drops the connection without an
+// answer if the request doesn't arrive within CONNECTION_TIMEOUT_MS, or the server is stopping
+// before it does.
+static void handle_connection(RenderService& service, int connection) {
+    timeval send_timeout = {CONNECTION_TIMEOUT_MS / 1000, (CONNECTION_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CONNECTION_TIMEOUT_MS);
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16384) {
+        // Wait in short slices, to notice both the deadline and a stop request.
+        const auto left =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (stop_requested || left.count() <= 0) {
+            close(connection);
+            return;
+        }
+        pollfd ready = {connection, POLLIN, 0};
+        if (poll(&ready, 1, (int)std::min<long long>(left.count(), STOP_POLL_MS)) <= 0) {
+            continue;
+        }
+        ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break;
+        }
+        request.append(buffer, (std::size_t)n);
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    std::size_t space = line.find(' ');
+    std::size_t second_space = line.find(' ', space + 1);
+    std::string method = line.substr(0, space);
+    std::string target = space == std::string::npos ? "" : line.substr(space + 1, second_space - space - 1);
+
+    TileRequest tile;
+    if (method != "GET") {
+        respond_text(connection, 405, "Method Not Allowed", "Only GET is supported\n");
+    } else if (target == "/stats") {
+        respond_text(connection, 200, "OK", service.stats());
+    } else if (parse_tile_target(target, tile)) {
+        std::vector<std::uint8_t> png = service.get_tile(tile);
+        if (png.empty()) {
+            respond_text(connection, 500, "Internal Server Error", "Rendering failed\n");
+        } else {
+            respond(connection, 200, "OK", "image/png", png);
+        }
+    } else {
+        respond_text(connection, 404, "Not Found",
+                     "Try /tile/{level}/{x}/{y}.png?c=RE,IM&iterations=N&center=RE,IM&priority=visible|prefetch\n");
+    }
+    close(connection);
+}
+
+int main(int argc, char** argv) {
+    int port = 8765;
+    std::string cache_directory = "julia_cache";
+    int threads = (int)std::thread::hardware_concurrency();
+    int max_connections = 64;
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_server", "Serves Julia set map tiles over HTTP on 127.0.0.1, with a shared disk cache.");
+    options.add("port", port, "TCP port to listen on (0: pick a free one)", 0, 65535);
+    options.add("cache", cache_directory, "Directory holding rendered tiles (kept across runs)");
+    options.add("threads", threads, "Render threads", 1, 1024);
+    options.add("max-connections", max_connections, "Connections answered at once (more wait to be accepted)", 1,
+                4096);
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
+    std::error_code error;
+    fs::create_directories(cache_directory, error);
+    if (error) {
+        std::cerr << "Error: could not create " << cache_directory << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Error: could not create a socket: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((std::uint16_t)port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr); // Local clients only.
+    socklen_t length = sizeof(address);
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0 ||
+        getsockname(listener, (sockaddr*)&address, &length) != 0) {
+        std::cerr << "Error: could not listen on 127.0.0.1:" << port << std::endl;
+        return 1;
+    }
+    std::cout << "Serving tiles on http://127.0.0.1:" << ntohs(address.sin_port) << "/tile/0/0/0.png" << std::endl;
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    RenderService service(cache_directory, (unsigned)threads);
+    ConnectionThreads connections;
+    while (!stop_requested) {
+        // At most max_connections threads at once: further clients wait in the listen backlog
+        // until one finishes. (Also woken by the timeout, to notice a stop request.)
+        {
+            std::unique_lock<std::mutex> lock(connections.mutex);
+            if (!connections.changed.wait_for(lock, std::chrono::milliseconds(STOP_POLL_MS),
+                                              [&] { return connections.active < max_connections; })) {
+                continue;
+            }
+        }
+
+        // Wait for a connection with a timeout (accept would block through a signal), so a stop
+        // request is noticed soon even when nobody connects.
+        pollfd ready = {listener, POLLIN, 0};
+        if (poll(&ready, 1, STOP_POLL_MS) <= 0) {
+            continue;
+        }
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue; // A signal, or the client gave up: nothing wrong with the server.
+            }
+            // Out of file descriptors or memory (EMFILE, ENFILE, ENOBUFS, ...): the pending
+            // connection stays in the backlog and poll() would report it again at once, so pause
+            // rather than spin, to give open connections time to finish.
+            std::cerr << "Error: accept failed: " << std::strerror(errno) << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_RETRY_MS));
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(connections.mutex);
+            ++connections.active;
+        }
+        std::thread([&service, &connections, connection] {
+            handle_connection(service, connection);
+            std::lock_guard<std::mutex> lock(connections.mutex);
+            --connections.active;
+            connections.changed.notify_all();
+        }).detach();
+    }
+
+    close(listener);
+    std::cout << "Stopping once open connections are answered" << std::endl;
+    std::unique_lock<std::mutex> lock(connections.mutex);
+    connections.changed.wait(lock, [&] { return connections.active == 0; });
+    return 0;
+}
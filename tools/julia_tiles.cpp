@@ -0,0 +1,201 @@
+// Renders a zoomable map of a Julia set: every tile of zoom levels 0..N, 256x256 pixels each,
+// in the XYZ layout web maps use (DIR/z/x/y.png) or as a Deep Zoom image (DIR/julia.dzi with
+// DIR/julia_files/level/col_row.png), ready for a tile viewer such as Leaflet or OpenSeadragon.
+//
+// Level 0 is one tile covering a 4x4 square of the complex plane around the centre; every level
+// doubles the tiles per side and halves the distance between pixels. Three things make a whole
+// pyramid much cheaper than one run of the Julia program per tile:
+//   - Reuse: a pixel at even (x, y) of a child tile lands exactly on a pixel of its parent (the
+//     spacing halves and everything is a power of two, so the coordinates are bit-identical).
+//     A quarter of every tile below level 0 is copied from the parent instead of iterated.
+//   - Parallelism: tiles are tasks on the shared work-stealing scheduler. A finished tile spawns
+//     its four children, so workers go depth-first and only a few tiles per level are in memory.
+//   - Streaming and resume: each tile is written as soon as it is done (to a temporary name that
+//     is renamed when complete), and tiles already on disk are skipped, so an interrupted run
+//     picks up where it stopped.
+
+#include <atomic>     // For the progress counters shared by the tile tasks
+#include <complex>    // For the Julia constant
+#include <cstdio>     // For std::rename
+#include <filesystem> // For creating the tile directories and checking for finished tiles
+#include <fstream>    // For the .dzi descriptor
+#include <iostream>   // For status messages
+#include <memory>     // For sharing a tile's counts with its children
+#include <string>     // For paths
+#include <vector>     // For iteration counts
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/tiles.h"   // The tile geometry and julia_tile_counts().
+#include "tools/julia_palette.h"
+
+namespace fs = std::filesystem;
+
+// Everything a tile task needs to know about the pyramid.
+struct Pyramid {
+    JuliaTileMap map;
+    int levels = 0;         // Deepest level (inclusive).
+    bool deep_zoom = false; // Deep Zoom layout instead of XYZ.
+    std::string directory;
+
+    std::atomic<long long> rendered{0};
+    std::atomic<long long> skipped{0};
+    std::atomic<long long> reused_pixels{0};
+    std::atomic<long long> failed{0};
+};
+
+static std::string tile_path(const Pyramid& pyramid, int level, long long x, long long y) {
+    if (pyramid.deep_zoom) {
+        // Deep Zoom levels count from a 1x1 image, so our level 0 (256x256) is its level 8.
+        return pyramid.directory + "/julia_files/" + std::to_string(level + JULIA_TILE_SIZE_LOG2) + "/" +
+               std::to_string(x) + "_" + std::to_string(y) + ".png";
+    }
+    return pyramid.directory + "/" + std::to_string(level) + "/" + std::to_string(x) + "/" +
+           std::to_string(y) + ".png";
+}
+
+// Writes 'counts' (size x size) as a PNG. The file appears under its final name only once it
+// is complete, so a tile found on disk during a resumed run is always a whole one.
+static bool write_tile(const std::vector<int>& counts, int size, int max_iterations, const std::string& path) {
+    DP_TRACE_SCOPE("write tile");
+    Image image(size, size, 3);
+    color_julia_counts(counts, max_iterations, image.view());
+    std::error_code error;
+    fs::create_directories(fs::path(path).parent_path(), error);
+    std::string partial = path + ".part.png"; // writeImage() picks the format from the extension.
+    if (!writeImage(image.view(), partial)) {
+        return false;
+    }
+    if (std::rename(partial.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: could not rename " << partial << " to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Renders tile (x, y) of 'level' (unless it is already on disk) and queues its four children.
+static void render_tile(Pyramid& pyramid, TaskGroup& group, int level, long long x, long long y,
+                        std::shared_ptr<const std::vector<int>> parent) {
+    DP_TRACE_SCOPE("julia tile");
+    std::string path = tile_path(pyramid, level, x, y);
+    std::shared_ptr<const std::vector<int>> counts;
+    if (fs::exists(path)) {
+        ++pyramid.skipped; // Finished by an earlier run; its children iterate every pixel.
+    } else {
+        // Reuse only works when parent and child were computed in the same precision.
+        bool reuse = parent && julia_tile_precision(pyramid.map, level - 1) == julia_tile_precision(pyramid.map, level);
+        counts = std::make_shared<const std::vector<int>>(julia_tile_counts(pyramid.map, level, x, y, parent.get()));
+        if (reuse) {
+            pyramid.reused_pixels += JULIA_TILE_SIZE * JULIA_TILE_SIZE / 4;
+        }
+        if (write_tile(*counts, JULIA_TILE_SIZE, pyramid.map.max_iterations, path)) {
+            ++pyramid.rendered;
+        } else {
+            ++pyramid.failed;
+        }
+    }
+
+    if (level == pyramid.levels) {
+        return;
+    }
+    for (int child = 0; child < 4; ++child) {
+        long long child_x = 2 * x + child % 2;
+        long long child_y = 2 * y + child / 2;
+        group.run([&pyramid, &group, level, child_x, child_y, counts] {
+            render_tile(pyramid, group, level + 1, child_x, child_y, counts);
+        });
+    }
+}
+
+// Deep Zoom viewers also expect the levels below one tile: the whole map at 1x1, 2x2, ... 128x128
+// pixels. They are tiny, so they are simply rendered directly, plus the .dzi descriptor.
+static bool write_deep_zoom_extras(Pyramid& pyramid) {
+    for (int level = 0; level < JULIA_TILE_SIZE_LOG2; ++level) {
+        int size = 1 << level;
+        std::string path = pyramid.directory + "/julia_files/" + std::to_string(level) + "/0_0.png";
+        if (fs::exists(path)) {
+            continue;
+        }
+        if (!write_tile(julia_map_overview(pyramid.map, size), size, pyramid.map.max_iterations, path)) {
+            return false;
+        }
+    }
+    long long full_size = (long long)JULIA_TILE_SIZE << pyramid.levels;
+    std::ofstream dzi(pyramid.directory + "/julia.dzi");
+    dzi << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"png\" Overlap=\"0\" TileSize=\""
+        << JULIA_TILE_SIZE << "\">\n"
+        << "  <Size Width=\"" << full_size << "\" Height=\"" << full_size << "\"/>\n"
+        << "</Image>\n";
+    if (!dzi) {
+        std::cerr << "Error: could not write " << pyramid.directory << "/julia.dzi" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int levels = 4;
+    double c_real = -0.7;
+    double c_imag = 0.27015;
+    double center_real = 0.0;
+    double center_imag = 0.0;
+    int max_iterations = 200;
+    std::string directory = "julia_tiles";
+    std::string layout = "xyz";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("julia_tiles", "Renders every tile of a zoomable Julia set map, levels 0..N.");
+    options.add("levels", levels, "Deepest zoom level (level N has 2^N x 2^N tiles)", 0, 40);
+    options.add("c-real", c_real, "Real part of the Julia constant c");
+    options.add("c-imag", c_imag, "Imaginary part of the Julia constant c");
+    options.add("center-real", center_real, "Real part of the centre of the map");
+    options.add("center-imag", center_imag, "Imaginary part of the centre of the map");
+    options.add("max-iterations", max_iterations, "Iterations before a point counts as inside the set", 1);
+    options.add("output", directory, "Directory to write the tiles into (existing tiles are kept)");
+    options.add("layout", layout, "xyz (DIR/z/x/y.png) or dzi (Deep Zoom: DIR/julia.dzi)");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    if (layout != "xyz" && layout != "dzi") {
+        std::cerr << "Error: --layout must be xyz or dzi, not '" << layout << "'" << std::endl;
+        return 1;
+    }
+    trace::Session traceSession(trace_file);
+
+    Pyramid pyramid;
+    pyramid.map.c = std::complex<double>(c_real, c_imag);
+    pyramid.map.center_real = center_real;
+    pyramid.map.center_imag = center_imag;
+    pyramid.map.max_iterations = max_iterations;
+    pyramid.levels = levels;
+    pyramid.deep_zoom = layout == "dzi";
+    pyramid.directory = directory;
+
+    if (pyramid.deep_zoom && !write_deep_zoom_extras(pyramid)) {
+        return 1;
+    }
+    {
+        DP_TRACE_SCOPE("tile pyramid");
+        TaskGroup group;
+        group.run([&pyramid, &group] { render_tile(pyramid, group, 0, 0, 0, nullptr); });
+        group.wait();
+    }
+
+    long long total = pyramid.rendered + pyramid.skipped + pyramid.failed;
+    std::cout << "Tiles: " << total << " (" << pyramid.rendered << " rendered, " << pyramid.skipped
+              << " already on disk)\n";
+    if (pyramid.rendered > 0) {
+        std::cout << "Pixels copied from parent tiles: "
+                  << 100.0 * pyramid.reused_pixels / ((double)pyramid.rendered * JULIA_TILE_SIZE * JULIA_TILE_SIZE) << "%\n";
+    }
+    if (pyramid.failed > 0) {
+        std::cerr << "Error: " << pyramid.failed << " tiles could not be written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Renders the Newton fractal of a polynomial: every pixel is colored by the root Newton's method
+// reaches from it (one hue per root), darker the more steps it took. See fractal/newton.h.
+//
+//   ./newton_basins --degree=5                          z^5 - 1 (roots of unity)
+//   ./newton_basins --roots="1,0 -1,0 0,1 0,-1 0.5,0.5"  any roots, 2 to 8 of them
+//
+// The image is split into square tiles rendered in parallel on the shared scheduler; within a
+// tile every row goes through the batched, vectorized newton_basins().
+
+#include <algorithm> // For std::min/std::max
+#include <complex>   // For roots (std::polar) and pixels
+#include <cstdint>   // For color channels
+#include <iostream>  // For status messages
+#include <sstream>   // For parsing --roots
+#include <string>    // For options
+#include <vector>    // For roots and per-row buffers
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/newton.h"
+
+const int TILE_SIZE = 64;
+
+// One clearly distinct hue per root.
+const Color ROOT_COLORS[NEWTON_MAX_DEGREE] = {
+    {230, 60, 60}, {60, 200, 80}, {70, 110, 230}, {240, 200, 50},
+    {200, 70, 210}, {50, 200, 210}, {240, 130, 40}, {160, 160, 160},
+};
+
+// Parses "re,im re,im ..." into 'roots'. Returns false if any entry isn't a pair of numbers.
+static bool parse_roots(const std::string& text, std::vector<std::complex<double>>& roots) {
+    std::istringstream in(text);
+    std::string pair;
+    while (in >> pair) {
+        std::size_t comma = pair.find(',');
+        if (comma == std::string::npos) {
+            return false;
+        }
+        try {
+            roots.push_back(std::complex<double>(std::stod(pair.substr(0, comma)), std::stod(pair.substr(comma + 1))));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int width = 800;
+    int height = 600;
+    int degree = 3;
+    std::string roots_text;
+    int max_iterations = 64;
+    double zoom = 1.0;
+    std::string output = "newton.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("newton_basins", "Renders the basins of Newton's method for a polynomial.");
+    options.add("width", width, "Image width in pixels", 1, 65536);
+    options.add("height", height, "Image height in pixels", 1, 65536);
+    options.add("degree", degree, "Render z^degree - 1 (ignored if --roots is given)", 2, NEWTON_MAX_DEGREE);
+    options.add("roots", roots_text, "The polynomial's roots as \"re,im re,im ...\" (2 to 8 of them)");
+    options.add("max-iterations", max_iterations, "Newton steps before a point counts as not converging", 1);
+    options.add("zoom", zoom, "Magnification (1: the view spans -2..2 horizontally)", 1e-3);
+    options.add("output", output, "Output image, .png/.qoi/.ppm");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+
+    std::vector<std::complex<double>> roots;
+    if (roots_text.empty()) {
+        const double pi = 3.14159265358979323846;
+        for (int k = 0; k < degree; ++k) {
+            roots.push_back(std::polar(1.0, 2.0 * pi * k / degree));
+        }
+    } else if (!parse_roots(roots_text, roots) || roots.size() < 2 || (int)roots.size() > NEWTON_MAX_DEGREE) {
+        std::cerr << "Error: --roots needs 2 to " << NEWTON_MAX_DEGREE << " roots written as \"re,im re,im ...\""
+                  << std::endl;
+        return 1;
+    }
+    trace::Session traceSession(trace_file);
+
+    Image image(width, height, 3);
+    ImageView pixels = image.view();
+    const double spacing = 4.0 / (width * zoom);
+    const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    parallel_for(0, tiles_x * tiles_y, 1, [&](int tile_begin, int tile_end) {
+        std::vector<std::complex<double>> row(TILE_SIZE);
+        std::vector<NewtonResult> results(TILE_SIZE);
+        for (int tile = tile_begin; tile < tile_end; ++tile) {
+            DP_TRACE_SCOPE("newton tile");
+            const int x0 = (tile % tiles_x) * TILE_SIZE;
+            const int y0 = (tile / tiles_x) * TILE_SIZE;
+            const int tile_width = std::min(TILE_SIZE, width - x0);
+            const int tile_height = std::min(TILE_SIZE, height - y0);
+            for (int y = y0; y < y0 + tile_height; ++y) {
+                for (int x = 0; x < tile_width; ++x) {
+                    row[x] = std::complex<double>((x0 + x - 0.5 * width) * spacing, (y - 0.5 * height) * spacing);
+                }
+                newton_basins(roots, row.data(), results.data(), tile_width, max_iterations);
+                for (int x = 0; x < tile_width; ++x) {
+                    Color color = {0, 0, 0}; // Didn't converge.
+                    if (results[x].root >= 0) {
+                        // Fast convergence is bright; each step darkens a little.
+                        Color hue = ROOT_COLORS[results[x].root];
+                        double shade = std::max(0.15, 1.0 - results[x].iterations / 32.0);
+                        color = Color{(std::uint8_t)(hue.r * shade), (std::uint8_t)(hue.g * shade),
+                                      (std::uint8_t)(hue.b * shade)};
+                    }
+                    pixels.set(x0 + x, y, color);
+                }
+            }
+        }
+    });
+
+    if (!writeImage(pixels, output)) {
+        return 1;
+    }
+    std::cout << "Newton basins of a degree " << roots.size() << " polynomial saved to " << output << std::endl;
+    return 0;
+}
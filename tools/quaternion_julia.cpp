@@ -0,0 +1,151 @@
+// Renders a 3D slice of a quaternion Julia set by ray marching its distance estimate (see
+// fractal/quaternion_julia.h), lit by one light, and saves it as an image.
+//
+//   ./quaternion_julia --c-r=-0.2 --c-i=0.6 --c-j=0.2 --c-k=0.2 --yaw=30 --output=qjulia.png
+//
+// The camera circles the origin at 'distance', 'yaw' degrees around the vertical axis and
+// 'pitch' degrees above the horizon. The image is split into square tiles rendered in parallel
+// on the shared scheduler; within a tile rays are marched in 2x2 packets.
+
+#include <algorithm> // For std::min/std::max
+#include <cmath>     // For the camera's sin/cos/tan
+#include <cstdint>   // For color channels
+#include <iostream>  // For status messages
+#include <string>    // For options
+
+#include "common/image.h"
+#include "common/image_codec.h"
+#include "common/options.h"
+#include "common/scheduler.h"
+#include "common/trace.h"
+#include "fractal/quaternion_julia.h"
+
+// Must be even, so every 2x2 packet lies in one tile.
+const int TILE_SIZE = 16;
+
+static Vec3 normalized(Vec3 v) {
+    const double length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return Vec3{v.x / length, v.y / length, v.z / length};
+}
+
+static Vec3 cross(Vec3 a, Vec3 b) {
+    return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+static double dot(Vec3 a, Vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static std::uint8_t channel(double value) {
+    return (std::uint8_t)std::min(255.0, std::max(0.0, value * 255.0 + 0.5));
+}
+
+int main(int argc, char** argv) {
+    int width = 800;
+    int height = 600;
+    QuaternionJulia fractal = {{-0.2, 0.6, 0.2, 0.2}, 0.0, 12};
+    double yaw = 30.0;
+    double pitch = 20.0;
+    double distance = 3.0;
+    double field_of_view = 45.0;
+    QuaternionJuliaMarch march = {0.9, 0.0, 256};
+    double precision = 1.0;
+    std::string output = "qjulia.png";
+    std::string trace_file = trace::fileFromEnvironment();
+
+    Options options("quaternion_julia", "Ray marches a 3D slice of a quaternion Julia set into an image.");
+    options.add("width", width, "Image width in pixels", 2, 65536);
+    options.add("height", height, "Image height in pixels", 2, 65536);
+    options.add("c-r", fractal.c.r, "Real part of the constant c");
+    options.add("c-i", fractal.c.i, "i part of the constant c");
+    options.add("c-j", fractal.c.j, "j part of the constant c");
+    options.add("c-k", fractal.c.k, "k part of the constant c");
+    options.add("slice", fractal.slice, "The k coordinate of the 3D slice shown");
+    options.add("max-iterations", fractal.max_iterations, "Iterations per distance estimate", 1);
+    options.add("yaw", yaw, "Camera angle around the vertical axis, in degrees");
+    options.add("pitch", pitch, "Camera angle above the horizon, in degrees", -89.0, 89.0);
+    options.add("distance", distance, "Camera distance from the origin", 0.1);
+    options.add("fov", field_of_view, "Vertical field of view, in degrees", 1.0, 160.0);
+    options.add("step-scale", march.step_scale, "Fraction of the distance estimate each step advances", 0.05, 1.0);
+    options.add("precision", precision, "Surface precision in pixels (smaller: finer, slower)", 0.01);
+    options.add("max-steps", march.max_steps, "Steps before a ray gives up", 1);
+    options.add("output", output, "Output image, .png/.qoi/.ppm");
+    options.add("trace", trace_file, "Write a Chrome trace of this run to this file");
+    if (!options.parse(argc, argv)) {
+        return options.exitCode();
+    }
+    trace::Session traceSession(trace_file);
+
+    // The camera looks at the origin; right and up span the image plane.
+    const double degrees = 3.14159265358979323846 / 180.0;
+    const Vec3 eye = {distance * std::cos(pitch * degrees) * std::sin(yaw * degrees), distance * std::sin(pitch * degrees),
+                      distance * std::cos(pitch * degrees) * std::cos(yaw * degrees)};
+    const Vec3 forward = normalized(Vec3{-eye.x, -eye.y, -eye.z});
+    const Vec3 right = normalized(cross(forward, Vec3{0.0, 1.0, 0.0}));
+    const Vec3 up = cross(right, forward);
+    const double pixel_size = 2.0 * std::tan(0.5 * field_of_view * degrees) / height; // At distance 1.
+    march.hit_scale = pixel_size * precision;
+    const Vec3 light = normalized(Vec3{0.6, 0.8, 0.4});
+
+    Image image(width, height, 3);
+    ImageView pixels = image.view();
+    const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    auto shade = [&](int x, int y, Vec3 direction, const QuaternionJuliaHit& hit) {
+        if (x >= width || y >= height) {
+            return; // A packet lane past the right or bottom edge of the image.
+        }
+        if (!hit.hit) {
+            // Background: a dark vertical gradient.
+            const double v = 0.08 + 0.12 * (double)y / height;
+            pixels.set(x, y, Color{channel(v), channel(v), channel(v * 1.3)});
+            return;
+        }
+        const Vec3 point = {eye.x + hit.t * direction.x, eye.y + hit.t * direction.y, eye.z + hit.t * direction.z};
+        const Vec3 normal = quaternion_julia_normal(fractal, point, std::max(hit.t * march.hit_scale, 1e-7));
+        const double diffuse = std::max(0.0, dot(normal, light));
+        // Rays that needed many steps passed close to the surface on the way in: a cheap
+        // stand-in for ambient occlusion.
+        const double occlusion = 1.0 / (1.0 + 0.02 * hit.steps);
+        const double brightness = (0.15 + 0.85 * diffuse) * (0.4 + 0.6 * occlusion);
+        // Tint by the normal, so the shape reads well even on the shadowed side.
+        pixels.set(x, y, Color{channel(brightness * (0.75 + 0.25 * normal.x)), channel(brightness * (0.55 + 0.25 * normal.y)),
+                               channel(brightness * (0.45 + 0.35 * normal.z))});
+    };
+
+    {
+        DP_TRACE_SCOPE("quaternion julia");
+        parallel_for(0, tiles_x * tiles_y, 1, [&](int tile_begin, int tile_end) {
+            for (int tile = tile_begin; tile < tile_end; ++tile) {
+                DP_TRACE_SCOPE("quaternion julia tile");
+                const int x0 = (tile % tiles_x) * TILE_SIZE;
+                const int y0 = (tile / tiles_x) * TILE_SIZE;
+                for (int y = y0; y < std::min(y0 + TILE_SIZE, height); y += 2) {
+                    for (int x = x0; x < std::min(x0 + TILE_SIZE, width); x += 2) {
+                        Vec3 directions[QJULIA_PACKET_LANES];
+                        for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+                            // Lanes 0..3 are the pixels (x, y), (x+1, y), (x, y+1), (x+1, y+1).
+                            const double sx = (x + (l & 1) + 0.5 - 0.5 * width) * pixel_size;
+                            const double sy = (0.5 * height - (y + (l >> 1) + 0.5)) * pixel_size;
+                            directions[l] = normalized(Vec3{forward.x + sx * right.x + sy * up.x,
+                                                            forward.y + sx * right.y + sy * up.y,
+                                                            forward.z + sx * right.z + sy * up.z});
+                        }
+                        QuaternionJuliaHit hits[QJULIA_PACKET_LANES];
+                        quaternion_julia_march_packet(fractal, march, eye, directions, hits);
+                        for (int l = 0; l < QJULIA_PACKET_LANES; ++l) {
+                            shade(x + (l & 1), y + (l >> 1), directions[l], hits[l]);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    if (!writeImage(pixels, output)) {
+        return 1;
+    }
+    std::cout << "Quaternion Julia set saved to " << output << std::endl;
+    return 0;
+}